@@ -0,0 +1,13 @@
+#version 450
+layout (location = 0) in vec2 fragOffset;
+layout (location = 1) in vec4 fragColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+	// Soft disc, fading out towards the edge of the quad
+	float falloff = 1.0 - clamp(dot(fragOffset, fragOffset), 0.0, 1.0);
+
+	outColor = vec4(fragColor.rgb, fragColor.a * falloff * falloff);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#version 450
+// One instance per alive particle, the instance count comes from the finalize pass of Particle_Simulate.comp
+struct Particle
+{
+	vec2 position;
+	vec2 velocity;
+	float age;
+	float lifetime;
+	float size;
+	uint startColor;
+	uint endColor;
+	float padding;
+};
+
+layout (set = 0, binding = 0) readonly buffer Particles {
+	Particle particles[];
+};
+
+layout (set = 0, binding = 2) readonly buffer AliveLists {
+	uint aliveIndices[];
+};
+
+layout (push_constant) uniform Push {
+	vec4 startColor;
+	vec4 endColor;
+	vec2 emitterPosition;
+	vec2 emitterVelocity;
+	float direction;
+	float spread;
+	float speedMin;
+	float speedMax;
+	float lifetime;
+	float size;
+	float radius;
+	float deltaTime;
+	float gravityStrength;
+	uint emitCount;
+	uint bodyCount;
+	uint capacity;
+	uint currentList;
+	uint seed;
+} push;
+
+layout (location = 0) out vec2 fragOffset;
+layout (location = 1) out vec4 fragColor;
+
+const vec2 CORNERS[6] = vec2[](
+	vec2(-1.0, -1.0),
+	vec2( 1.0,  1.0),
+	vec2(-1.0,  1.0),
+	vec2(-1.0, -1.0),
+	vec2( 1.0, -1.0),
+	vec2( 1.0,  1.0));
+
+void main()
+{
+	Particle particle = particles[aliveIndices[push.currentList * push.capacity + uint(gl_InstanceIndex)]];
+	float t = clamp(particle.age / particle.lifetime, 0.0, 1.0);
+
+	fragOffset = CORNERS[gl_VertexIndex];
+	fragColor = mix(unpackUnorm4x8(particle.startColor), unpackUnorm4x8(particle.endColor), t);
+
+	gl_Position = vec4(particle.position + fragOffset * particle.size, 0.0, 1.0);
+}
\ No newline at end of file
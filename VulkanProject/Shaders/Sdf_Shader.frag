@@ -0,0 +1,56 @@
+#version 450
+layout (location = 0) in vec2 fragLocal;
+layout (location = 1) in vec4 fragColor;
+layout (location = 2) flat in vec2 fragHalfSize;
+layout (location = 3) flat in uint fragShape;
+layout (location = 4) flat in float fragThickness;
+
+layout (location = 0) out vec4 outColor;
+
+// Matches VESdfShape
+const uint SHAPE_CIRCLE = 0u;
+const uint SHAPE_RING = 1u;
+const uint SHAPE_CAPSULE = 2u;
+const uint SHAPE_ROUNDED_RECT = 3u;
+
+float RoundedRect(vec2 p, vec2 halfSize, float radius)
+{
+	vec2 q = abs(p) - halfSize + radius;
+	return length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - radius;
+}
+
+void main()
+{
+	float radius = min(fragHalfSize.x, fragHalfSize.y);
+	float dist;
+
+	if (fragShape == SHAPE_CIRCLE)
+	{
+		dist = length(fragLocal) - radius;
+	}
+	else if (fragShape == SHAPE_RING)
+	{
+		float halfWidth = fragThickness * radius * 0.5;
+		dist = abs(length(fragLocal) - radius + halfWidth) - halfWidth;
+	}
+	else if (fragShape == SHAPE_CAPSULE)
+	{
+		dist = RoundedRect(fragLocal, fragHalfSize, radius);
+	}
+	else
+	{
+		dist = RoundedRect(fragLocal, fragHalfSize, fragThickness * radius);
+	}
+
+	// The shape is the same for the whole quad, so the derivatives are taken in uniform control flow.
+	// Dividing by the dist one pixel covers fades the edge over exactly one pixel at any scale.
+	float pixelDistance = length(vec2(dFdx(dist), dFdy(dist)));
+	float coverage = clamp(0.5 - dist / max(pixelDistance, 1e-6), 0.0, 1.0);
+
+	if (coverage <= 0.0)
+	{
+		discard;
+	}
+
+	outColor = vec4(fragColor.xyz, fragColor.w * coverage);
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#version 450
+// One instance per shape, the quad corners come from gl_VertexIndex and are drawn as a triangle strip
+layout (location = 0) in vec2 instanceTranslation;
+layout (location = 1) in vec2 instanceScale;
+layout (location = 2) in vec4 instanceColor;
+layout (location = 3) in float instanceRotation;	// Divided by pi to fit the snorm encoding
+layout (location = 4) in uint instanceShape;
+layout (location = 5) in float instanceThickness;
+
+layout (location = 0) out vec2 fragLocal;			// Offset from the center before rotation, in clip space units
+layout (location = 1) out vec4 fragColor;
+layout (location = 2) flat out vec2 fragHalfSize;
+layout (location = 3) flat out uint fragShape;
+layout (location = 4) flat out float fragThickness;
+
+layout (push_constant) uniform Push {
+	vec2 pixelSize;
+} push;
+
+void main()
+{
+	vec2 corner = vec2(float(gl_VertexIndex & 1), float(gl_VertexIndex >> 1)) * 2.0 - 1.0;
+	vec2 halfSize = abs(instanceScale);
+
+	// Grown by a pixel so the anti-aliased edge is not cut off
+	vec2 local = corner * (halfSize + max(push.pixelSize.x, push.pixelSize.y));
+
+	float angle = instanceRotation * 3.14159265;
+	float s = sin(angle);
+	float c = cos(angle);
+
+	gl_Position = vec4(vec2(c * local.x - s * local.y, s * local.x + c * local.y) + instanceTranslation, 0.0, 1.0);
+
+	fragLocal = local;
+	fragColor = instanceColor;
+	fragHalfSize = halfSize;
+	fragShape = instanceShape;
+	fragThickness = instanceThickness;
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 fragUv;
+
+layout (location = 0) out vec4 outColor;
+
+// Every texture in the bindless table, indexed per draw
+layout (set = 0, binding = 0) uniform sampler2DArray textures[];
+
+layout (push_constant) uniform Push {
+	vec2 translation;
+	vec2 scale;
+	float rotation;
+	uint color;
+	uint textureIndex;
+} push;
+
+void main()
+{
+	vec3 color = unpackUnorm4x8(push.color).xyz;
+
+	// ~0u is an object without a texture, or one that is still uploading
+	if (push.textureIndex != 0xFFFFFFFFu)
+	{
+		color *= texture(textures[push.textureIndex], vec3(fragUv, 0.0)).xyz;
+	}
+
+	outColor = vec4(color, 1.0);
+}
\ No newline at end of file
@@ -2,12 +2,14 @@
 layout (location = 0) out vec4 outColor;
 
 layout (push_constant) uniform Push {
-mat2 transform;
-	vec2 offset;
-	vec3 color;
+	vec2 translation;
+	vec2 scale;
+	float rotation;
+	uint color;
+	uint textureIndex;
 } push;
 
 void main()
 {
-	outColor = vec4(push.color, 1.0);
+	outColor = vec4(unpackUnorm4x8(push.color).xyz, 1.0);
 }
\ No newline at end of file
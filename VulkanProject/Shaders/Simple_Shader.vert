@@ -2,13 +2,23 @@
 layout (location = 0) in vec2 position;
 layout (location = 1) in vec3 color;
 
+layout (location = 0) out vec2 fragUv;
+
 layout (push_constant) uniform Push {
-	mat2 transform;
-	vec2 offset;
-	vec3 color;
+	vec2 translation;
+	vec2 scale;		// Includes the model's position dequantization
+	float rotation;
+	uint color;
+	uint textureIndex;
 } push;
 
 void main()
 {
-	gl_Position = vec4(push.transform * position + push.offset, 0.0, 1.0);
+	float s = sin(push.rotation);
+	float c = cos(push.rotation);
+	vec2 local = position * push.scale;
+
+	gl_Position = vec4(vec2(c * local.x - s * local.y, s * local.x + c * local.y) + push.translation, 0.0, 1.0);
+	// Packed positions span -1 to 1 across the model bounds, so the texture covers the whole shape
+	fragUv = position * 0.5 + 0.5;
 }
\ No newline at end of file
@@ -0,0 +1,14 @@
+#version 450
+layout (location = 0) in vec2 fragUv;
+layout (location = 1) in vec4 fragColor;
+layout (location = 2) flat in uint fragLayer;
+
+layout (location = 0) out vec4 outColor;
+
+// Every atlas page is a layer of the same array texture, so sprites never need a rebind
+layout (set = 0, binding = 0) uniform sampler2DArray atlas;
+
+void main()
+{
+	outColor = texture(atlas, vec3(fragUv, float(fragLayer))) * fragColor;
+}
\ No newline at end of file
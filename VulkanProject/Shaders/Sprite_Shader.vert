@@ -0,0 +1,37 @@
+#version 450
+// One instance per sprite, the quad corners come from gl_VertexIndex so no vertex buffer is needed
+layout (location = 0) in vec2 instancePosition;
+layout (location = 1) in vec2 instanceSize;
+layout (location = 2) in vec4 instanceUvRect;
+layout (location = 3) in vec4 instanceColor;
+layout (location = 4) in float instanceRotation;	// Divided by pi to fit the snorm encoding
+layout (location = 5) in uint instanceLayer;
+
+layout (location = 0) out vec2 fragUv;
+layout (location = 1) out vec4 fragColor;
+layout (location = 2) flat out uint fragLayer;
+
+const vec2 CORNERS[6] = vec2[](
+	vec2(0.0, 0.0),
+	vec2(1.0, 1.0),
+	vec2(0.0, 1.0),
+	vec2(0.0, 0.0),
+	vec2(1.0, 0.0),
+	vec2(1.0, 1.0));
+
+void main()
+{
+	vec2 corner = CORNERS[gl_VertexIndex];
+
+	float angle = instanceRotation * 3.14159265;
+	float s = sin(angle);
+	float c = cos(angle);
+	vec2 local = (corner - 0.5) * instanceSize;
+	vec2 rotated = vec2(c * local.x - s * local.y, s * local.x + c * local.y);
+
+	gl_Position = vec4(instancePosition + rotated, 0.0, 1.0);
+
+	fragUv = mix(instanceUvRect.xy, instanceUvRect.zw, corner);
+	fragColor = instanceColor;
+	fragLayer = instanceLayer;
+}
\ No newline at end of file
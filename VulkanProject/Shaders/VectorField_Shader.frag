@@ -0,0 +1,17 @@
+#version 450
+layout (location = 0) out vec4 outColor;
+
+layout (push_constant) uniform Push {
+	vec2 fieldMin;
+	vec2 cellSize;
+	uint columns;
+	uint bodyCount;
+	float strength;
+	float thickness;
+	vec3 color;
+} push;
+
+void main()
+{
+	outColor = vec4(push.color, 1.0);
+}
\ No newline at end of file
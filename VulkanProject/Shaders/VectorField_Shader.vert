@@ -0,0 +1,64 @@
+#version 450
+// One instance per grid point. The field is evaluated here, the same way Vec2FieldSystem::Update does on the CPU.
+struct Body
+{
+	vec2 position;
+	float mass;
+	float padding;
+};
+
+layout (set = 0, binding = 0) readonly buffer Bodies {
+	Body bodies[];
+};
+
+layout (push_constant) uniform Push {
+	vec2 fieldMin;
+	vec2 cellSize;
+	uint columns;
+	uint bodyCount;
+	float strength;
+	float thickness;
+	vec3 color;
+} push;
+
+// Unit square with its left edge on the grid point, so the arrow grows away from it
+const vec2 CORNERS[6] = vec2[](
+	vec2(0.0, -0.5),
+	vec2(1.0,  0.5),
+	vec2(0.0,  0.5),
+	vec2(0.0, -0.5),
+	vec2(1.0, -0.5),
+	vec2(1.0,  0.5));
+
+void main()
+{
+	uint column = uint(gl_InstanceIndex) / push.columns;
+	uint row = uint(gl_InstanceIndex) % push.columns;
+	vec2 point = push.fieldMin + (vec2(column, row) + 0.5) * push.cellSize;
+
+	// Net gravitational pull on a probe at this point
+	vec2 direction = vec2(0.0);
+	for (uint i = 0; i < push.bodyCount; i++)
+	{
+		vec2 offset = bodies[i].position - point;
+		float distanceSquared = dot(offset, offset);
+
+		if (distanceSquared < 1e-10)
+		{
+			continue;
+		}
+
+		float force = push.strength * bodies[i].mass / distanceSquared;
+		direction += force * offset / sqrt(distanceSquared);
+	}
+
+	// Log scaled length, and atan2(0, 0) = 0 points an arrow with no field along +x
+	float magnitude = length(direction);
+	float arrowLength = 0.005 + 0.045 * clamp(log(magnitude + 1.0) / 3.0, 0.0, 1.0);
+	vec2 axis = magnitude > 0.0 ? direction / magnitude : vec2(1.0, 0.0);
+
+	vec2 local = CORNERS[gl_VertexIndex] * vec2(arrowLength, push.thickness);
+	vec2 rotated = vec2(axis.x * local.x - axis.y * local.y, axis.y * local.x + axis.x * local.y);
+
+	gl_Position = vec4(point + rotated, 0.0, 1.0);
+}
\ No newline at end of file
@@ -1,64 +1,182 @@
 #include "Application.h"
+#include "DrawListRenderSystem.h"
+#include "GpuParticleSystem.h"
+#include "SdfRenderSystem.h"
 #include "SimpleRenderSystem.h"
+#include "SpriteRenderSystem.h"
+#include "VectorFieldRenderSystem.h"
 #include "GravitySystem.h"
+#include "VE_BindlessTable.h"
+#include "VE_MeshCooker.h"
+#include "VE_Profiler.h"
+#include "VE_RenderGraph.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <random>
 #include <stdexcept>
 
 namespace VulkanEngine {
 
-	std::unique_ptr<VEModel> CreateSquareModel(VEDevice& device, glm::vec2 offset)
+	std::unique_ptr<VEModel> CreateCircleModel(VEDevice& device, unsigned int numSides) 
 	{
-		std::vector<VEModel::Vertex> vertices = {
-			{{ -0.5f, -0.5f }},
-			{{  0.5f,  0.5f }},
-			{{ -0.5f,  0.5f }},
-			{{ -0.5f, -0.5f }},
-			{{  0.5f, -0.5f }},
-			{{  0.5f,  0.5f }},
-		};
+		VEMeshFile::SourceMesh circle = VEMeshCooker::CreateCircle(numSides);
+
+		return std::make_unique<VEModel>(device, circle.Vertices, circle.Indices);
+	}
+
+	// Circles from 8 to 128 sides, each used up to the radius where its edges stray half a pixel from the true circle.
+	// Taken from meshFile when it has them, generated otherwise.
+	std::shared_ptr<VEModelLodChain> CreateCircleLodChain(VEDevice& device, const VEMeshFile* meshFile)
+	{
+		constexpr float MAX_ERROR_PIXELS = 0.5f;
 
-		for (auto& v : vertices)
+		auto chain = std::make_shared<VEModelLodChain>();
+
+		for (unsigned int numSides = 8; numSides <= 128; numSides *= 2)
 		{
-			v.position += offset;
+			// A side misses the circle by radius * (1 - cos(pi / numSides)) at its midpoint
+			float maxPixelRadius = MAX_ERROR_PIXELS / (1.0f - glm::cos(glm::pi<float>() / numSides));
+
+			uint32_t mesh = meshFile ? meshFile->FindMesh("circle_" + std::to_string(numSides)) : VEMeshFile::INVALID_MESH;
+
+			if (mesh != VEMeshFile::INVALID_MESH)
+			{
+				chain->AddLevel(meshFile->CreateModel(device, mesh), maxPixelRadius);
+			}
+			else
+			{
+				chain->AddLevel(CreateCircleModel(device, numSides), maxPixelRadius);
+			}
 		}
 
-		return std::make_unique<VEModel>(device, vertices);
+		return chain;
 	}
 
-	std::unique_ptr<VEModel> CreateCircleModel(VEDevice& device, unsigned int numSides) 
+	// Fills the atlas with a set of procedural images in a range of sizes, shapes and colors
+	void CreateSpriteImages(VETextureAtlas& atlas, uint32_t imageCount)
+	{
+		for (uint32_t i = 0; i < imageCount; i++)
+		{
+			uint32_t size = 8 + (i % 8) * 8;
+			// Walk the hue wheel so neighbouring ids get different colors
+			float hue = glm::two_pi<float>() * i / static_cast<float>(imageCount);
+			glm::vec3 tint = {
+				0.5f + 0.5f * glm::cos(hue),
+				0.5f + 0.5f * glm::cos(hue - glm::two_pi<float>() / 3.0f),
+				0.5f + 0.5f * glm::cos(hue + glm::two_pi<float>() / 3.0f) };
+
+			std::vector<uint32_t> pixels(size * size);
+
+			for (uint32_t y = 0; y < size; y++)
+			{
+				for (uint32_t x = 0; x < size; x++)
+				{
+					glm::vec2 p = (glm::vec2(x, y) + 0.5f) / static_cast<float>(size) * 2.0f - 1.0f;
+					float radius = glm::length(p);
+					float alpha = 0.0f;
+
+					switch (i % 4)
+					{
+					case 0: alpha = glm::clamp((1.0f - radius) * 4.0f, 0.0f, 1.0f); break;						// soft disc
+					case 1: alpha = glm::clamp(1.0f - glm::abs(radius - 0.7f) * 8.0f, 0.0f, 1.0f); break;		// ring
+					case 2: alpha = ((x * 4 / size) + (y * 4 / size)) % 2 == 0 ? 1.0f : 0.25f; break;			// checker
+					case 3: alpha = glm::abs(p.x) + glm::abs(p.y) < 1.0f ? 1.0f : 0.0f; break;					// diamond
+					}
+
+					uint32_t r = static_cast<uint32_t>(tint.x * 255.0f);
+					uint32_t g = static_cast<uint32_t>(tint.y * 255.0f);
+					uint32_t b = static_cast<uint32_t>(tint.z * 255.0f);
+					uint32_t a = static_cast<uint32_t>(alpha * 255.0f);
+
+					// R8G8B8A8 in memory order on a little endian host
+					pixels[y * size + x] = r | (g << 8) | (b << 16) | (a << 24);
+				}
+			}
+
+			atlas.AddImage(size, size, pixels.data());
+		}
+	}
+
+	// Grey banded planet with a darkened rim, tinted by each body's color
+	std::unique_ptr<VETexture> CreatePlanetTexture(VEDevice& device, uint32_t size)
 	{
-		std::vector<VEModel::Vertex> uniqueVertices = {};
+		std::vector<uint32_t> pixels(size * size);
 
-		for (int i = 0; i < numSides; i++)
+		for (uint32_t y = 0; y < size; y++)
 		{
-			float angle = i * glm::two_pi<float>() / numSides;
-			uniqueVertices.push_back({ {glm::cos(angle), glm::sin(angle)} });
+			for (uint32_t x = 0; x < size; x++)
+			{
+				glm::vec2 p = (glm::vec2(x, y) + 0.5f) / static_cast<float>(size) * 2.0f - 1.0f;
+				float rim = glm::sqrt(glm::max(1.0f - glm::dot(p, p), 0.0f));
+				float bands = 0.75f + 0.25f * glm::sin(p.y * 9.0f + glm::sin(p.x * 3.0f));
+				uint32_t value = static_cast<uint32_t>(glm::clamp((0.35f + 0.65f * rim) * bands, 0.0f, 1.0f) * 255.0f);
+
+				pixels[y * size + x] = value | (value << 8) | (value << 16) | (255u << 24);
+			}
 		}
 
-		uniqueVertices.push_back({});  // adds center vertex at 0, 0
+		return std::make_unique<VETexture>(device, size, size, 1, pixels.data());
+	}
 
-		std::vector<VEModel::Vertex> vertices = {};
+	// Memory a million vertices or instances take up in the packed formats, against the float layouts they replaced
+	void PrintPackedFormatSavings()
+	{
+		constexpr double BYTES_PER_MILLION_TO_MB = 1000000.0 / (1024.0 * 1024.0);
+		// Float sprite instance and mat2 push constants, as laid out before packing
+		constexpr size_t FLOAT_SPRITE_INSTANCE_SIZE = 56;
+		constexpr size_t FLOAT_OBJECT_PUSH_SIZE = 48;
 
-		for (int i = 0; i < numSides; i++) 
+		struct Format
 		{
-			vertices.push_back(uniqueVertices[i]);
-			vertices.push_back(uniqueVertices[(i + 1) % numSides]);
-			vertices.push_back(uniqueVertices[numSides]);
-		}
+			const char* Name;
+			size_t FloatSize;
+			size_t PackedSize;
+		};
 
-		return std::make_unique<VEModel>(device, vertices);
+		const Format formats[] = {
+			{ "model vertices", sizeof(VEModel::Vertex), sizeof(VEModel::PackedVertex) },
+			{ "sprite instances", FLOAT_SPRITE_INSTANCE_SIZE, SpriteRenderSystem::GetInstanceSize() },
+			{ "object constants", FLOAT_OBJECT_PUSH_SIZE, SimpleRenderSystem::GetPushConstantSize() } };
+
+		std::cout << "packed formats, per million:" << std::endl;
+
+		for (const auto& format : formats)
+		{
+			std::cout << "  " << format.Name << ": " << std::fixed << std::setprecision(1)
+				<< format.FloatSize * BYTES_PER_MILLION_TO_MB << " -> " << format.PackedSize * BYTES_PER_MILLION_TO_MB << " MB ("
+				<< format.FloatSize << " -> " << format.PackedSize << " bytes)" << std::endl;
+		}
 	}
 
-	Application::Application()
+	constexpr uint32_t Application::DEFAULT_HEADLESS_FRAME_COUNT;
+	constexpr size_t Application::TRAIL_LENGTH;
+
+	Application::Application(const ApplicationOptions& applicationOptions)
+		: options{ applicationOptions },
+		window{ options.Headless ? nullptr : std::make_unique<VEWindow>(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE) },
+		device{ window.get() },
+		renderer{ window.get(), device, options.SwapChain, { WINDOW_WIDTH, WINDOW_HEIGHT } }
 	{
+		if (options.Headless && options.FrameCount == 0)
+		{
+			options.FrameCount = DEFAULT_HEADLESS_FRAME_COUNT;
+		}
+
+		if (!options.ShaderDirectory.empty())
+		{
+			device.GetShaderLibrary().SetShaderDirectory(options.ShaderDirectory);
+		}
+
 		LoadGameObjects();
 	}
 
@@ -69,10 +187,15 @@ namespace VulkanEngine {
 
 	void Application::Run()
 	{
-		// create some models
-		// offset model by .5 so rotation occurs at edge rather than center of square
-		std::shared_ptr<VEModel> squareModel = CreateSquareModel(device, { .5f, .0f });  
-		std::shared_ptr<VEModel> circleModel = CreateCircleModel(device, 64);
+		// create some models, from the cooked mesh file when there is one
+		std::unique_ptr<VEMeshFile> meshFile;
+
+		if (!options.MeshPath.empty() && VEMappedFile::Exists(options.MeshPath))
+		{
+			meshFile = std::make_unique<VEMeshFile>(options.MeshPath);
+		}
+
+		std::shared_ptr<VEModelLodChain> circleLods = CreateCircleLodChain(device, meshFile.get());
 
 		// create physics objects
 		std::vector<VEGameObject> physicsObjects = {};
@@ -82,7 +205,8 @@ namespace VulkanEngine {
 		red.m_Transform2D.Translation	= { .5f, .5f };
 		red.m_Color						= { 1.f, 0.f, 0.f };
 		red.m_RigidBody2D.Velocity		= { -.5f, .0f };
-		red.m_Model						= circleModel;
+		red.m_Model						= circleLods->GetModel(0);
+		red.m_LodChain					= circleLods;
 
 		physicsObjects.push_back(std::move(red));
 
@@ -91,58 +215,279 @@ namespace VulkanEngine {
 		blue.m_Transform2D.Translation	= { -.45f, -.25f };
 		blue.m_Color					= { 0.f, 0.f, 1.f };
 		blue.m_RigidBody2D.Velocity		= { .5f, .0f };
-		blue.m_Model					= circleModel;
+		blue.m_Model					= circleLods->GetModel(0);
+		blue.m_LodChain					= circleLods;
 
 		physicsObjects.push_back(std::move(blue));
 
-		// create vector field
-		std::vector<VEGameObject> vectorField{};
-		int gridCount = 40;
-		for (int i = 0; i < gridCount; i++) 
+		// create background sprites, each picking one of the atlas images
+		VETextureAtlas spriteAtlas{ 256 };
+		CreateSpriteImages(spriteAtlas, 64);
+		spriteAtlas.Build(device);
+
+		std::vector<VESprite> sprites(5000);
+		std::mt19937 random{ 1337 };
+		std::uniform_real_distribution<float> unit{ 0.0f, 1.0f };
+
+		for (auto& sprite : sprites)
 		{
-			for (int j = 0; j < gridCount; j++) 
-			{
-				auto vf = VEGameObject::CreateGameObject();
+			sprite.Position		= { unit(random) * 2.0f - 1.0f, unit(random) * 2.0f - 1.0f };
+			sprite.Size			= glm::vec2(0.01f + 0.02f * unit(random));
+			sprite.Rotation		= unit(random) * glm::two_pi<float>();
+			sprite.Color		= { 1.0f, 1.0f, 1.0f, 0.35f };
+			sprite.ImageId		= static_cast<uint32_t>(unit(random) * spriteAtlas.GetImageCount()) % spriteAtlas.GetImageCount();
+		}
+
+		GravityPhysicsSystem gravitySystem{ 0.81f };
+
+		// Ids in each grid are indices into the matching vector
+		VESpatialGrid physicsGrid{ 0.25f };
+
+		for (uint32_t i = 0; i < physicsObjects.size(); i++)
+		{
+			physicsGrid.Insert(i, physicsObjects[i].ComputeBounds());
+		}
+
+		// Textured bodies need descriptor indexing, without it they keep their flat color
+		std::unique_ptr<VETexture> planetTexture;
+		std::unique_ptr<VEBindlessTable> bindlessTable;
+
+		if (device.SupportsDescriptorIndexing())
+		{
+			planetTexture = CreatePlanetTexture(device, 64);
+			bindlessTable = std::make_unique<VEBindlessTable>(device);
 
-				vf.m_Transform2D.Scale = glm::vec2(0.005f);
-				vf.m_Transform2D.Translation = {
-					-1.0f + (i + 0.5f) * 2.0f / gridCount,
-					-1.0f + (j + 0.5f) * 2.0f / gridCount };
-				vf.m_Color = glm::vec3(1.0f);
-				vf.m_Model = squareModel;
+			uint32_t planetIndex = bindlessTable->AddTexture(*planetTexture);
 
-				vectorField.push_back(std::move(vf));
+			for (auto& obj : physicsObjects)
+			{
+				obj.m_TextureIndex = planetIndex;
 			}
 		}
 
-		GravityPhysicsSystem gravitySystem{ 0.81f };
-		Vec2FieldSystem vecFieldSystem{};
+		SimpleRenderSystem simpleRenderSystem(device, pipelineCompiler, renderer.GetSwapChainRenderPass(), bindlessTable.get());
+		SpriteRenderSystem spriteRenderSystem(device, pipelineCompiler, renderer.GetSwapChainRenderPass(), spriteAtlas);
+		VectorFieldRenderSystem vectorFieldRenderSystem(device, pipelineCompiler, renderer.GetSwapChainRenderPass());
+		DrawListRenderSystem drawListRenderSystem(device, pipelineCompiler, renderer.GetSwapChainRenderPass());
+		SdfRenderSystem sdfRenderSystem(device, pipelineCompiler, renderer.GetSwapChainRenderPass());
 
-		SimpleRenderSystem simpleRenderSystem(device, renderer.GetSwapChainRenderPass());
+		std::unique_ptr<GpuParticleSystem> particleSystem;
+		std::vector<VEParticleEmitter> particleEmitters(physicsObjects.size());
 
-		while (!window.Close())
+		if (options.ParticleCapacity > 0)
 		{
-			glfwPollEvents();
-			
+			particleSystem = std::make_unique<GpuParticleSystem>(device, pipelineCompiler, renderer.GetSwapChainRenderPass(), options.ParticleCapacity);
+		}
+
+		// Debug overlay, rebuilt from scratch every frame
+		VEDrawList debugDrawList;
+		std::vector<std::vector<glm::vec2>> trails(physicsObjects.size());
+
+		// The frame as a render graph, which orders the particle simulation against the draws that read it
+		VERenderGraph frameGraph{ device };
+		uint32_t particleResource = VERenderGraph::INVALID_RESOURCE;
+
+		if (particleSystem != nullptr)
+		{
+			particleResource = frameGraph.ImportBuffer("Particles", particleSystem->GetParticleBuffer());
+
+			frameGraph.AddPass("Particle simulation",
+				[&](VERenderGraph::PassBuilder& builder)
+				{
+					builder.Read(particleResource, VEResourceUsage::StorageCompute)
+						.Write(particleResource, VEResourceUsage::StorageCompute);
+				},
+				[&](VkCommandBuffer commandBuffer, const VERenderGraph&)
+				{
+					VE_PROFILE_SCOPE("Particle update");
+
+					// Every body sheds a slow cloud that trails behind it and falls into the others
+					for (uint32_t i = 0; i < physicsObjects.size(); i++)
+					{
+						VEParticleEmitter& emitter = particleEmitters[i];
+
+						emitter.Position	= physicsObjects[i].m_Transform2D.Translation;
+						emitter.Velocity	= physicsObjects[i].m_RigidBody2D.Velocity * 0.5f;
+						emitter.Radius		= 0.05f;
+						emitter.Rate		= 20000.0f;
+						emitter.Lifetime	= 3.0f;
+						emitter.StartColor	= { physicsObjects[i].m_Color, 0.8f };
+						emitter.EndColor	= { physicsObjects[i].m_Color, 0.0f };
+					}
+
+					particleSystem->Update(renderer, commandBuffer, 1.f / 60, particleEmitters, &gravitySystem, &physicsObjects);
+				});
+		}
+
+		// Presents through the swap chain render pass, which handles the swap chain image itself
+		frameGraph.AddPass("Scene",
+			[&](VERenderGraph::PassBuilder& builder)
+			{
+				builder.SetSideEffect();
+
+				if (particleSystem != nullptr)
+				{
+					builder.Read(particleResource, VEResourceUsage::StorageVertex)
+						.Read(particleResource, VEResourceUsage::IndirectBuffer);
+				}
+			},
+			[&](VkCommandBuffer commandBuffer, const VERenderGraph&)
+			{
+				renderer.BeginSwapChainRenderPass(commandBuffer, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+				spriteRenderSystem.RenderSprites(renderer, commandBuffer, sprites);
+
+				// Without a depth buffer later draws end up on top, so the physics objects go last
+				vectorFieldRenderSystem.RenderField(renderer, commandBuffer, gravitySystem, physicsObjects, options.VectorFieldResolution, "Vector field");
+
+				if (particleSystem != nullptr)
+				{
+					particleSystem->Render(renderer, commandBuffer, "Particles");
+				}
+
+				if (options.SdfBodies)
+				{
+					sdfRenderSystem.RenderGameObjects(renderer, commandBuffer, physicsObjects, VESdfShape::Circle, &physicsGrid, "Physics objects");
+				}
+				else
+				{
+					simpleRenderSystem.RenderGameObjectsParallel(renderer, commandBuffer, physicsObjects, &physicsGrid, "Physics objects");
+				}
+
+				if (options.DebugOverlay)
+				{
+					drawListRenderSystem.RenderDrawList(renderer, commandBuffer, debugDrawList, "Debug overlay");
+				}
+
+				renderer.EndSwapChainRenderPass(commandBuffer);
+			});
+
+		frameGraph.Compile();
+		frameGraph.PrintStats();
+		PrintPackedFormatSavings();
+
+		VE_PROFILE_THREAD("Main");
+
+		// Headless runs are benchmarks, start timing once every pipeline exists
+		if (renderer.IsHeadless())
+		{
+			pipelineCompiler.WaitIdle();
+		}
+
+		bool captureKeyWasDown = false;
+		uint32_t frameCount = 0;
+		auto startTime = std::chrono::steady_clock::now();
+
+		while (KeepRunning(frameCount))
+		{
+			if (options.LowLatency)
+			{
+				renderer.WaitForLastSubmittedFrame();
+			}
+
+			if (window != nullptr)
+			{
+				{
+					VE_PROFILE_SCOPE("Poll events");
+					glfwPollEvents();
+				}
+
+				// F12 writes the next 120 frames of CPU scopes to a Chrome trace
+				bool captureKeyDown = window->IsKeyPressed(GLFW_KEY_F12);
+				if (captureKeyDown && !captureKeyWasDown)
+				{
+					VE_PROFILE_CAPTURE(120, "cpu_profile.json");
+				}
+				captureKeyWasDown = captureKeyDown;
+			}
+
+			renderer.MarkInputSampled();
+
 			if (auto commandBuffer = renderer.BeginFrame())
 			{
 				// update systems
-				gravitySystem.Update(physicsObjects, 1.f / 60, 5);
-				vecFieldSystem.Update(gravitySystem, physicsObjects, vectorField);
+				{
+					VE_PROFILE_SCOPE("Physics update");
+					gravitySystem.Update(physicsObjects, 1.f / 60, 5);
+				}
+
+				if (options.DebugOverlay)
+				{
+					VE_PROFILE_SCOPE("Debug overlay");
+					debugDrawList.Clear();
+
+					for (uint32_t i = 0; i < physicsObjects.size(); i++)
+					{
+						auto& trail = trails[i];
+
+						if (trail.size() == TRAIL_LENGTH)
+						{
+							trail.erase(trail.begin());
+						}
+
+						trail.push_back(physicsObjects[i].m_Transform2D.Translation);
+
+						glm::vec4 color{ physicsObjects[i].m_Color, 0.6f };
+						VEBounds2D bounds = physicsObjects[i].ComputeBounds();
+
+						debugDrawList.AddPolyline(trail, color);
+						debugDrawList.AddRect(bounds.Min, bounds.Max, color);
+					}
+				}
+
+				{
+					VE_PROFILE_SCOPE("Spatial grid update");
+
+					for (uint32_t i = 0; i < physicsObjects.size(); i++)
+					{
+						physicsGrid.Update(i, physicsObjects[i].ComputeBounds());
+					}
+				}
 
 				// render system
-				renderer.BeginSwapChainRenderPass(commandBuffer);
-				simpleRenderSystem.RenderGameObjects(commandBuffer, physicsObjects);
+				{
+					VE_PROFILE_SCOPE("Record");
 
-				simpleRenderSystem.RenderGameObjects(commandBuffer, vectorField);
+					frameGraph.Execute(commandBuffer);
+				}
+
+				if (renderer.IsHeadless() && !options.ScreenshotPath.empty() && frameCount + 1 == options.FrameCount)
+				{
+					renderer.RequestReadback(options.ScreenshotPath);
+				}
 
-				renderer.EndSwapChainRenderPass(commandBuffer);
 				renderer.EndFrame();
+				frameCount++;
 			}
+
+			VE_PROFILE_FRAME();
 		}
 
 		// Block the CPU until all GPU operations are completed
 		vkDeviceWaitIdle(device.Device());
+
+		if (renderer.IsHeadless())
+		{
+			double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+			std::cout << "headless: " << frameCount << " frames in " << elapsedMs << " ms, "
+				<< elapsedMs / std::max(frameCount, 1u) << " ms per frame" << std::endl;
+		}
+
+		std::cout << "physics objects: " << simpleRenderSystem.GetDrawnVertexCount() / std::max(frameCount, 1u) << " vertices per frame" << std::endl;
+
+		device.GetAllocator().PrintStats();
+		renderer.GetGpuProfiler().PrintStats();
+		renderer.PrintLatencyStats();
+	}
+
+	bool Application::KeepRunning(uint32_t frameCount)
+	{
+		if (window != nullptr && window->Close())
+		{
+			return false;
+		}
+
+		return options.FrameCount == 0 || frameCount < options.FrameCount;
 	}
 
 	void Application::LoadGameObjects()
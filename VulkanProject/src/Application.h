@@ -1,10 +1,12 @@
 #pragma once
 #include "VE_Device.h"
 #include "VE_GameObject.h"
+#include "VE_PipelineCompiler.h"
 #include "VE_Window.h"
 #include "VE_Renderer.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 const uint32_t WINDOW_WIDTH = 1280;
@@ -13,10 +15,41 @@ const std::string WINDOW_TITLE = "Vulkan Application";
 
 namespace VulkanEngine {
 
+	struct ApplicationOptions
+	{
+		// Renders offscreen without GLFW, a surface or a swap chain, e.g. on build servers and lavapipe
+		bool Headless					= false;
+		// Frames to render before exiting, 0 runs until the window is closed (headless defaults to 300)
+		uint32_t FrameCount				= 0;
+		// Headless only, the last frame is written here as a PPM image
+		std::string ScreenshotPath;
+		// Present mode and frames in flight of the swap chain
+		VESwapChainConfig SwapChain;
+		// Waits for the previous frame to finish on the GPU before polling input, see VERenderer::WaitForLastSubmittedFrame
+		bool LowLatency					= false;
+		// Arrows per side of the vector field grid, evaluated on the GPU
+		uint32_t VectorFieldResolution	= 40;
+		// Draws body trails and bounds through the immediate mode draw list
+		bool DebugOverlay				= false;
+		// Size of the GPU particle pool fed by one emitter per body, 0 disables the particles
+		uint32_t ParticleCapacity		= 262144;
+		// Draws the bodies as analytic SDF circles, one anti-aliased quad each, instead of triangle fans
+		bool SdfBodies					= false;
+		// Cooked meshes, see VEMeshCooker. Meshes missing from it, or the whole file, are generated on startup
+		std::string MeshPath			= "assets/meshes.vemesh";
+		// Maps compiled shaders from this directory instead of using the ones embedded in the executable, so
+		// they can be rebuilt without rebuilding the engine
+		std::string ShaderDirectory;
+	};
+
 	class Application
 	{
 	public:
-		Application();
+		static constexpr uint32_t DEFAULT_HEADLESS_FRAME_COUNT = 300;
+		// Positions kept per body for the debug overlay trails
+		static constexpr size_t TRAIL_LENGTH = 240;
+
+		Application(const ApplicationOptions& applicationOptions = {});
 		~Application();
 
 		// Delete the copy constructor and copy operator
@@ -35,10 +68,14 @@ namespace VulkanEngine {
 			glm::vec2 right,
 			glm::vec2 left);
 
+		bool KeepRunning(uint32_t frameCount);
+
 	private:
-		VEWindow window{ WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE };
-		VEDevice device{ window };
-		VERenderer renderer{ window, device };
+		ApplicationOptions options;
+		std::unique_ptr<VEWindow> window;	// Null when headless
+		VEDevice device;
+		VERenderer renderer;
+		VEPipelineCompiler pipelineCompiler{ device };
 		std::vector<VEGameObject> gameObjects;;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "DrawListRenderSystem.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	DrawListRenderSystem::DrawListRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+		: m_Device{ device }
+	{
+		CreatePipelineLayout();
+		CreatePipeline(pipelineCompiler, renderPass);
+	}
+
+	DrawListRenderSystem::~DrawListRenderSystem()
+	{
+		// The worker may still be compiling against the layout
+		if (m_Pipeline.IsValid())
+		{
+			m_Pipeline.Wait();
+		}
+
+		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
+	}
+
+	void DrawListRenderSystem::CreatePipelineLayout()
+	{
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 0;
+		pipelineLayoutInfo.pSetLayouts = nullptr;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		if (vkCreatePipelineLayout(m_Device.Device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+	}
+
+	void DrawListRenderSystem::CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+	{
+		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+		PipelineConfigInfo pipelineConfig = {};
+
+		VEPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+
+		pipelineConfig.RenderPass = renderPass;
+		pipelineConfig.PipelineLayout = m_PipelineLayout;
+
+		// Overlays go on top of everything drawn before them and may be translucent
+		pipelineConfig.ColorBlendAttachment.blendEnable = VK_TRUE;
+		pipelineConfig.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipelineConfig.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		pipelineConfig.BindingDescriptions = { { 0, sizeof(VEDrawList::Vertex), VK_VERTEX_INPUT_RATE_VERTEX } };
+		pipelineConfig.AttributeDescriptions = {
+			{ 0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(VEDrawList::Vertex, Position) },
+			{ 1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(VEDrawList::Vertex, Color) } };
+
+		m_Pipeline = pipelineCompiler.Compile(
+			"DrawList_Shader.vert",
+			"DrawList_Shader.frag",
+			pipelineConfig);
+	}
+
+	void DrawListRenderSystem::RenderDrawList(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		const VEDrawList& drawList,
+		const char* gpuScope)
+	{
+		VEPipeline* pipeline = m_Pipeline.Get();
+
+		if (pipeline == nullptr || drawList.IsEmpty())
+		{
+			return;
+		}
+
+		const auto& vertices = drawList.GetVertices();
+		const auto& indices = drawList.GetIndices();
+
+		VkDeviceSize vertexBytes = vertices.size() * sizeof(VEDrawList::Vertex);
+		VkDeviceSize indexBytes = indices.size() * sizeof(uint32_t);
+
+		// One allocation for both, the indices follow the vertices
+		VkDeviceSize indexOffset = (vertexBytes + 3) & ~VkDeviceSize(3);
+		VEBufferSlice slice = renderer.GetFrameRingBuffer().Allocate(indexOffset + indexBytes);
+
+		memcpy(slice.MappedData, vertices.data(), static_cast<size_t>(vertexBytes));
+		memcpy(static_cast<char*>(slice.MappedData) + indexOffset, indices.data(), static_cast<size_t>(indexBytes));
+
+		uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+		renderer.RecordParallel(commandBuffer, 1,
+			[&](VkCommandBuffer secondary, uint32_t, uint32_t)
+			{
+				pipeline->Bind(secondary);
+
+				VkDeviceSize vertexOffset = slice.Offset;
+				vkCmdBindVertexBuffers(secondary, 0, 1, &slice.Buffer, &vertexOffset);
+				vkCmdBindIndexBuffer(secondary, slice.Buffer, slice.Offset + indexOffset, VK_INDEX_TYPE_UINT32);
+
+				vkCmdDrawIndexed(secondary, indexCount, 1, 0, 0, 0);
+			},
+			gpuScope);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+#include "VE_Device.h"
+#include "VE_DrawList.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+
+namespace VulkanEngine {
+
+	// Uploads a VEDrawList into the frame ring buffer and draws it with a single indexed draw, there is
+	// only one pipeline state for all of its shapes
+	class DrawListRenderSystem
+	{
+	public:
+		DrawListRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		~DrawListRenderSystem();
+
+		// Delete the copy constructor and copy operator
+		DrawListRenderSystem(const DrawListRenderSystem&) = delete;
+		DrawListRenderSystem& operator=(const DrawListRenderSystem&) = delete;
+
+		// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		void RenderDrawList(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			const VEDrawList& drawList,
+			const char* gpuScope = "DrawListRenderSystem");
+
+		bool IsReady() const { return m_Pipeline.IsReady(); }
+
+	private:
+		void CreatePipelineLayout();
+		void CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+
+	private:
+		VEDevice& m_Device;
+		VEPipelineHandle m_Pipeline;
+		VkPipelineLayout m_PipelineLayout;
+	};
+}
\ No newline at end of file
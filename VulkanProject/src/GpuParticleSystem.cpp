@@ -0,0 +1,409 @@
+#include "GpuParticleSystem.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t GpuParticleSystem::MAX_BODIES;
+	constexpr uint32_t GpuParticleSystem::MAX_CAPACITY;
+
+	// Matches Push in Particle_Simulate.comp, the vertex shader reads the tail of it
+	struct ParticlePushConstantData
+	{
+		glm::vec4 StartColor;
+		glm::vec4 EndColor;
+		glm::vec2 EmitterPosition;
+		glm::vec2 EmitterVelocity;
+		float Direction;
+		float Spread;
+		float SpeedMin;
+		float SpeedMax;
+		float Lifetime;
+		float Size;
+		float Radius;
+		float DeltaTime;
+		float GravityStrength;
+		uint32_t EmitCount;
+		uint32_t BodyCount;
+		uint32_t Capacity;
+		uint32_t CurrentList;
+		uint32_t Seed;
+	};
+
+	static constexpr uint32_t WORK_GROUP_SIZE = 64;
+
+	GpuParticleSystem::GpuParticleSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass, uint32_t capacity)
+		: m_Device{ device }, m_Capacity{ std::min(std::max(capacity, 1u), MAX_CAPACITY) }
+	{
+		CreateBuffers();
+		CreateDescriptorSetLayout();
+		CreatePipelineLayout();
+		CreatePipelines(pipelineCompiler, renderPass);
+	}
+
+	GpuParticleSystem::~GpuParticleSystem()
+	{
+		// The worker may still be compiling against the layout
+		if (m_RenderPipeline.IsValid())
+		{
+			m_RenderPipeline.Wait();
+		}
+
+		for (auto& computePipeline : m_ComputePipelines)
+		{
+			computePipeline.reset();
+		}
+
+		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
+
+		m_Device.DestroyBuffer(m_ParticleBuffer, m_ParticleAllocation);
+		m_Device.DestroyBuffer(m_FreeListBuffer, m_FreeListAllocation);
+		m_Device.DestroyBuffer(m_AliveListBuffer, m_AliveListAllocation);
+		m_Device.DestroyBuffer(m_CounterBuffer, m_CounterAllocation);
+	}
+
+	void GpuParticleSystem::CreateBuffers()
+	{
+		// Only ever touched by the GPU, the init pass fills them in on the first update
+		m_Device.CreateBuffer(
+			m_Capacity * sizeof(GpuParticle),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_ParticleBuffer,
+			m_ParticleAllocation);
+
+		m_Device.CreateBuffer(
+			m_Capacity * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_FreeListBuffer,
+			m_FreeListAllocation);
+
+		m_Device.CreateBuffer(
+			2 * m_Capacity * sizeof(uint32_t),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_AliveListBuffer,
+			m_AliveListAllocation);
+
+		m_Device.CreateBuffer(
+			sizeof(GpuCounters),
+			VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			m_CounterBuffer,
+			m_CounterAllocation);
+	}
+
+	void GpuParticleSystem::CreateDescriptorSetLayout()
+	{
+		m_DescriptorPool = VEDescriptorPool::Builder(m_Device)
+			.SetMaxSets(1)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1)
+			.Build();
+
+		// The vertex shader reads the particles through the same set the compute passes write them with
+		VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+
+		m_DescriptorSetLayout = VEDescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.AddBinding(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.AddBinding(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.AddBinding(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, stages)
+			.AddBinding(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, stages)
+			.Build();
+	}
+
+	void GpuParticleSystem::CreateDescriptorSet(VkBuffer bodyBuffer)
+	{
+		VkDescriptorBufferInfo particleInfo		= { m_ParticleBuffer, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo freeListInfo		= { m_FreeListBuffer, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo aliveListInfo	= { m_AliveListBuffer, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo counterInfo		= { m_CounterBuffer, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo bodyInfo			= { bodyBuffer, 0, MAX_BODIES * sizeof(GpuBody) };
+
+		if (!VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+			.WriteBuffer(0, &particleInfo)
+			.WriteBuffer(1, &freeListInfo)
+			.WriteBuffer(2, &aliveListInfo)
+			.WriteBuffer(3, &counterInfo)
+			.WriteBuffer(4, &bodyInfo)
+			.Build(m_DescriptorSet))
+		{
+			throw std::runtime_error("Failed to allocate the particle descriptor set.");
+		}
+	}
+
+	void GpuParticleSystem::CreatePipelineLayout()
+	{
+		VkDescriptorSetLayout setLayouts[] = { m_DescriptorSetLayout->GetDescriptorSetLayout() };
+
+		VkPushConstantRange pushConstantRange = {};
+
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(ParticlePushConstantData);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = setLayouts;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_Device.Device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+	}
+
+	void GpuParticleSystem::CreatePipelines(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+	{
+		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+		// Every pass is the same shader specialized on its PASS constant
+		VkSpecializationMapEntry mapEntry = { 0, 0, sizeof(uint32_t) };
+
+		for (uint32_t pass = 0; pass < PASS_COUNT; pass++)
+		{
+			VkSpecializationInfo specializationInfo = {};
+
+			specializationInfo.mapEntryCount = 1;
+			specializationInfo.pMapEntries = &mapEntry;
+			specializationInfo.dataSize = sizeof(uint32_t);
+			specializationInfo.pData = &pass;
+
+			m_ComputePipelines[pass] = std::make_unique<VEComputePipeline>(
+				m_Device,
+				"Particle_Simulate.comp",
+				m_PipelineLayout,
+				&specializationInfo);
+		}
+
+		PipelineConfigInfo pipelineConfig = {};
+
+		VEPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+
+		pipelineConfig.RenderPass = renderPass;
+		pipelineConfig.PipelineLayout = m_PipelineLayout;
+
+		// Additive, overlapping particles glow and the draw order between them does not matter
+		pipelineConfig.ColorBlendAttachment.blendEnable = VK_TRUE;
+		pipelineConfig.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipelineConfig.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		pipelineConfig.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		// The particle comes from gl_InstanceIndex and the quad corners from gl_VertexIndex
+		pipelineConfig.BindingDescriptions.clear();
+		pipelineConfig.AttributeDescriptions.clear();
+
+		m_RenderPipeline = pipelineCompiler.Compile(
+			"Particle_Shader.vert",
+			"Particle_Shader.frag",
+			pipelineConfig);
+	}
+
+	void GpuParticleSystem::ComputeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+	{
+		VkMemoryBarrier barrier = {};
+
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = dstAccess;
+
+		vkCmdPipelineBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			dstStage,
+			0,
+			1, &barrier,
+			0, nullptr,
+			0, nullptr);
+	}
+
+	void GpuParticleSystem::Dispatch(VkCommandBuffer commandBuffer, Pass pass, const void* pushConstants, uint32_t groupCount)
+	{
+		m_ComputePipelines[pass]->Bind(commandBuffer);
+
+		vkCmdPushConstants(commandBuffer,
+			m_PipelineLayout,
+			VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+			0,
+			sizeof(ParticlePushConstantData),
+			pushConstants);
+
+		vkCmdDispatch(commandBuffer, groupCount, 1, 1);
+	}
+
+	void GpuParticleSystem::Update(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		float dt,
+		const std::vector<VEParticleEmitter>& emitters,
+		const GravityPhysicsSystem* physicsSystem,
+		const std::vector<VEGameObject>* bodies)
+	{
+		VEFrameRingBuffer& ringBuffer = renderer.GetFrameRingBuffer();
+
+		if (m_DescriptorSet == VK_NULL_HANDLE)
+		{
+			CreateDescriptorSet(ringBuffer.GetBuffer());
+		}
+
+		// Always the full range, the descriptor was written with it
+		VEBufferSlice slice = ringBuffer.Allocate(MAX_BODIES * sizeof(GpuBody));
+		GpuBody* gpuBodies = static_cast<GpuBody*>(slice.MappedData);
+
+		uint32_t bodyCount = 0;
+
+		if (physicsSystem != nullptr && bodies != nullptr)
+		{
+			bodyCount = std::min(static_cast<uint32_t>(bodies->size()), MAX_BODIES);
+
+			for (uint32_t i = 0; i < bodyCount; i++)
+			{
+				gpuBodies[i].Position	= (*bodies)[i].m_Transform2D.Translation;
+				gpuBodies[i].Mass		= (*bodies)[i].m_RigidBody2D.Mass;
+			}
+		}
+
+		ParticlePushConstantData push = {};
+
+		push.DeltaTime			= dt;
+		// A particle's own mass cancels out of its acceleration
+		push.GravityStrength	= physicsSystem != nullptr ? physicsSystem->m_StrengthGravity : 0.0f;
+		push.BodyCount			= bodyCount;
+		push.Capacity			= m_Capacity;
+		push.CurrentList		= m_CurrentList;
+
+		VEGpuProfiler& profiler = renderer.GetGpuProfiler();
+		uint32_t scope = profiler.BeginScope(commandBuffer, "GpuParticleSystem::Update");
+
+		uint32_t dynamicOffset = slice.DynamicOffset();
+
+		vkCmdBindDescriptorSets(commandBuffer,
+			VK_PIPELINE_BIND_POINT_COMPUTE,
+			m_PipelineLayout,
+			0,
+			1,
+			&m_DescriptorSet,
+			1,
+			&dynamicOffset);
+
+		if (!m_Initialized)
+		{
+			Dispatch(commandBuffer, PASS_INIT, &push, (m_Capacity + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE);
+			ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+			m_Initialized = true;
+		}
+
+		m_EmitRemainders.resize(emitters.size(), 0.0f);
+
+		// Emitters that would overflow the pool just fail to pop a free slot on the GPU
+		for (size_t i = 0; i < emitters.size(); i++)
+		{
+			const VEParticleEmitter& emitter = emitters[i];
+
+			float emitCount = emitter.Rate * dt + m_EmitRemainders[i];
+			float wholeCount = std::floor(emitCount);
+
+			m_EmitRemainders[i] = emitCount - wholeCount;
+
+			uint32_t count = static_cast<uint32_t>(std::min(wholeCount, static_cast<float>(m_Capacity)));
+
+			if (count == 0)
+			{
+				continue;
+			}
+
+			push.StartColor			= emitter.StartColor;
+			push.EndColor			= emitter.EndColor;
+			push.EmitterPosition	= emitter.Position;
+			push.EmitterVelocity	= emitter.Velocity;
+			push.Direction			= emitter.Direction;
+			push.Spread				= emitter.Spread;
+			push.SpeedMin			= emitter.SpeedMin;
+			push.SpeedMax			= emitter.SpeedMax;
+			push.Lifetime			= emitter.Lifetime;
+			push.Size				= emitter.Size;
+			push.Radius				= emitter.Radius;
+			push.EmitCount			= count;
+			push.Seed				= m_FrameSeed++;
+
+			Dispatch(commandBuffer, PASS_EMIT, &push, (count + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE);
+			ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+		}
+
+		// Sizes the simulate dispatch from the alive count, which only the GPU knows
+		Dispatch(commandBuffer, PASS_PREPARE, &push, 1);
+		ComputeBarrier(commandBuffer,
+			VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+		m_ComputePipelines[PASS_SIMULATE]->Bind(commandBuffer);
+		vkCmdDispatchIndirect(commandBuffer, m_CounterBuffer, offsetof(GpuCounters, DispatchArgs));
+		ComputeBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT);
+
+		Dispatch(commandBuffer, PASS_FINALIZE, &push, 1);
+
+		profiler.EndScope(commandBuffer, scope);
+
+		// The survivors were compacted into the other list, which is drawn and emitted into next
+		m_CurrentList = 1 - m_CurrentList;
+	}
+
+	void GpuParticleSystem::Render(VERenderer& renderer, VkCommandBuffer commandBuffer, const char* gpuScope)
+	{
+		VEPipeline* pipeline = m_RenderPipeline.Get();
+
+		if (pipeline == nullptr || !m_Initialized)
+		{
+			return;
+		}
+
+		ParticlePushConstantData push = {};
+
+		push.Capacity		= m_Capacity;
+		push.CurrentList	= m_CurrentList;
+
+		// The vertex shader never reads the bodies, any in range offset will do
+		uint32_t dynamicOffset = 0;
+
+		// A single chunk, the instance count is written by the finalize pass
+		renderer.RecordParallel(commandBuffer, 1,
+			[&](VkCommandBuffer secondary, uint32_t, uint32_t)
+			{
+				pipeline->Bind(secondary);
+
+				vkCmdBindDescriptorSets(secondary,
+					VK_PIPELINE_BIND_POINT_GRAPHICS,
+					m_PipelineLayout,
+					0,
+					1,
+					&m_DescriptorSet,
+					1,
+					&dynamicOffset);
+
+				vkCmdPushConstants(secondary,
+					m_PipelineLayout,
+					VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_VERTEX_BIT,
+					0,
+					sizeof(ParticlePushConstantData),
+					&push);
+
+				vkCmdDrawIndirect(secondary, m_CounterBuffer, offsetof(GpuCounters, DrawArgs), 1, sizeof(VkDrawIndirectCommand));
+			},
+			gpuScope);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#pragma once
+#include "GravitySystem.h"
+#include "VE_Descriptors.h"
+#include "VE_Device.h"
+#include "VE_GameObject.h"
+#include "VE_Pipeline.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+	struct VEParticleEmitter
+	{
+		glm::vec2 Position{ 0.0f };
+		glm::vec2 Velocity{ 0.0f };		// Added to every particle, e.g. the velocity of whatever carries the emitter
+		float Direction				= 0.0f;	// Radians
+		float Spread				= 6.2831853f;	// Full circle
+		float SpeedMin				= 0.05f;
+		float SpeedMax				= 0.2f;
+		float Radius				= 0.0f;	// Particles start anywhere inside this disc
+		float Rate					= 1000.0f;	// Particles per second
+		float Lifetime				= 2.0f;	// Seconds
+		float Size					= 0.005f;
+		glm::vec4 StartColor{ 1.0f };
+		glm::vec4 EndColor{ 1.0f, 1.0f, 1.0f, 0.0f };
+	};
+
+	// Particles that never touch the CPU. State lives in device local storage buffers, emission, integration
+	// and compaction of dead particles run in compute each frame, and the survivors are drawn with one
+	// indirect draw whose instance count the GPU writes itself.
+	//
+	// Free particle slots sit on an atomic free list. Emitting pops from it and appends to the current alive
+	// list, simulating pushes dead particles back and compacts the rest into the other alive list, which is
+	// what gets drawn and becomes the current list of the next frame.
+	class GpuParticleSystem
+	{
+	public:
+		// Bodies past this many are left out of the gravity field
+		static constexpr uint32_t MAX_BODIES = 1024;
+		// One thread per particle in the init pass, kept within the guaranteed 65535 work groups
+		static constexpr uint32_t MAX_CAPACITY = 65535 * 64;
+
+		GpuParticleSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass, uint32_t capacity);
+		~GpuParticleSystem();
+
+		// Delete the copy constructor and copy operator
+		GpuParticleSystem(const GpuParticleSystem&) = delete;
+		GpuParticleSystem& operator=(const GpuParticleSystem&) = delete;
+
+		// Records emission and simulation, call between BeginFrame and the render pass. With a physics system
+		// the particles are pulled by bodies the same way the bodies pull each other.
+		//
+		// Only the passes inside the update are synchronized. Ordering it after the previous frame's Render and
+		// before this frame's is up to the caller, e.g. a render graph with GetParticleBuffer written by
+		// VEResourceUsage::StorageCompute here and read as StorageVertex and IndirectBuffer by Render.
+		void Update(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			float dt,
+			const std::vector<VEParticleEmitter>& emitters,
+			const GravityPhysicsSystem* physicsSystem = nullptr,
+			const std::vector<VEGameObject>* bodies = nullptr);
+
+		// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		void Render(VERenderer& renderer, VkCommandBuffer commandBuffer, const char* gpuScope = "GpuParticleSystem");
+
+		uint32_t GetCapacity() const { return m_Capacity; }
+		// Stands in for all of the particle state, the barriers it needs are global memory barriers
+		VkBuffer GetParticleBuffer() const { return m_ParticleBuffer; }
+
+	private:
+		// Matches the PASS specialization constant in Particle_Simulate.comp
+		enum Pass : uint32_t
+		{
+			PASS_INIT,
+			PASS_EMIT,
+			PASS_PREPARE,
+			PASS_SIMULATE,
+			PASS_FINALIZE,
+			PASS_COUNT
+		};
+
+		// Matches Particle in Particle_Simulate.comp and Particle_Shader.vert
+		struct GpuParticle
+		{
+			glm::vec2 Position;
+			glm::vec2 Velocity;
+			float Age;
+			float Lifetime;
+			float Size;
+			uint32_t StartColor;
+			uint32_t EndColor;
+			float Padding;
+		};
+
+		// Matches Counters in Particle_Simulate.comp, the indirect arguments are read straight from it
+		struct GpuCounters
+		{
+			uint32_t AliveCount[2];
+			int32_t FreeCount;
+			uint32_t Padding;
+			VkDispatchIndirectCommand DispatchArgs;
+			uint32_t Padding1;
+			VkDrawIndirectCommand DrawArgs;
+		};
+
+		// Matches Body in Particle_Simulate.comp
+		struct GpuBody
+		{
+			glm::vec2 Position;
+			float Mass;
+			float Padding;
+		};
+
+		void CreateBuffers();
+		void CreateDescriptorSetLayout();
+		void CreatePipelineLayout();
+		void CreatePipelines(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		void CreateDescriptorSet(VkBuffer bodyBuffer);
+		void Dispatch(VkCommandBuffer commandBuffer, Pass pass, const void* pushConstants, uint32_t groupCount);
+		// Makes the previous pass's writes visible to dstStage
+		static void ComputeBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+	private:
+		VEDevice& m_Device;
+		uint32_t m_Capacity;
+
+		VkBuffer m_ParticleBuffer;
+		VEAllocation m_ParticleAllocation;
+		VkBuffer m_FreeListBuffer;
+		VEAllocation m_FreeListAllocation;
+		VkBuffer m_AliveListBuffer;					// Two lists of m_Capacity indices back to back
+		VEAllocation m_AliveListAllocation;
+		VkBuffer m_CounterBuffer;
+		VEAllocation m_CounterAllocation;
+
+		std::unique_ptr<VEDescriptorPool> m_DescriptorPool;
+		std::unique_ptr<VEDescriptorSetLayout> m_DescriptorSetLayout;
+		// Bodies come from the frame ring buffer, so the set is written on the first update
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+		VkPipelineLayout m_PipelineLayout;
+		std::unique_ptr<VEComputePipeline> m_ComputePipelines[PASS_COUNT];
+		VEPipelineHandle m_RenderPipeline;
+
+		bool m_Initialized = false;
+		uint32_t m_CurrentList = 0;					// Alive list the next update emits into
+		uint32_t m_FrameSeed = 0;
+		std::vector<float> m_EmitRemainders;		// Fractional particles carried over per emitter
+	};
+}
\ No newline at end of file
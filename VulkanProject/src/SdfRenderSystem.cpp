@@ -0,0 +1,280 @@
+#include "SdfRenderSystem.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	struct SdfPushConstantData
+	{
+		glm::vec2 PixelSize;	// In clip space, the quads are grown by a pixel to fit the anti-aliased edge
+	};
+
+	SdfRenderSystem::SdfRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+		: m_Device{ device }
+	{
+		CreatePipelineLayout();
+		CreatePipeline(pipelineCompiler, renderPass);
+	}
+
+	SdfRenderSystem::~SdfRenderSystem()
+	{
+		// The worker may still be compiling against the layout
+		if (m_Pipeline.IsValid())
+		{
+			m_Pipeline.Wait();
+		}
+
+		for (auto& instanceBuffer : m_InstanceBuffers)
+		{
+			if (instanceBuffer.Buffer != VK_NULL_HANDLE)
+			{
+				m_Device.DestroyBuffer(instanceBuffer.Buffer, instanceBuffer.Allocation);
+			}
+		}
+
+		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
+	}
+
+	void SdfRenderSystem::CreatePipelineLayout()
+	{
+		VkPushConstantRange pushConstantRange = {};
+
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(SdfPushConstantData);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 0;
+		pipelineLayoutInfo.pSetLayouts = nullptr;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_Device.Device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+	}
+
+	void SdfRenderSystem::CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+	{
+		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+		PipelineConfigInfo pipelineConfig = {};
+
+		VEPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+
+		pipelineConfig.RenderPass = renderPass;
+		pipelineConfig.PipelineLayout = m_PipelineLayout;
+
+		// Four vertices per instance
+		pipelineConfig.InputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+
+		// Coverage goes out as alpha, blended like the sprites
+		pipelineConfig.ColorBlendAttachment.blendEnable = VK_TRUE;
+		pipelineConfig.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipelineConfig.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		pipelineConfig.BindingDescriptions = { { 0, sizeof(SdfInstance), VK_VERTEX_INPUT_RATE_INSTANCE } };
+		pipelineConfig.AttributeDescriptions = {
+			{ 0, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(SdfInstance, Translation) },
+			{ 1, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(SdfInstance, Scale) },
+			{ 2, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(SdfInstance, Color) },
+			{ 3, 0, VK_FORMAT_R16_SNORM, offsetof(SdfInstance, Rotation) },
+			{ 4, 0, VK_FORMAT_R8_UINT, offsetof(SdfInstance, Shape) },
+			{ 5, 0, VK_FORMAT_R8_UNORM, offsetof(SdfInstance, Thickness) } };
+
+		m_Pipeline = pipelineCompiler.Compile(
+			"Sdf_Shader.vert",
+			"Sdf_Shader.frag",
+			pipelineConfig);
+	}
+
+	SdfRenderSystem::SdfInstance SdfRenderSystem::PackInstance(glm::vec2 translation,
+		glm::vec2 scale,
+		float rotation,
+		const glm::vec4& color,
+		VESdfShape shape,
+		float thickness)
+	{
+		// Wrapped to -pi to pi for the snorm encoding
+		float angle = glm::mod(rotation + glm::pi<float>(), glm::two_pi<float>()) - glm::pi<float>();
+
+		SdfInstance instance;
+
+		instance.Translation	= glm::packHalf2x16(translation);
+		instance.Scale			= glm::packHalf2x16(scale);
+		instance.Color			= glm::packUnorm4x8(color);
+		instance.Rotation		= static_cast<int16_t>(glm::round(angle / glm::pi<float>() * 32767.0f));
+		instance.Shape			= static_cast<uint8_t>(shape);
+		instance.Thickness		= static_cast<uint8_t>(glm::round(glm::clamp(thickness, 0.0f, 1.0f) * 255.0f));
+
+		return instance;
+	}
+
+	uint32_t SdfRenderSystem::ReserveInstances(VERenderer& renderer, uint32_t count)
+	{
+		if (m_InstanceBuffers.size() != renderer.GetFramesInFlight())
+		{
+			m_InstanceBuffers.resize(renderer.GetFramesInFlight());
+		}
+
+		InstanceBuffer& instanceBuffer = m_InstanceBuffers[renderer.GetFrameIndex()];
+
+		// The GPU finished with this frame index's last use before the frame began
+		if (instanceBuffer.FrameNumber != renderer.GetFrameNumber())
+		{
+			instanceBuffer.FrameNumber = renderer.GetFrameNumber();
+			instanceBuffer.Used = 0;
+		}
+
+		if (instanceBuffer.Used + count > instanceBuffer.Capacity)
+		{
+			// Earlier draws this frame still read the old buffer, so it goes once the frame has finished
+			if (instanceBuffer.Buffer != VK_NULL_HANDLE)
+			{
+				VEDevice* device = &m_Device;
+				VkBuffer buffer = instanceBuffer.Buffer;
+				VEAllocation allocation = instanceBuffer.Allocation;
+
+				m_Device.GetDeletionQueue().Push([device, buffer, allocation]() mutable { device->DestroyBuffer(buffer, allocation); });
+			}
+
+			instanceBuffer.Capacity = std::max({ count, instanceBuffer.Capacity * 2, 1024u });
+			instanceBuffer.Used = 0;
+
+			m_Device.CreateBuffer(instanceBuffer.Capacity * sizeof(SdfInstance),
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+				VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+				instanceBuffer.Buffer,
+				instanceBuffer.Allocation);
+		}
+
+		uint32_t first = instanceBuffer.Used;
+		instanceBuffer.Used += count;
+
+		return first;
+	}
+
+	void SdfRenderSystem::Record(VERenderer& renderer, VkCommandBuffer commandBuffer, uint32_t count, const PackFunction& pack, const char* gpuScope)
+	{
+		VEPipeline* pipeline = m_Pipeline.Get();
+
+		if (pipeline == nullptr || count == 0)
+		{
+			return;
+		}
+
+		uint32_t firstInstance = ReserveInstances(renderer, count);
+		const InstanceBuffer& instanceBuffer = m_InstanceBuffers[renderer.GetFrameIndex()];
+		SdfInstance* instances = static_cast<SdfInstance*>(instanceBuffer.Allocation.MappedData) + firstInstance;
+
+		VkExtent2D extent = renderer.GetSwapChainExtent();
+		SdfPushConstantData push = {};
+
+		push.PixelSize = { 2.0f / extent.width, 2.0f / extent.height };
+
+		// Every chunk packs its own range of instances on its worker before drawing it
+		renderer.RecordParallel(commandBuffer, count,
+			[&](VkCommandBuffer secondary, uint32_t first, uint32_t chunkCount)
+			{
+				pack(instances + first, first, chunkCount);
+
+				pipeline->Bind(secondary);
+
+				vkCmdPushConstants(secondary,
+					m_PipelineLayout,
+					VK_SHADER_STAGE_VERTEX_BIT,
+					0,
+					sizeof(SdfPushConstantData),
+					&push);
+
+				VkDeviceSize offset = 0;
+				vkCmdBindVertexBuffers(secondary, 0, 1, &instanceBuffer.Buffer, &offset);
+
+				vkCmdDraw(secondary, 4, chunkCount, 0, firstInstance + first);
+			},
+			gpuScope);
+
+		// Host visible memory is not necessarily coherent
+		if ((m_Device.GetAllocator().GetMemoryTypeProperties(instanceBuffer.Allocation.MemoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) == 0)
+		{
+			m_Device.GetAllocator().Flush(instanceBuffer.Allocation, firstInstance * sizeof(SdfInstance), count * sizeof(SdfInstance));
+		}
+	}
+
+	void SdfRenderSystem::RenderPrimitives(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		const std::vector<VESdfPrimitive>& primitives,
+		const char* gpuScope)
+	{
+		Record(renderer, commandBuffer, static_cast<uint32_t>(primitives.size()),
+			[&](SdfInstance* instances, uint32_t first, uint32_t count)
+			{
+				for (uint32_t i = 0; i < count; i++)
+				{
+					const VESdfPrimitive& primitive = primitives[first + i];
+
+					instances[i] = PackInstance(primitive.Translation,
+						primitive.Scale,
+						primitive.Rotation,
+						primitive.Color,
+						primitive.Shape,
+						primitive.Thickness);
+				}
+			},
+			gpuScope);
+	}
+
+	void SdfRenderSystem::RenderGameObjects(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		const std::vector<VEGameObject>& gameObjects,
+		VESdfShape shape,
+		const VESpatialGrid* cullingGrid,
+		const char* gpuScope)
+	{
+		m_VisibleIds.clear();
+
+		// There is no camera yet, so the visible region is all of clip space
+		if (cullingGrid != nullptr)
+		{
+			cullingGrid->QueryRect({ { -1.0f, -1.0f }, { 1.0f, 1.0f } }, m_VisibleIds);
+		}
+
+		const uint32_t* ids = cullingGrid != nullptr ? m_VisibleIds.data() : nullptr;
+		uint32_t count = ids != nullptr ? static_cast<uint32_t>(m_VisibleIds.size()) : static_cast<uint32_t>(gameObjects.size());
+
+		// Only rings and rounded rects read it
+		float thickness = VESdfPrimitive{}.Thickness;
+
+		Record(renderer, commandBuffer, count,
+			[&](SdfInstance* instances, uint32_t first, uint32_t chunkCount)
+			{
+				for (uint32_t i = 0; i < chunkCount; i++)
+				{
+					const VEGameObject& obj = gameObjects[ids != nullptr ? ids[first + i] : first + i];
+
+					instances[i] = PackInstance(obj.m_Transform2D.Translation,
+						obj.m_Transform2D.Scale,
+						obj.m_Transform2D.Rotation,
+						glm::vec4(obj.m_Color, 1.0f),
+						shape,
+						thickness);
+				}
+			},
+			gpuScope);
+	}
+}
\ No newline at end of file
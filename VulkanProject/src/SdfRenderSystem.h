@@ -0,0 +1,107 @@
+#pragma once
+#include "VE_Device.h"
+#include "VE_GameObject.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+#include "VE_SpatialGrid.h"
+
+#include <functional>
+#include <vector>
+
+namespace VulkanEngine {
+
+	enum class VESdfShape : uint8_t
+	{
+		Circle,
+		Ring,
+		Capsule,		// Rounded along its longer axis
+		RoundedRect
+	};
+
+	// Position, scale, rotation and color mean the same as for a game object drawn by SimpleRenderSystem with
+	// a model spanning -1 to 1, so Scale is the half size of the shape before rotation
+	struct VESdfPrimitive
+	{
+		glm::vec2 Translation{ 0.0f };
+		glm::vec2 Scale{ 0.05f };
+		float Rotation				= 0.0f;
+		glm::vec4 Color{ 1.0f };
+		VESdfShape Shape			= VESdfShape::Circle;
+		// Ring width or corner radius, as a fraction of the smaller half size
+		float Thickness				= 0.25f;
+	};
+
+	// Draws circles, rings, capsules and rounded rects as one quad each, with coverage computed from the
+	// signed distance to the shape in the fragment shader. Edges are anti-aliased over one pixel at any scale
+	// without MSAA, and every shape costs four vertices however large it is on screen.
+	//
+	// Instances are packed into 16 bytes and streamed through a host visible buffer per frame in flight, which
+	// grows to fit, so the count is not bounded by the frame ring buffer.
+	class SdfRenderSystem
+	{
+	public:
+		SdfRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		~SdfRenderSystem();
+
+		// Delete the copy constructor and copy operator
+		SdfRenderSystem(const SdfRenderSystem&) = delete;
+		SdfRenderSystem& operator=(const SdfRenderSystem&) = delete;
+
+		// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		void RenderPrimitives(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			const std::vector<VESdfPrimitive>& primitives,
+			const char* gpuScope = "SdfRenderSystem");
+
+		// Draws every object as shape from its transform and color instead of its model. With a culling grid,
+		// whose ids are indices into gameObjects, only the objects overlapping the viewport are drawn.
+		void RenderGameObjects(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			const std::vector<VEGameObject>& gameObjects,
+			VESdfShape shape = VESdfShape::Circle,
+			const VESpatialGrid* cullingGrid = nullptr,
+			const char* gpuScope = "SdfRenderSystem");
+
+		bool IsReady() const { return m_Pipeline.IsReady(); }
+
+	private:
+		// Matches the instance attributes in Sdf_Shader.vert
+		struct SdfInstance
+		{
+			uint32_t Translation;	// R16G16_SFLOAT
+			uint32_t Scale;			// R16G16_SFLOAT
+			uint32_t Color;			// R8G8B8A8_UNORM, red in the lowest byte
+			int16_t Rotation;		// R16_SNORM, the angle divided by pi
+			uint8_t Shape;			// R8_UINT
+			uint8_t Thickness;		// R8_UNORM
+		};
+
+		// Fills instances[0, count) with items [first, first + count)
+		using PackFunction = std::function<void(SdfInstance* instances, uint32_t first, uint32_t count)>;
+
+		struct InstanceBuffer
+		{
+			VkBuffer Buffer					= VK_NULL_HANDLE;
+			VEAllocation Allocation;
+			uint32_t Capacity				= 0;
+			uint32_t Used					= 0;	// Instances written in FrameNumber
+			uint64_t FrameNumber			= 0;
+		};
+
+		void CreatePipelineLayout();
+		void CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		// Room for count more instances in the current frame's buffer, growing it if needed. Returns the first.
+		uint32_t ReserveInstances(VERenderer& renderer, uint32_t count);
+		void Record(VERenderer& renderer, VkCommandBuffer commandBuffer, uint32_t count, const PackFunction& pack, const char* gpuScope);
+
+		static SdfInstance PackInstance(glm::vec2 translation, glm::vec2 scale, float rotation, const glm::vec4& color, VESdfShape shape, float thickness);
+
+	private:
+		VEDevice& m_Device;
+		VEPipelineHandle m_Pipeline;
+		VkPipelineLayout m_PipelineLayout;
+
+		std::vector<InstanceBuffer> m_InstanceBuffers;	// One per frame in flight
+		std::vector<uint32_t> m_VisibleIds;
+	};
+}
\ No newline at end of file
@@ -12,22 +12,39 @@
 
 namespace VulkanEngine {
 
+	// 28 bytes, the vertex shader rebuilds the matrix from the rotation and scale
 	struct SimplePushConstantData
 	{
-		glm::mat2 Transform{ 1.0f };
-		glm::vec2 Offset;
-		alignas(16) glm::vec3 Color;
+		glm::vec2 Translation;
+		glm::vec2 Scale;
+		float Rotation;
+		uint32_t Color;		// RGBA8, red in the lowest byte
+		uint32_t TextureIndex = VEBindlessTable::INVALID_INDEX;
 	};
 
-	SimpleRenderSystem::SimpleRenderSystem(VEDevice& device, VkRenderPass renderPass)
-		: m_Device{device}
+	SimpleRenderSystem::SimpleRenderSystem(VEDevice& device,
+		VEPipelineCompiler& pipelineCompiler,
+		VkRenderPass renderPass,
+		const VEBindlessTable* bindlessTable)
+		: m_Device{device}, m_BindlessTable{ bindlessTable }
 	{
 		CreatePipelineLayout();
-		CreatePipeline(renderPass);
+		CreatePipeline(pipelineCompiler, renderPass);
+	}
+
+	size_t SimpleRenderSystem::GetPushConstantSize()
+	{
+		return sizeof(SimplePushConstantData);
 	}
 
 	SimpleRenderSystem::~SimpleRenderSystem()
 	{
+		// The worker may still be compiling against the layout
+		if (m_Pipeline.IsValid())
+		{
+			m_Pipeline.Wait();
+		}
+
 		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
 	}
 
@@ -39,11 +56,13 @@ namespace VulkanEngine {
 		pushConstantRange.offset = 0;
 		pushConstantRange.size = sizeof(SimplePushConstantData);
 
+		VkDescriptorSetLayout bindlessSetLayout = m_BindlessTable != nullptr ? m_BindlessTable->GetDescriptorSetLayout() : VK_NULL_HANDLE;
+
 		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
 
 		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutInfo.setLayoutCount = 0;
-		pipelineLayoutInfo.pSetLayouts = nullptr;
+		pipelineLayoutInfo.setLayoutCount = m_BindlessTable != nullptr ? 1 : 0;
+		pipelineLayoutInfo.pSetLayouts = m_BindlessTable != nullptr ? &bindlessSetLayout : nullptr;
 		pipelineLayoutInfo.pushConstantRangeCount = 1;
 		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
@@ -53,7 +72,7 @@ namespace VulkanEngine {
 		}
 	}
 
-	void SimpleRenderSystem::CreatePipeline(VkRenderPass renderPass)
+	void SimpleRenderSystem::CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
 	{
 		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
 
@@ -64,25 +83,151 @@ namespace VulkanEngine {
 		pipelineConfig.RenderPass = renderPass;
 		pipelineConfig.PipelineLayout = m_PipelineLayout;
 
-		m_Pipeline = std::make_unique<VEPipeline>(m_Device,
-			"shaders/simple_shader.vert.spv",
-			"shaders/simple_shader.frag.spv",
+		m_Pipeline = pipelineCompiler.Compile(
+			"Simple_Shader.vert",
+			m_BindlessTable != nullptr ? "Simple_Bindless_Shader.frag" : "Simple_Shader.frag",
 			pipelineConfig);
 	}
 
-	void SimpleRenderSystem::RenderGameObjects(VkCommandBuffer commandBuffer, std::vector<VEGameObject>& gameObjects)
+	bool SimpleRenderSystem::CullGameObjects(const VESpatialGrid* cullingGrid)
+	{
+		m_VisibleIds.clear();
+
+		if (cullingGrid == nullptr)
+		{
+			return false;
+		}
+
+		cullingGrid->QueryRect(GetViewportBounds(), m_VisibleIds);
+		return true;
+	}
+
+	void SimpleRenderSystem::RenderGameObjects(VkCommandBuffer commandBuffer,
+		std::vector<VEGameObject>& gameObjects,
+		const VESpatialGrid* cullingGrid,
+		VEGpuProfiler* profiler,
+		const char* gpuScope)
+	{
+		VEPipeline* pipeline = m_Pipeline.Get();
+
+		if (pipeline == nullptr)
+		{
+			return;
+		}
+
+		uint32_t scope = profiler != nullptr ? profiler->BeginScope(commandBuffer, gpuScope) : VEGpuProfiler::INVALID_SCOPE;
+
+		if (CullGameObjects(cullingGrid))
+		{
+			RecordGameObjects(commandBuffer, *pipeline, gameObjects, m_VisibleIds.data(), 0, static_cast<uint32_t>(m_VisibleIds.size()));
+		}
+		else
+		{
+			RecordGameObjects(commandBuffer, *pipeline, gameObjects, nullptr, 0, static_cast<uint32_t>(gameObjects.size()));
+		}
+
+		if (profiler != nullptr)
+		{
+			profiler->EndScope(commandBuffer, scope);
+		}
+	}
+
+	void SimpleRenderSystem::RenderGameObjectsParallel(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		std::vector<VEGameObject>& gameObjects,
+		const VESpatialGrid* cullingGrid,
+		const char* gpuScope)
 	{
-		m_Pipeline->Bind(commandBuffer);
+		VEPipeline* pipeline = m_Pipeline.Get();
 
-		for (auto& obj : gameObjects)
+		if (pipeline == nullptr)
 		{
+			return;
+		}
+
+		m_ViewportExtent = renderer.GetSwapChainExtent();
+
+		const uint32_t* ids = CullGameObjects(cullingGrid) ? m_VisibleIds.data() : nullptr;
+		uint32_t count = ids != nullptr ? static_cast<uint32_t>(m_VisibleIds.size()) : static_cast<uint32_t>(gameObjects.size());
+
+		// Each chunk touches a disjoint range of objects, so the workers never share one
+		renderer.RecordParallel(commandBuffer, count,
+			[&](VkCommandBuffer secondary, uint32_t first, uint32_t chunkCount)
+			{
+				RecordGameObjects(secondary, *pipeline, gameObjects, ids, first, chunkCount);
+			},
+			gpuScope);
+	}
+
+	void SimpleRenderSystem::SelectLod(VEGameObject& obj) const
+	{
+		uint32_t level = obj.m_LodChain->GetLevelCount() - 1;
+
+		if (m_ViewportExtent.width > 0 && m_ViewportExtent.height > 0)
+		{
+			// Clip space is 2 units across the viewport, every level shares the same bounds
+			glm::vec2 halfExtent = obj.m_LodChain->GetModel(0)->GetBounds().HalfExtent() * glm::abs(obj.m_Transform2D.Scale);
+			float pixelRadius = glm::max(halfExtent.x * m_ViewportExtent.width, halfExtent.y * m_ViewportExtent.height) * 0.5f;
+
+			level = obj.m_LodChain->SelectLevel(pixelRadius, obj.m_LodLevel);
+		}
+
+		// Only touch the shared pointer on a switch, its count is shared by every worker drawing the model
+		if (level != obj.m_LodLevel || obj.m_Model == nullptr)
+		{
+			obj.m_LodLevel = level;
+			obj.m_Model = obj.m_LodChain->GetModel(level);
+		}
+	}
+
+	void SimpleRenderSystem::RecordGameObjects(VkCommandBuffer commandBuffer,
+		VEPipeline& pipeline,
+		std::vector<VEGameObject>& gameObjects,
+		const uint32_t* ids,
+		uint32_t first,
+		uint32_t count)
+	{
+		pipeline.Bind(commandBuffer);
+
+		// One bind for every texture the objects use
+		if (m_BindlessTable != nullptr)
+		{
+			m_BindlessTable->Bind(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout);
+		}
+
+		// Objects sharing a model, such as bodies on the same LOD level, share one vertex buffer bind
+		const VEModel* boundModel = nullptr;
+		uint64_t vertexCount = 0;
+
+		for (uint32_t i = first; i < first + count; i++)
+		{
+			auto& obj = gameObjects[ids != nullptr ? ids[i] : i];
+
 			obj.m_Transform2D.Rotation = glm::mod(obj.m_Transform2D.Rotation + 0.01f, glm::two_pi<float>());
 
+			if (obj.m_LodChain != nullptr)
+			{
+				SelectLod(obj);
+			}
+
+			// Still streaming in on the transfer queue
+			if (!obj.m_Model->IsReady())
+			{
+				continue;
+			}
+
 			SimplePushConstantData push = {};
 
-			push.Offset = obj.m_Transform2D.Translation;
-			push.Color = obj.m_Color;
-			push.Transform = obj.m_Transform2D.Mat2();
+			// Rotation and scale commute with the per axis dequantization of the packed positions
+			push.Translation = obj.m_Transform2D.Translation + obj.m_Transform2D.Mat2() * obj.m_Model->GetPositionOffset();
+			push.Scale = obj.m_Transform2D.Scale * obj.m_Model->GetPositionScale();
+			push.Rotation = obj.m_Transform2D.Rotation;
+			push.Color = glm::packUnorm4x8(glm::vec4(obj.m_Color, 1.0f));
+
+			if (m_BindlessTable != nullptr && m_BindlessTable->IsTextureReady(obj.m_TextureIndex))
+			{
+				push.TextureIndex = obj.m_TextureIndex;
+			}
 
 			vkCmdPushConstants(commandBuffer,
 				m_PipelineLayout,
@@ -91,8 +236,16 @@ namespace VulkanEngine {
 				sizeof(SimplePushConstantData),
 				&push);
 
-			obj.m_Model->Bind(commandBuffer);
+			if (obj.m_Model.get() != boundModel)
+			{
+				obj.m_Model->Bind(commandBuffer);
+				boundModel = obj.m_Model.get();
+			}
+
 			obj.m_Model->Draw(commandBuffer);
+			vertexCount += obj.m_Model->GetVertexCount();
 		}
+
+		m_DrawnVertexCount.fetch_add(vertexCount, std::memory_order_relaxed);
 	}
 }
\ No newline at end of file
@@ -1,8 +1,13 @@
 #pragma once
+#include "VE_BindlessTable.h"
 #include "VE_Device.h"
 #include "VE_GameObject.h"
 #include "VE_Pipeline.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+#include "VE_SpatialGrid.h"
 
+#include <atomic>
 #include <memory>
 #include <vector>
 
@@ -12,22 +17,72 @@ namespace VulkanEngine {
 	class SimpleRenderSystem
 	{
 	public:
-		SimpleRenderSystem(VEDevice& device, VkRenderPass renderPass);
+		// With a bindless table the objects are textured with their m_TextureIndex, bound as set 0
+		SimpleRenderSystem(VEDevice& device,
+			VEPipelineCompiler& pipelineCompiler,
+			VkRenderPass renderPass,
+			const VEBindlessTable* bindlessTable = nullptr);
 		~SimpleRenderSystem();
 
 		// Delete the copy constructor and copy operator
 		SimpleRenderSystem(const SimpleRenderSystem&) = delete;
 		SimpleRenderSystem& operator=(const SimpleRenderSystem&) = delete;
 
-		void RenderGameObjects(VkCommandBuffer commandBuffer, std::vector<VEGameObject>& gameObjects);
+		// Draws nothing until the pipeline has finished compiling. With a culling grid, whose ids are indices
+		// into gameObjects, only the objects overlapping the viewport are drawn. With a profiler the draws are
+		// timed under gpuScope.
+		void RenderGameObjects(VkCommandBuffer commandBuffer,
+			std::vector<VEGameObject>& gameObjects,
+			const VESpatialGrid* cullingGrid = nullptr,
+			VEGpuProfiler* profiler = nullptr,
+			const char* gpuScope = "SimpleRenderSystem");
+
+		// Same as RenderGameObjects, but spreads the objects over secondary command buffers recorded in parallel.
+		// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS. Takes the viewport
+		// extent from the renderer.
+		void RenderGameObjectsParallel(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			std::vector<VEGameObject>& gameObjects,
+			const VESpatialGrid* cullingGrid = nullptr,
+			const char* gpuScope = "SimpleRenderSystem");
+
+		// There is no camera yet, so the visible region is all of clip space
+		static VEBounds2D GetViewportBounds() { return { { -1.0f, -1.0f }, { 1.0f, 1.0f } }; }
+
+		bool IsReady() const { return m_Pipeline.IsReady(); }
+
+		// Size of the viewport in pixels, which LOD chains are selected against. Until it is set every object
+		// with a chain is drawn at its finest level.
+		void SetViewportExtent(VkExtent2D extent) { m_ViewportExtent = extent; }
+
+		// Vertices submitted since creation, for judging how well the LOD chains keep the workload down
+		uint64_t GetDrawnVertexCount() const { return m_DrawnVertexCount.load(std::memory_order_relaxed); }
+
+		// Bytes pushed per object drawn
+		static size_t GetPushConstantSize();
 
 	private:
 		void CreatePipelineLayout();
-		void CreatePipeline(VkRenderPass renderPass);
+		void CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		// Collects the viewport's ids into m_VisibleIds, or returns false when there is nothing to cull with
+		bool CullGameObjects(const VESpatialGrid* cullingGrid);
+		// Points obj.m_Model at the level of its chain that fits its radius in pixels
+		void SelectLod(VEGameObject& obj) const;
+		// Records gameObjects[ids[first + i]], or gameObjects[first + i] when ids is null
+		void RecordGameObjects(VkCommandBuffer commandBuffer,
+			VEPipeline& pipeline,
+			std::vector<VEGameObject>& gameObjects,
+			const uint32_t* ids,
+			uint32_t first,
+			uint32_t count);
 
 	private:
 		VEDevice& m_Device;
-		std::unique_ptr<VEPipeline> m_Pipeline;
+		const VEBindlessTable* m_BindlessTable;
+		VEPipelineHandle m_Pipeline;
 		VkPipelineLayout m_PipelineLayout;
+		std::vector<uint32_t> m_VisibleIds;
+		VkExtent2D m_ViewportExtent{ 0, 0 };
+		std::atomic<uint64_t> m_DrawnVertexCount{ 0 };
 	};
 }
\ No newline at end of file
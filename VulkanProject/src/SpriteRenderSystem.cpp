@@ -0,0 +1,163 @@
+#include "SpriteRenderSystem.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	SpriteRenderSystem::SpriteRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass, const VETextureAtlas& atlas)
+		: m_Device{ device }, m_Atlas{ atlas }
+	{
+		CreateDescriptorSet();
+		CreatePipelineLayout();
+		CreatePipeline(pipelineCompiler, renderPass);
+	}
+
+	SpriteRenderSystem::~SpriteRenderSystem()
+	{
+		// The worker may still be compiling against the layout
+		if (m_Pipeline.IsValid())
+		{
+			m_Pipeline.Wait();
+		}
+
+		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
+	}
+
+	void SpriteRenderSystem::CreateDescriptorSet()
+	{
+		m_DescriptorPool = VEDescriptorPool::Builder(m_Device)
+			.SetMaxSets(1)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1)
+			.Build();
+
+		m_DescriptorSetLayout = VEDescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+			.Build();
+
+		VkDescriptorImageInfo imageInfo = m_Atlas.GetTexture().GetDescriptorInfo();
+
+		if (!VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+			.WriteImage(0, &imageInfo)
+			.Build(m_DescriptorSet))
+		{
+			throw std::runtime_error("Failed to allocate the sprite atlas descriptor set.");
+		}
+	}
+
+	void SpriteRenderSystem::CreatePipelineLayout()
+	{
+		VkDescriptorSetLayout setLayouts[] = { m_DescriptorSetLayout->GetDescriptorSetLayout() };
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = setLayouts;
+		pipelineLayoutInfo.pushConstantRangeCount = 0;
+		pipelineLayoutInfo.pPushConstantRanges = nullptr;
+
+		if (vkCreatePipelineLayout(m_Device.Device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+	}
+
+	void SpriteRenderSystem::CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+	{
+		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+		PipelineConfigInfo pipelineConfig = {};
+
+		VEPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+
+		pipelineConfig.RenderPass = renderPass;
+		pipelineConfig.PipelineLayout = m_PipelineLayout;
+
+		// Sprites overlap and carry alpha, so blend them in submission order instead of depth testing
+		pipelineConfig.ColorBlendAttachment.blendEnable = VK_TRUE;
+		pipelineConfig.ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		pipelineConfig.ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		// Per instance data only, the quad is generated in the vertex shader
+		pipelineConfig.BindingDescriptions = { { 0, sizeof(SpriteInstance), VK_VERTEX_INPUT_RATE_INSTANCE } };
+		pipelineConfig.AttributeDescriptions = {
+			{ 0, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(SpriteInstance, Position) },
+			{ 1, 0, VK_FORMAT_R16G16_SFLOAT, offsetof(SpriteInstance, Size) },
+			{ 2, 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(SpriteInstance, UvMin) },
+			{ 3, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(SpriteInstance, Color) },
+			{ 4, 0, VK_FORMAT_R16_SNORM, offsetof(SpriteInstance, Rotation) },
+			{ 5, 0, VK_FORMAT_R16_UINT, offsetof(SpriteInstance, Layer) } };
+
+		m_Pipeline = pipelineCompiler.Compile(
+			"Sprite_Shader.vert",
+			"Sprite_Shader.frag",
+			pipelineConfig);
+	}
+
+	void SpriteRenderSystem::RenderSprites(VERenderer& renderer, VkCommandBuffer commandBuffer, const std::vector<VESprite>& sprites)
+	{
+		VEPipeline* pipeline = m_Pipeline.Get();
+
+		if (pipeline == nullptr || sprites.empty() || !m_Atlas.GetTexture().IsReady())
+		{
+			return;
+		}
+
+		uint32_t spriteCount = static_cast<uint32_t>(sprites.size());
+		VEBufferSlice slice = renderer.GetFrameRingBuffer().Allocate(spriteCount * sizeof(SpriteInstance));
+		SpriteInstance* instances = static_cast<SpriteInstance*>(slice.MappedData);
+
+		for (uint32_t i = 0; i < spriteCount; i++)
+		{
+			const VESprite& sprite = sprites[i];
+			const VEAtlasRegion& region = m_Atlas.GetRegion(sprite.ImageId);
+
+			// Wrapped to -pi to pi for the snorm encoding
+			float angle = glm::mod(sprite.Rotation + glm::pi<float>(), glm::two_pi<float>()) - glm::pi<float>();
+
+			assert(region.Layer <= UINT16_MAX && "Atlas layer does not fit the packed instance");
+
+			// Half precision is finer than a pixel across clip space
+			instances[i].Position	= glm::packHalf2x16(sprite.Position);
+			instances[i].Size		= glm::packHalf2x16(sprite.Size);
+			instances[i].UvMin		= glm::packUnorm2x16(region.UvMin);
+			instances[i].UvMax		= glm::packUnorm2x16(region.UvMax);
+			instances[i].Color		= glm::packUnorm4x8(sprite.Color);
+			instances[i].Rotation	= static_cast<int16_t>(glm::round(angle / glm::pi<float>() * 32767.0f));
+			instances[i].Layer		= static_cast<uint16_t>(region.Layer);
+		}
+
+		// One instanced draw per chunk, every chunk reads its own range of the same slice
+		renderer.RecordParallel(commandBuffer, spriteCount,
+			[&](VkCommandBuffer secondary, uint32_t first, uint32_t count)
+			{
+				pipeline->Bind(secondary);
+
+				vkCmdBindDescriptorSets(secondary,
+					VK_PIPELINE_BIND_POINT_GRAPHICS,
+					m_PipelineLayout,
+					0,
+					1,
+					&m_DescriptorSet,
+					0,
+					nullptr);
+
+				VkDeviceSize offset = slice.Offset + first * sizeof(SpriteInstance);
+				vkCmdBindVertexBuffers(secondary, 0, 1, &slice.Buffer, &offset);
+
+				vkCmdDraw(secondary, 6, count, 0, 0);
+			},
+			"SpriteRenderSystem");
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include "VE_Descriptors.h"
+#include "VE_Device.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+#include "VE_TextureAtlas.h"
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+	struct VESprite
+	{
+		glm::vec2 Position{ 0.0f };
+		glm::vec2 Size{ 0.1f };
+		float Rotation				= 0.0f;
+		glm::vec4 Color{ 1.0f };
+		uint32_t ImageId			= 0;	// Id returned by VETextureAtlas::AddImage
+	};
+
+	// Draws textured sprites as instanced quads. Every image lives in one atlas array texture and the
+	// instance data is streamed through the frame ring buffer, so a whole sprite list costs one draw per
+	// recording thread and a single descriptor set.
+	class SpriteRenderSystem
+	{
+	public:
+		SpriteRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass, const VETextureAtlas& atlas);
+		~SpriteRenderSystem();
+
+		// Delete the copy constructor and copy operator
+		SpriteRenderSystem(const SpriteRenderSystem&) = delete;
+		SpriteRenderSystem& operator=(const SpriteRenderSystem&) = delete;
+
+		// The render pass has to be begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+		void RenderSprites(VERenderer& renderer, VkCommandBuffer commandBuffer, const std::vector<VESprite>& sprites);
+
+		// Bytes streamed per sprite every frame
+		static size_t GetInstanceSize() { return sizeof(SpriteInstance); }
+
+	private:
+		// Matches the instance attributes in Sprite_Shader.vert, 24 bytes instead of 56 as floats
+		struct SpriteInstance
+		{
+			uint32_t Position;		// R16G16_SFLOAT
+			uint32_t Size;			// R16G16_SFLOAT
+			uint32_t UvMin;			// R16G16B16A16_UNORM together with UvMax
+			uint32_t UvMax;
+			uint32_t Color;			// R8G8B8A8_UNORM, red in the lowest byte
+			int16_t Rotation;		// R16_SNORM, the angle divided by pi
+			uint16_t Layer;			// R16_UINT
+		};
+
+		void CreateDescriptorSet();
+		void CreatePipelineLayout();
+		void CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+
+	private:
+		VEDevice& m_Device;
+		const VETextureAtlas& m_Atlas;
+
+		std::unique_ptr<VEDescriptorPool> m_DescriptorPool;
+		std::unique_ptr<VEDescriptorSetLayout> m_DescriptorSetLayout;
+		VkDescriptorSet m_DescriptorSet;
+
+		VEPipelineHandle m_Pipeline;
+		VkPipelineLayout m_PipelineLayout;
+	};
+}
\ No newline at end of file
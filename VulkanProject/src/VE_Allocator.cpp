@@ -0,0 +1,462 @@
+#include "VE_Allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr VkDeviceSize VEAllocator::DEFAULT_BLOCK_SIZE;
+	constexpr VkDeviceSize VEAllocator::MIN_ALLOCATION_SIZE;
+
+	static VkDeviceSize NextPowerOfTwo(VkDeviceSize value)
+	{
+		VkDeviceSize result = 1;
+		while (result < value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	static VkDeviceSize PreviousPowerOfTwo(VkDeviceSize value)
+	{
+		VkDeviceSize result = 1;
+		while ((result << 1) <= value)
+		{
+			result <<= 1;
+		}
+		return result;
+	}
+
+	VEAllocator::VEAllocator(VkDevice device, VkPhysicalDevice physicalDevice)
+		: m_Device{ device }
+	{
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_MemoryProperties);
+
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+		m_BufferImageGranularity	= NextPowerOfTwo(properties.limits.bufferImageGranularity);
+		m_NonCoherentAtomSize		= properties.limits.nonCoherentAtomSize;
+	}
+
+	VEAllocator::~VEAllocator()
+	{
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			for (auto& block : m_Pools[i].Blocks)
+			{
+				if (block == nullptr) continue;
+
+				assert(block->Allocations.empty() && "Device memory block destroyed while allocations are still alive.");
+				FreeDeviceMemory(block->Memory, block->Mapped != nullptr);
+			}
+		}
+
+		assert(m_DeviceMemoryCount == 0 && "Dedicated allocations were leaked.");
+	}
+
+	VEAllocation VEAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool optimalTiling)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		VEAllocation allocation = {};
+
+		allocation.MemoryTypeIndex			= FindMemoryType(requirements.memoryTypeBits, properties);
+
+		MemoryPool& pool					= m_Pools[allocation.MemoryTypeIndex];
+		VkDeviceSize blockSize				= GetBlockSize(allocation.MemoryTypeIndex);
+
+		// Buddy nodes are always aligned to their own size, so rounding up to a power of two that covers
+		// the alignment (and the granularity page for optimal images) satisfies both rules at once
+		VkDeviceSize size = std::max(requirements.size, std::max(requirements.alignment, MIN_ALLOCATION_SIZE));
+		if (optimalTiling)
+		{
+			size = std::max(size, m_BufferImageGranularity);
+		}
+		size = NextPowerOfTwo(size);
+
+		// Anything larger than half a block would waste most of it, so it gets its own memory object
+		if (size > blockSize / 2)
+		{
+			allocation.Memory				= AllocateDeviceMemory(requirements.size, allocation.MemoryTypeIndex, &allocation.MappedData);
+			allocation.Offset				= 0;
+			allocation.Size					= requirements.size;
+			allocation.Dedicated			= true;
+
+			pool.DedicatedCount++;
+			pool.DedicatedBytes				+= requirements.size;
+			pool.RequestedBytes				+= requirements.size;
+			return allocation;
+		}
+
+		uint32_t order = 0;
+		while ((MIN_ALLOCATION_SIZE << order) < size)
+		{
+			order++;
+		}
+
+		VkDeviceSize offset = 0;
+		uint32_t blockIndex = 0;
+		bool found = false;
+
+		for (; blockIndex < pool.Blocks.size(); blockIndex++)
+		{
+			if (pool.Blocks[blockIndex] != nullptr && AllocateFromBlock(*pool.Blocks[blockIndex], order, offset))
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+		{
+			// Reuse a slot left behind by a released block so existing BlockIndex values stay valid
+			blockIndex = 0;
+			while (blockIndex < pool.Blocks.size() && pool.Blocks[blockIndex] != nullptr)
+			{
+				blockIndex++;
+			}
+
+			if (blockIndex == pool.Blocks.size())
+			{
+				pool.Blocks.emplace_back();
+			}
+
+			pool.Blocks[blockIndex] = CreateBlock(allocation.MemoryTypeIndex);
+
+			if (!AllocateFromBlock(*pool.Blocks[blockIndex], order, offset))
+			{
+				throw std::runtime_error("Failed to sub-allocate from a new device memory block.");
+			}
+		}
+
+		Block& block						= *pool.Blocks[blockIndex];
+
+		allocation.Memory					= block.Memory;
+		allocation.Offset					= offset;
+		allocation.Size						= requirements.size;
+		allocation.BlockIndex				= blockIndex;
+		allocation.MappedData				= block.Mapped == nullptr ? nullptr : static_cast<char*>(block.Mapped) + offset;
+
+		pool.RequestedBytes					+= requirements.size;
+		return allocation;
+	}
+
+	void VEAllocator::Free(VEAllocation& allocation)
+	{
+		if (allocation.Memory == VK_NULL_HANDLE)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		MemoryPool& pool = m_Pools[allocation.MemoryTypeIndex];
+		pool.RequestedBytes -= allocation.Size;
+
+		if (allocation.Dedicated)
+		{
+			FreeDeviceMemory(allocation.Memory, allocation.MappedData != nullptr);
+			pool.DedicatedCount--;
+			pool.DedicatedBytes -= allocation.Size;
+		}
+		else
+		{
+			assert(allocation.BlockIndex < pool.Blocks.size() && pool.Blocks[allocation.BlockIndex] != nullptr && "Allocation does not belong to this allocator.");
+
+			auto& block = pool.Blocks[allocation.BlockIndex];
+			FreeFromBlock(*block, allocation.Offset);
+
+			// Keep one empty block around per memory type so alloc/free churn does not hit the driver
+			if (block->Allocations.empty())
+			{
+				uint32_t emptyBlocks = 0;
+				for (auto& other : pool.Blocks)
+				{
+					if (other != nullptr && other->Allocations.empty())
+					{
+						emptyBlocks++;
+					}
+				}
+
+				if (emptyBlocks > 1)
+				{
+					FreeDeviceMemory(block->Memory, block->Mapped != nullptr);
+					block.reset();
+				}
+			}
+		}
+
+		allocation = {};
+	}
+
+	void VEAllocator::Flush(const VEAllocation& allocation, VkDeviceSize offset, VkDeviceSize size)
+	{
+		if (GetMemoryTypeProperties(allocation.MemoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+		{
+			return;
+		}
+
+		if (size == VK_WHOLE_SIZE)
+		{
+			size = allocation.Size - offset;
+		}
+
+		// Flushed ranges must start and end on nonCoherentAtomSize boundaries of the memory object.
+		// Sub-allocations are at least MIN_ALLOCATION_SIZE aligned, so widening the range only touches our own node
+		VkDeviceSize begin					= allocation.Offset + offset;
+		VkDeviceSize end					= begin + size;
+		begin								= (begin / m_NonCoherentAtomSize) * m_NonCoherentAtomSize;
+		end									= ((end + m_NonCoherentAtomSize - 1) / m_NonCoherentAtomSize) * m_NonCoherentAtomSize;
+
+		VkMappedMemoryRange range = {};
+
+		range.sType							= VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE;
+		range.memory						= allocation.Memory;
+		range.offset						= begin;
+		range.size							= allocation.Dedicated ? VK_WHOLE_SIZE : end - begin;
+
+		if (vkFlushMappedMemoryRanges(m_Device, 1, &range) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to flush mapped memory range.");
+		}
+	}
+
+	uint32_t VEAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+	{
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return i;
+			}
+		}
+
+		throw std::runtime_error("failed to find suitable memory type!");
+	}
+
+	bool VEAllocator::HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+	{
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			if ((typeFilter & (1 << i)) && (m_MemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	VEAllocatorStats VEAllocator::GetStats()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		VEAllocatorStats stats = {};
+
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			MemoryPool& pool				= m_Pools[i];
+			VEMemoryTypeStats& typeStats	= stats.MemoryTypes[i];
+
+			typeStats.DedicatedAllocationCount	= pool.DedicatedCount;
+			typeStats.AllocationCount			= pool.DedicatedCount;
+			typeStats.BlockBytes				= pool.DedicatedBytes;
+			typeStats.UsedBytes					= pool.DedicatedBytes;
+			typeStats.RequestedBytes			= pool.RequestedBytes;
+
+			for (auto& block : pool.Blocks)
+			{
+				if (block == nullptr) continue;
+
+				typeStats.BlockCount++;
+				typeStats.AllocationCount	+= static_cast<uint32_t>(block->Allocations.size());
+				typeStats.BlockBytes		+= block->Size;
+				typeStats.UsedBytes			+= block->UsedBytes;
+
+				for (uint32_t order = static_cast<uint32_t>(block->FreeLists.size()); order-- > 0;)
+				{
+					if (!block->FreeLists[order].empty())
+					{
+						typeStats.LargestFreeRange = std::max(typeStats.LargestFreeRange, MIN_ALLOCATION_SIZE << order);
+						break;
+					}
+				}
+			}
+
+			stats.Total.BlockCount				+= typeStats.BlockCount;
+			stats.Total.AllocationCount			+= typeStats.AllocationCount;
+			stats.Total.DedicatedAllocationCount+= typeStats.DedicatedAllocationCount;
+			stats.Total.BlockBytes				+= typeStats.BlockBytes;
+			stats.Total.UsedBytes				+= typeStats.UsedBytes;
+			stats.Total.RequestedBytes			+= typeStats.RequestedBytes;
+			stats.Total.LargestFreeRange		= std::max(stats.Total.LargestFreeRange, typeStats.LargestFreeRange);
+		}
+
+		stats.DeviceMemoryCount = m_DeviceMemoryCount;
+		return stats;
+	}
+
+	void VEAllocator::PrintStats()
+	{
+		VEAllocatorStats stats = GetStats();
+
+		const double MiB = 1024.0 * 1024.0;
+
+		std::cout << "device memory: " << stats.DeviceMemoryCount << " vkAllocateMemory objects, "
+			<< stats.Total.AllocationCount << " allocations" << std::endl;
+
+		for (uint32_t i = 0; i < m_MemoryProperties.memoryTypeCount; i++)
+		{
+			const VEMemoryTypeStats& typeStats = stats.MemoryTypes[i];
+
+			if (typeStats.BlockCount == 0 && typeStats.DedicatedAllocationCount == 0) continue;
+
+			std::cout << std::fixed << std::setprecision(2)
+				<< "\tmemory type " << i
+				<< ": blocks " << typeStats.BlockCount
+				<< ", dedicated " << typeStats.DedicatedAllocationCount
+				<< ", allocations " << typeStats.AllocationCount
+				<< ", reserved " << typeStats.BlockBytes / MiB << " MiB"
+				<< ", used " << typeStats.UsedBytes / MiB << " MiB"
+				<< ", requested " << typeStats.RequestedBytes / MiB << " MiB"
+				<< ", fragmentation " << typeStats.Fragmentation() * 100.0f << "%" << std::endl;
+		}
+	}
+
+	std::unique_ptr<VEAllocator::Block> VEAllocator::CreateBlock(uint32_t memoryTypeIndex)
+	{
+		auto block							= std::make_unique<Block>();
+
+		block->Size							= GetBlockSize(memoryTypeIndex);
+		block->Memory						= AllocateDeviceMemory(block->Size, memoryTypeIndex, &block->Mapped);
+		block->FreeLists.resize(MaxOrder(block->Size) + 1);
+		block->FreeLists.back().insert(0);
+
+		return block;
+	}
+
+	bool VEAllocator::AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset)
+	{
+		uint32_t maxOrder = static_cast<uint32_t>(block.FreeLists.size()) - 1;
+
+		uint32_t current = order;
+		while (current <= maxOrder && block.FreeLists[current].empty())
+		{
+			current++;
+		}
+
+		if (current > maxOrder)
+		{
+			return false;
+		}
+
+		// Take the lowest free node so allocations pack towards the start of the block
+		offset = *block.FreeLists[current].begin();
+		block.FreeLists[current].erase(block.FreeLists[current].begin());
+
+		// Split it down, returning the upper halves to the free lists
+		while (current > order)
+		{
+			current--;
+			block.FreeLists[current].insert(offset + (MIN_ALLOCATION_SIZE << current));
+		}
+
+		block.Allocations[offset]			= order;
+		block.UsedBytes						+= MIN_ALLOCATION_SIZE << order;
+		return true;
+	}
+
+	void VEAllocator::FreeFromBlock(Block& block, VkDeviceSize offset)
+	{
+		auto it = block.Allocations.find(offset);
+		assert(it != block.Allocations.end() && "Freeing an offset that was never allocated.");
+
+		uint32_t order						= it->second;
+		uint32_t maxOrder					= static_cast<uint32_t>(block.FreeLists.size()) - 1;
+
+		block.Allocations.erase(it);
+		block.UsedBytes						-= MIN_ALLOCATION_SIZE << order;
+
+		// Merge with the buddy for as long as it is free as well
+		while (order < maxOrder)
+		{
+			VkDeviceSize buddy = offset ^ (MIN_ALLOCATION_SIZE << order);
+			auto buddyIt = block.FreeLists[order].find(buddy);
+
+			if (buddyIt == block.FreeLists[order].end())
+			{
+				break;
+			}
+
+			block.FreeLists[order].erase(buddyIt);
+			offset = std::min(offset, buddy);
+			order++;
+		}
+
+		block.FreeLists[order].insert(offset);
+	}
+
+	VkDeviceMemory VEAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped)
+	{
+		VkMemoryAllocateInfo allocInfo = {};
+
+		allocInfo.sType						= VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize			= size;
+		allocInfo.memoryTypeIndex			= memoryTypeIndex;
+
+		VkDeviceMemory memory;
+		if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate device memory.");
+		}
+
+		m_DeviceMemoryCount++;
+
+		// Host visible memory is mapped once for its whole lifetime, a memory object can only be mapped once at a time
+		*mapped = nullptr;
+		if (GetMemoryTypeProperties(memoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+		{
+			if (vkMapMemory(m_Device, memory, 0, VK_WHOLE_SIZE, 0, mapped) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to map device memory.");
+			}
+		}
+
+		return memory;
+	}
+
+	void VEAllocator::FreeDeviceMemory(VkDeviceMemory memory, bool mapped)
+	{
+		if (mapped)
+		{
+			vkUnmapMemory(m_Device, memory);
+		}
+
+		vkFreeMemory(m_Device, memory, nullptr);
+		m_DeviceMemoryCount--;
+	}
+
+	VkDeviceSize VEAllocator::GetBlockSize(uint32_t memoryTypeIndex) const
+	{
+		// Small heaps (e.g. the 256 MiB host visible device local heap) get proportionally smaller blocks
+		uint32_t heapIndex					= m_MemoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+		VkDeviceSize heapSize				= m_MemoryProperties.memoryHeaps[heapIndex].size;
+
+		return std::max(MIN_ALLOCATION_SIZE, std::min(DEFAULT_BLOCK_SIZE, PreviousPowerOfTwo(heapSize / 8)));
+	}
+
+	uint32_t VEAllocator::MaxOrder(VkDeviceSize blockSize) const
+	{
+		uint32_t order = 0;
+		while ((MIN_ALLOCATION_SIZE << order) < blockSize)
+		{
+			order++;
+		}
+		return order;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// A sub-range of a VkDeviceMemory block handed out by VEAllocator
+	struct VEAllocation
+	{
+		VkDeviceMemory Memory				= VK_NULL_HANDLE;
+		VkDeviceSize Offset					= 0;
+		VkDeviceSize Size					= 0;
+		// Points at Offset inside the persistently mapped block, null for non host visible memory
+		void* MappedData					= nullptr;
+		uint32_t MemoryTypeIndex			= 0;
+		uint32_t BlockIndex					= 0;
+		bool Dedicated						= false;
+	};
+
+	struct VEMemoryTypeStats
+	{
+		uint32_t BlockCount					= 0;
+		uint32_t AllocationCount			= 0;
+		uint32_t DedicatedAllocationCount	= 0;
+		VkDeviceSize BlockBytes				= 0;	// Memory reserved from the driver
+		VkDeviceSize UsedBytes				= 0;	// Memory handed out, including buddy rounding
+		VkDeviceSize RequestedBytes			= 0;	// Memory the resources actually asked for
+		VkDeviceSize LargestFreeRange		= 0;
+
+		// 0 when all free memory is one contiguous range, approaching 1 as it gets scattered
+		float Fragmentation() const
+		{
+			VkDeviceSize freeBytes = BlockBytes - UsedBytes;
+			return freeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(LargestFreeRange) / static_cast<float>(freeBytes);
+		}
+	};
+
+	struct VEAllocatorStats
+	{
+		VEMemoryTypeStats MemoryTypes[VK_MAX_MEMORY_TYPES];
+		VEMemoryTypeStats Total;
+		uint32_t DeviceMemoryCount			= 0;	// Live vkAllocateMemory objects
+	};
+
+	// Allocates large VkDeviceMemory blocks per memory type and sub-allocates them with a buddy allocator.
+	// Optimal tiling images are padded out to bufferImageGranularity so they never share a page with
+	// buffers or linear images in the same block.
+	class VEAllocator
+	{
+	public:
+		static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE	= 64ull * 1024 * 1024;
+		static constexpr VkDeviceSize MIN_ALLOCATION_SIZE	= 256;
+
+		VEAllocator(VkDevice device, VkPhysicalDevice physicalDevice);
+		~VEAllocator();
+
+		// Delete the copy constructor and copy operator
+		VEAllocator(const VEAllocator&) = delete;
+		VEAllocator& operator=(const VEAllocator&) = delete;
+
+		VEAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool optimalTiling);
+		void Free(VEAllocation& allocation);
+
+		// Makes host writes visible to the device, a no-op for coherent memory
+		void Flush(const VEAllocation& allocation, VkDeviceSize offset = 0, VkDeviceSize size = VK_WHOLE_SIZE);
+
+		uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+		bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+		VkMemoryPropertyFlags GetMemoryTypeProperties(uint32_t memoryTypeIndex) const { return m_MemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags; }
+		VkDeviceSize GetNonCoherentAtomSize() const { return m_NonCoherentAtomSize; }
+
+		VEAllocatorStats GetStats();
+		void PrintStats();
+
+	private:
+		struct Block
+		{
+			VkDeviceMemory Memory			= VK_NULL_HANDLE;
+			VkDeviceSize Size				= 0;
+			VkDeviceSize UsedBytes			= 0;
+			void* Mapped					= nullptr;
+			// FreeLists[order] holds the offsets of free nodes of size MIN_ALLOCATION_SIZE << order
+			std::vector<std::set<VkDeviceSize>> FreeLists;
+			// offset -> order of every live allocation, needed to find its buddy again on free
+			std::unordered_map<VkDeviceSize, uint32_t> Allocations;
+		};
+
+		struct MemoryPool
+		{
+			std::vector<std::unique_ptr<Block>> Blocks;
+			VkDeviceSize RequestedBytes		= 0;
+			uint32_t DedicatedCount			= 0;
+			VkDeviceSize DedicatedBytes		= 0;
+		};
+
+		std::unique_ptr<Block> CreateBlock(uint32_t memoryTypeIndex);
+		bool AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset);
+		void FreeFromBlock(Block& block, VkDeviceSize offset);
+		VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memoryTypeIndex, void** mapped);
+		void FreeDeviceMemory(VkDeviceMemory memory, bool mapped);
+		VkDeviceSize GetBlockSize(uint32_t memoryTypeIndex) const;
+		uint32_t MaxOrder(VkDeviceSize blockSize) const;
+
+	private:
+		VkDevice m_Device;
+		VkPhysicalDeviceMemoryProperties m_MemoryProperties;
+		VkDeviceSize m_BufferImageGranularity;
+		VkDeviceSize m_NonCoherentAtomSize;
+		uint32_t m_DeviceMemoryCount		= 0;
+
+		MemoryPool m_Pools[VK_MAX_MEMORY_TYPES];
+		std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
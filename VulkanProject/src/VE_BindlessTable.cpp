@@ -0,0 +1,171 @@
+#include "VE_BindlessTable.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VEBindlessTable::MAX_TEXTURES;
+	constexpr uint32_t VEBindlessTable::MAX_BUFFERS;
+	constexpr uint32_t VEBindlessTable::INVALID_INDEX;
+	constexpr uint32_t VEBindlessTable::TEXTURE_BINDING;
+	constexpr uint32_t VEBindlessTable::BUFFER_BINDING;
+
+	VEBindlessTable::VEBindlessTable(VEDevice& device)
+		: m_Device{ device }
+	{
+		if (!m_Device.SupportsDescriptorIndexing())
+		{
+			throw std::runtime_error("The bindless table needs descriptor indexing, which the device does not support.");
+		}
+
+		// Every binding is visible to every stage, so the per stage limits apply in full
+		const VkPhysicalDeviceDescriptorIndexingProperties& limits = m_Device.GetDescriptorIndexingProperties();
+
+		m_TextureSlots.Capacity = std::min({ MAX_TEXTURES,
+			limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+			limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+			limits.maxDescriptorSetUpdateAfterBindSampledImages,
+			limits.maxDescriptorSetUpdateAfterBindSamplers });
+		m_BufferSlots.Capacity = std::min({ MAX_BUFFERS,
+			limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers,
+			limits.maxDescriptorSetUpdateAfterBindStorageBuffers });
+
+		m_Textures.resize(m_TextureSlots.Capacity, nullptr);
+
+		m_DescriptorPool = VEDescriptorPool::Builder(m_Device)
+			.SetMaxSets(1)
+			.SetPoolFlags(VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_TextureSlots.Capacity)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_BufferSlots.Capacity)
+			.Build();
+
+		VkDescriptorBindingFlags bindingFlags =
+			VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+			VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+
+		m_DescriptorSetLayout = VEDescriptorSetLayout::Builder(m_Device)
+			.SetLayoutFlags(VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT)
+			.AddBinding(TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_ALL, m_TextureSlots.Capacity, bindingFlags)
+			.AddBinding(BUFFER_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_ALL, m_BufferSlots.Capacity, bindingFlags)
+			.Build();
+
+		// Starts out empty, slots are written as resources are added
+		if (!VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool).Build(m_DescriptorSet))
+		{
+			throw std::runtime_error("Failed to allocate the bindless descriptor set.");
+		}
+
+		std::cout << "bindless table: " << m_TextureSlots.Capacity << " textures, " << m_BufferSlots.Capacity << " buffers" << std::endl;
+	}
+
+	VEBindlessTable::~VEBindlessTable()
+	{
+
+	}
+
+	uint32_t VEBindlessTable::AllocateSlot(SlotAllocator& slots, const char* kind)
+	{
+		while (!slots.RetiringSlots.empty() && m_Device.GetFrameTimeline().IsComplete(slots.RetiringSlots.front().first))
+		{
+			slots.FreeSlots.push_back(slots.RetiringSlots.front().second);
+			slots.RetiringSlots.pop_front();
+		}
+
+		if (!slots.FreeSlots.empty())
+		{
+			uint32_t index = slots.FreeSlots.back();
+			slots.FreeSlots.pop_back();
+
+			return index;
+		}
+
+		if (slots.NextUnused == slots.Capacity)
+		{
+			throw std::runtime_error(std::string("The bindless table is out of ") + kind + " slots.");
+		}
+
+		return slots.NextUnused++;
+	}
+
+	void VEBindlessTable::RetireSlot(SlotAllocator& slots, uint32_t index)
+	{
+		assert(index < slots.NextUnused && "Slot was never handed out");
+
+		// Removals come in submission order, so the queue stays sorted
+		slots.RetiringSlots.emplace_back(m_Device.GetFrameTimeline().GetSubmittedValue(), index);
+	}
+
+	uint32_t VEBindlessTable::AddTexture(const VETexture& texture)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		uint32_t index = AllocateSlot(m_TextureSlots, "texture");
+		VkDescriptorImageInfo imageInfo = texture.GetDescriptorInfo();
+
+		VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+			.WriteImage(TEXTURE_BINDING, &imageInfo, index)
+			.Overwrite(m_DescriptorSet);
+
+		m_Textures[index] = &texture;
+
+		return index;
+	}
+
+	uint32_t VEBindlessTable::AddBuffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		uint32_t index = AllocateSlot(m_BufferSlots, "buffer");
+		VkDescriptorBufferInfo bufferInfo = { buffer, offset, range };
+
+		VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+			.WriteBuffer(BUFFER_BINDING, &bufferInfo, index)
+			.Overwrite(m_DescriptorSet);
+
+		return index;
+	}
+
+	void VEBindlessTable::RemoveTexture(uint32_t index)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		m_Textures[index] = nullptr;
+		RetireSlot(m_TextureSlots, index);
+	}
+
+	void VEBindlessTable::RemoveBuffer(uint32_t index)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		RetireSlot(m_BufferSlots, index);
+	}
+
+	bool VEBindlessTable::IsTextureReady(uint32_t index) const
+	{
+		if (index >= m_TextureSlots.Capacity)
+		{
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		return m_Textures[index] != nullptr && m_Textures[index]->IsReady();
+	}
+
+	void VEBindlessTable::Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t set) const
+	{
+		vkCmdBindDescriptorSets(commandBuffer,
+			bindPoint,
+			pipelineLayout,
+			set,
+			1,
+			&m_DescriptorSet,
+			0,
+			nullptr);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+#include "VE_Descriptors.h"
+#include "VE_Device.h"
+#include "VE_Texture.h"
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// One descriptor set holding every texture and storage buffer, which shaders index with slots passed in
+	// per draw or per instance data. Bound once per command buffer, so drawing with any number of different
+	// textures costs no descriptor binds and every pipeline shares the same layout for set 0.
+	//
+	// The set is update after bind and partially bound: slots can be filled while frames that bind it are in
+	// flight, and empty slots only have to stay unused. Requires VEDevice::SupportsDescriptorIndexing.
+	class VEBindlessTable
+	{
+	public:
+		// Upper bounds, the real capacity is clamped to the device limits
+		static constexpr uint32_t MAX_TEXTURES = 4096;
+		static constexpr uint32_t MAX_BUFFERS = 1024;
+		static constexpr uint32_t INVALID_INDEX = ~0u;
+
+		// Matches the bindings in the shaders, textures are sampler2DArray like every VETexture
+		static constexpr uint32_t TEXTURE_BINDING = 0;
+		static constexpr uint32_t BUFFER_BINDING = 1;
+
+		explicit VEBindlessTable(VEDevice& device);
+		~VEBindlessTable();
+
+		// Delete the copy constructor and copy operator
+		VEBindlessTable(const VEBindlessTable&) = delete;
+		VEBindlessTable& operator=(const VEBindlessTable&) = delete;
+
+		// Returns the slot to index the table with, texture has to outlive it
+		uint32_t AddTexture(const VETexture& texture);
+		uint32_t AddBuffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+
+		// The slot is handed out again once every frame submitted so far has finished with it
+		void RemoveTexture(uint32_t index);
+		void RemoveBuffer(uint32_t index);
+
+		// False for empty slots and textures still uploading, neither may be sampled
+		bool IsTextureReady(uint32_t index) const;
+
+		void Bind(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t set = 0) const;
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_DescriptorSetLayout->GetDescriptorSetLayout(); }
+		uint32_t GetTextureCapacity() const { return m_TextureSlots.Capacity; }
+		uint32_t GetBufferCapacity() const { return m_BufferSlots.Capacity; }
+
+	private:
+		struct SlotAllocator
+		{
+			uint32_t Capacity					= 0;
+			uint32_t NextUnused					= 0;
+			std::vector<uint32_t> FreeSlots;
+			// Removed slots with the frame timeline value that has to complete before reuse
+			std::deque<std::pair<uint64_t, uint32_t>> RetiringSlots;
+		};
+
+		uint32_t AllocateSlot(SlotAllocator& slots, const char* kind);
+		void RetireSlot(SlotAllocator& slots, uint32_t index);
+
+	private:
+		VEDevice& m_Device;
+
+		std::unique_ptr<VEDescriptorPool> m_DescriptorPool;
+		std::unique_ptr<VEDescriptorSetLayout> m_DescriptorSetLayout;
+		VkDescriptorSet m_DescriptorSet;
+
+		SlotAllocator m_TextureSlots;
+		SlotAllocator m_BufferSlots;
+		std::vector<const VETexture*> m_Textures;	// Per texture slot, null when empty
+		mutable std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
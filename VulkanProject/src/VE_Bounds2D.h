@@ -0,0 +1,31 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+namespace VulkanEngine {
+
+	// Axis aligned 2D box
+	struct VEBounds2D
+	{
+		glm::vec2 Min{ 0.0f };
+		glm::vec2 Max{ 0.0f };
+
+		glm::vec2 Center() const { return (Min + Max) * 0.5f; }
+		glm::vec2 HalfExtent() const { return (Max - Min) * 0.5f; }
+
+		bool Overlaps(const VEBounds2D& other) const
+		{
+			return Min.x <= other.Max.x && Max.x >= other.Min.x &&
+				   Min.y <= other.Max.y && Max.y >= other.Min.y;
+		}
+
+		// 0 when the point is inside the box
+		float DistanceSquared(glm::vec2 point) const
+		{
+			glm::vec2 delta = glm::max(glm::max(Min - point, point - Max), glm::vec2(0.0f));
+			return glm::dot(delta, delta);
+		}
+	};
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "VE_DeletionQueue.h"
+
+#include <algorithm>
+
+namespace VulkanEngine {
+
+	VEDeletionQueue::VEDeletionQueue(VEFrameTimeline& timeline)
+		: m_Timeline{ timeline }
+	{
+
+	}
+
+	VEDeletionQueue::~VEDeletionQueue()
+	{
+		Flush();
+	}
+
+	void VEDeletionQueue::Push(std::function<void()> destroy)
+	{
+		Push(m_Timeline.GetSubmittedValue(), std::move(destroy));
+	}
+
+	void VEDeletionQueue::Push(uint64_t retireValue, std::function<void()> destroy)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		// Keep the queue sorted so Collect can stop at the first entry still in use
+		auto position = std::upper_bound(m_Entries.begin(), m_Entries.end(), retireValue,
+			[](uint64_t value, const Entry& entry) { return value < entry.RetireValue; });
+
+		m_Entries.insert(position, { retireValue, std::move(destroy) });
+	}
+
+	void VEDeletionQueue::Collect()
+	{
+		uint64_t completedValue = m_Timeline.GetCompletedValue();
+		std::vector<Entry> retired;
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+
+			while (!m_Entries.empty() && m_Entries.front().RetireValue <= completedValue)
+			{
+				retired.push_back(std::move(m_Entries.front()));
+				m_Entries.pop_front();
+			}
+		}
+
+		// Outside the lock, a destroy function may push follow up work
+		Run(retired);
+	}
+
+	void VEDeletionQueue::Flush()
+	{
+		std::vector<Entry> retired;
+
+		{
+			std::lock_guard<std::mutex> lock{ m_Mutex };
+
+			retired.assign(std::make_move_iterator(m_Entries.begin()), std::make_move_iterator(m_Entries.end()));
+			m_Entries.clear();
+		}
+
+		Run(retired);
+	}
+
+	size_t VEDeletionQueue::GetPendingCount()
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+		return m_Entries.size();
+	}
+
+	void VEDeletionQueue::Run(std::vector<Entry>& entries)
+	{
+		for (auto& entry : entries)
+		{
+			entry.Destroy();
+		}
+
+		entries.clear();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+#include "VE_FrameTimeline.h"
+
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Holds on to resources that submitted work may still reference and destroys them once the frame
+	// timeline shows that work retired, so nothing has to wait for the device to go idle
+	class VEDeletionQueue
+	{
+	public:
+		explicit VEDeletionQueue(VEFrameTimeline& timeline);
+		~VEDeletionQueue();
+
+		// Delete the copy constructor and copy operator
+		VEDeletionQueue(const VEDeletionQueue&) = delete;
+		VEDeletionQueue& operator=(const VEDeletionQueue&) = delete;
+
+		// destroy runs once everything submitted up to now has finished on the GPU
+		void Push(std::function<void()> destroy);
+		void Push(uint64_t retireValue, std::function<void()> destroy);
+
+		// Runs every entry whose frame has retired, call once per frame
+		void Collect();
+		// Runs every entry regardless of the timeline, only once the device is idle
+		void Flush();
+
+		size_t GetPendingCount();
+
+	private:
+		struct Entry
+		{
+			uint64_t RetireValue;
+			std::function<void()> Destroy;
+		};
+
+		void Run(std::vector<Entry>& entries);
+
+	private:
+		VEFrameTimeline& m_Timeline;
+
+		std::deque<Entry> m_Entries;	// Ascending retire values
+		std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "VE_Descriptors.h"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	// *************** Descriptor Set Layout Builder *********************
+
+	VEDescriptorSetLayout::Builder& VEDescriptorSetLayout::Builder::AddBinding(uint32_t binding,
+		VkDescriptorType descriptorType,
+		VkShaderStageFlags stageFlags,
+		uint32_t count,
+		VkDescriptorBindingFlags bindingFlags)
+	{
+		assert(m_Bindings.count(binding) == 0 && "Binding already in use");
+
+		VkDescriptorSetLayoutBinding layoutBinding = {};
+
+		layoutBinding.binding					= binding;
+		layoutBinding.descriptorType			= descriptorType;
+		layoutBinding.descriptorCount			= count;
+		layoutBinding.stageFlags				= stageFlags;
+
+		m_Bindings[binding] = layoutBinding;
+		m_BindingFlags[binding] = bindingFlags;
+		return *this;
+	}
+
+	VEDescriptorSetLayout::Builder& VEDescriptorSetLayout::Builder::SetLayoutFlags(VkDescriptorSetLayoutCreateFlags flags)
+	{
+		m_LayoutFlags = flags;
+		return *this;
+	}
+
+	std::unique_ptr<VEDescriptorSetLayout> VEDescriptorSetLayout::Builder::Build() const
+	{
+		return std::make_unique<VEDescriptorSetLayout>(m_Device, m_Bindings, m_BindingFlags, m_LayoutFlags);
+	}
+
+	// *************** Descriptor Set Layout *********************
+
+	VEDescriptorSetLayout::VEDescriptorSetLayout(VEDevice& device,
+		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+		const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags,
+		VkDescriptorSetLayoutCreateFlags layoutFlags)
+		: m_Device{ device }, m_Bindings{ bindings }
+	{
+		std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings = {};
+		std::vector<VkDescriptorBindingFlags> setLayoutBindingFlags = {};
+		bool hasBindingFlags = false;
+
+		for (auto& binding : m_Bindings)
+		{
+			auto flags = bindingFlags.find(binding.first);
+
+			setLayoutBindings.push_back(binding.second);
+			setLayoutBindingFlags.push_back(flags != bindingFlags.end() ? flags->second : 0);
+			hasBindingFlags = hasBindingFlags || setLayoutBindingFlags.back() != 0;
+		}
+
+		// Parallel to pBindings, only chained when some binding has flags so plain layouts work without 1.2
+		VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+
+		bindingFlagsInfo.sType					= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		bindingFlagsInfo.bindingCount			= static_cast<uint32_t>(setLayoutBindingFlags.size());
+		bindingFlagsInfo.pBindingFlags			= setLayoutBindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo = {};
+
+		descriptorSetLayoutInfo.sType			= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		descriptorSetLayoutInfo.pNext			= hasBindingFlags ? &bindingFlagsInfo : nullptr;
+		descriptorSetLayoutInfo.flags			= layoutFlags;
+		descriptorSetLayoutInfo.bindingCount	= static_cast<uint32_t>(setLayoutBindings.size());
+		descriptorSetLayoutInfo.pBindings		= setLayoutBindings.data();
+
+		if (vkCreateDescriptorSetLayout(m_Device.Device(), &descriptorSetLayoutInfo, nullptr, &m_DescriptorSetLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create descriptor set layout.");
+		}
+	}
+
+	VEDescriptorSetLayout::~VEDescriptorSetLayout()
+	{
+		vkDestroyDescriptorSetLayout(m_Device.Device(), m_DescriptorSetLayout, nullptr);
+	}
+
+	// *************** Descriptor Pool Builder *********************
+
+	VEDescriptorPool::Builder& VEDescriptorPool::Builder::AddPoolSize(VkDescriptorType descriptorType, uint32_t count)
+	{
+		m_PoolSizes.push_back({ descriptorType, count });
+		return *this;
+	}
+
+	VEDescriptorPool::Builder& VEDescriptorPool::Builder::SetPoolFlags(VkDescriptorPoolCreateFlags flags)
+	{
+		m_PoolFlags = flags;
+		return *this;
+	}
+
+	VEDescriptorPool::Builder& VEDescriptorPool::Builder::SetMaxSets(uint32_t count)
+	{
+		m_MaxSets = count;
+		return *this;
+	}
+
+	std::unique_ptr<VEDescriptorPool> VEDescriptorPool::Builder::Build() const
+	{
+		return std::make_unique<VEDescriptorPool>(m_Device, m_MaxSets, m_PoolFlags, m_PoolSizes);
+	}
+
+	// *************** Descriptor Pool *********************
+
+	VEDescriptorPool::VEDescriptorPool(VEDevice& device,
+		uint32_t maxSets,
+		VkDescriptorPoolCreateFlags poolFlags,
+		const std::vector<VkDescriptorPoolSize>& poolSizes)
+		: m_Device{ device }
+	{
+		VkDescriptorPoolCreateInfo descriptorPoolInfo = {};
+
+		descriptorPoolInfo.sType				= VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		descriptorPoolInfo.poolSizeCount		= static_cast<uint32_t>(poolSizes.size());
+		descriptorPoolInfo.pPoolSizes			= poolSizes.data();
+		descriptorPoolInfo.maxSets				= maxSets;
+		descriptorPoolInfo.flags				= poolFlags;
+
+		if (vkCreateDescriptorPool(m_Device.Device(), &descriptorPoolInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create descriptor pool.");
+		}
+	}
+
+	VEDescriptorPool::~VEDescriptorPool()
+	{
+		vkDestroyDescriptorPool(m_Device.Device(), m_DescriptorPool, nullptr);
+	}
+
+	bool VEDescriptorPool::AllocateDescriptorSet(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const
+	{
+		VkDescriptorSetAllocateInfo allocInfo = {};
+
+		allocInfo.sType							= VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool				= m_DescriptorPool;
+		allocInfo.pSetLayouts					= &descriptorSetLayout;
+		allocInfo.descriptorSetCount			= 1;
+
+		// Running out of pool memory is reported to the caller rather than thrown
+		return vkAllocateDescriptorSets(m_Device.Device(), &allocInfo, &descriptor) == VK_SUCCESS;
+	}
+
+	void VEDescriptorPool::FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const
+	{
+		vkFreeDescriptorSets(m_Device.Device(),
+			m_DescriptorPool,
+			static_cast<uint32_t>(descriptors.size()),
+			descriptors.data());
+	}
+
+	void VEDescriptorPool::ResetPool()
+	{
+		vkResetDescriptorPool(m_Device.Device(), m_DescriptorPool, 0);
+	}
+
+	// *************** Descriptor Writer *********************
+
+	VEDescriptorWriter::VEDescriptorWriter(VEDescriptorSetLayout& setLayout, VEDescriptorPool& pool)
+		: m_SetLayout{ setLayout }, m_Pool{ pool }
+	{
+	}
+
+	VEDescriptorWriter& VEDescriptorWriter::WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement)
+	{
+		assert(m_SetLayout.m_Bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+		auto& bindingDescription = m_SetLayout.m_Bindings[binding];
+
+		assert(arrayElement < bindingDescription.descriptorCount && "Array element is outside the binding");
+
+		VkWriteDescriptorSet write = {};
+
+		write.sType								= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorType					= bindingDescription.descriptorType;
+		write.dstBinding						= binding;
+		write.dstArrayElement					= arrayElement;
+		write.pBufferInfo						= bufferInfo;
+		write.descriptorCount					= 1;
+
+		m_Writes.push_back(write);
+		return *this;
+	}
+
+	VEDescriptorWriter& VEDescriptorWriter::WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement)
+	{
+		assert(m_SetLayout.m_Bindings.count(binding) == 1 && "Layout does not contain specified binding");
+
+		auto& bindingDescription = m_SetLayout.m_Bindings[binding];
+
+		assert(arrayElement < bindingDescription.descriptorCount && "Array element is outside the binding");
+
+		VkWriteDescriptorSet write = {};
+
+		write.sType								= VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.descriptorType					= bindingDescription.descriptorType;
+		write.dstBinding						= binding;
+		write.dstArrayElement					= arrayElement;
+		write.pImageInfo						= imageInfo;
+		write.descriptorCount					= 1;
+
+		m_Writes.push_back(write);
+		return *this;
+	}
+
+	bool VEDescriptorWriter::Build(VkDescriptorSet& set)
+	{
+		if (!m_Pool.AllocateDescriptorSet(m_SetLayout.GetDescriptorSetLayout(), set))
+		{
+			return false;
+		}
+
+		Overwrite(set);
+		return true;
+	}
+
+	void VEDescriptorWriter::Overwrite(VkDescriptorSet& set)
+	{
+		for (auto& write : m_Writes)
+		{
+			write.dstSet = set;
+		}
+
+		vkUpdateDescriptorSets(m_Pool.m_Device.Device(), static_cast<uint32_t>(m_Writes.size()), m_Writes.data(), 0, nullptr);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+#include "VE_Device.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+
+	class VEDescriptorSetLayout
+	{
+	public:
+		class Builder
+		{
+		public:
+			Builder(VEDevice& device) : m_Device{ device } {}
+
+			// bindingFlags such as VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT need descriptor indexing
+			Builder& AddBinding(uint32_t binding,
+				VkDescriptorType descriptorType,
+				VkShaderStageFlags stageFlags,
+				uint32_t count = 1,
+				VkDescriptorBindingFlags bindingFlags = 0);
+			Builder& SetLayoutFlags(VkDescriptorSetLayoutCreateFlags flags);
+
+			std::unique_ptr<VEDescriptorSetLayout> Build() const;
+
+		private:
+			VEDevice& m_Device;
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_Bindings;
+			std::unordered_map<uint32_t, VkDescriptorBindingFlags> m_BindingFlags;
+			VkDescriptorSetLayoutCreateFlags m_LayoutFlags	= 0;
+		};
+
+		VEDescriptorSetLayout(VEDevice& device,
+			std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+			const std::unordered_map<uint32_t, VkDescriptorBindingFlags>& bindingFlags = {},
+			VkDescriptorSetLayoutCreateFlags layoutFlags = 0);
+		~VEDescriptorSetLayout();
+
+		// Delete the copy constructor and copy operator
+		VEDescriptorSetLayout(const VEDescriptorSetLayout&) = delete;
+		VEDescriptorSetLayout& operator=(const VEDescriptorSetLayout&) = delete;
+
+		VkDescriptorSetLayout GetDescriptorSetLayout() const { return m_DescriptorSetLayout; }
+
+	private:
+		VEDevice& m_Device;
+		VkDescriptorSetLayout m_DescriptorSetLayout;
+		std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> m_Bindings;
+
+		friend class VEDescriptorWriter;
+	};
+
+	class VEDescriptorPool
+	{
+	public:
+		class Builder
+		{
+		public:
+			Builder(VEDevice& device) : m_Device{ device } {}
+
+			Builder& AddPoolSize(VkDescriptorType descriptorType, uint32_t count);
+			Builder& SetPoolFlags(VkDescriptorPoolCreateFlags flags);
+			Builder& SetMaxSets(uint32_t count);
+
+			std::unique_ptr<VEDescriptorPool> Build() const;
+
+		private:
+			VEDevice& m_Device;
+			std::vector<VkDescriptorPoolSize> m_PoolSizes;
+			uint32_t m_MaxSets						= 1000;
+			VkDescriptorPoolCreateFlags m_PoolFlags	= 0;
+		};
+
+		VEDescriptorPool(VEDevice& device,
+			uint32_t maxSets,
+			VkDescriptorPoolCreateFlags poolFlags,
+			const std::vector<VkDescriptorPoolSize>& poolSizes);
+		~VEDescriptorPool();
+
+		// Delete the copy constructor and copy operator
+		VEDescriptorPool(const VEDescriptorPool&) = delete;
+		VEDescriptorPool& operator=(const VEDescriptorPool&) = delete;
+
+		bool AllocateDescriptorSet(const VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet& descriptor) const;
+		void FreeDescriptors(std::vector<VkDescriptorSet>& descriptors) const;
+		void ResetPool();
+
+	private:
+		VEDevice& m_Device;
+		VkDescriptorPool m_DescriptorPool;
+
+		friend class VEDescriptorWriter;
+	};
+
+	// Collects writes for one descriptor set and applies them together
+	class VEDescriptorWriter
+	{
+	public:
+		VEDescriptorWriter(VEDescriptorSetLayout& setLayout, VEDescriptorPool& pool);
+
+		// arrayElement picks the descriptor to write in a binding with a count above one
+		VEDescriptorWriter& WriteBuffer(uint32_t binding, VkDescriptorBufferInfo* bufferInfo, uint32_t arrayElement = 0);
+		VEDescriptorWriter& WriteImage(uint32_t binding, VkDescriptorImageInfo* imageInfo, uint32_t arrayElement = 0);
+
+		bool Build(VkDescriptorSet& set);
+		void Overwrite(VkDescriptorSet& set);
+
+	private:
+		VEDescriptorSetLayout& m_SetLayout;
+		VEDescriptorPool& m_Pool;
+		std::vector<VkWriteDescriptorSet> m_Writes;
+	};
+}
\ No newline at end of file
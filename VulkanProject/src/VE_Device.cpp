@@ -1,7 +1,16 @@
 #include "VE_Device.h"
+#include "VE_Uploader.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
 
 // std headers
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <set>
 #include <unordered_set>
@@ -47,7 +56,7 @@ namespace VulkanEngine {
     }
 
     // class member functions
-    VEDevice::VEDevice(VEWindow& window)
+    VEDevice::VEDevice(VEWindow* window)
         : m_Window{ window }
     {
         CreateInstance();
@@ -56,10 +65,29 @@ namespace VulkanEngine {
         PickPhysicalDevice();
         CreateLogicalDevice();
         CreateCommandPool();
+        CreatePipelineCache();
+
+        m_Allocator = std::make_unique<VEAllocator>(m_Device, m_PhysicalDevice);
+        m_Uploader = std::make_unique<VEUploader>(*this);
+        m_FrameTimeline = std::make_unique<VEFrameTimeline>(m_Device, m_TimelineSemaphoreSupported);
+        m_DeletionQueue = std::make_unique<VEDeletionQueue>(*m_FrameTimeline);
+        m_ShaderLibrary = std::make_unique<VEShaderLibrary>();
     }
 
     VEDevice::~VEDevice()
     {
+        // Whatever is still queued for deletion may reference any of the objects below
+        vkDeviceWaitIdle(m_Device);
+        m_DeletionQueue.reset();
+
+        // The uploader still owns staging buffers from the allocator
+        m_Uploader.reset();
+        m_FrameTimeline.reset();
+        m_Allocator.reset();
+
+        SavePipelineCache();
+        vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+
         vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
         vkDestroyDevice(m_Device, nullptr);
 
@@ -68,7 +96,11 @@ namespace VulkanEngine {
             DestroyDebugUtilsMessengerEXT(m_Instance, m_DebugMessenger, nullptr);
         }
 
-        vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+        if (m_Surface != VK_NULL_HANDLE)
+        {
+            vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
+        }
+
         vkDestroyInstance(m_Instance, nullptr);
     }
 
@@ -86,7 +118,8 @@ namespace VulkanEngine {
         appInfo.applicationVersion                              = VK_MAKE_VERSION(1, 0, 0);
         appInfo.pEngineName                                     = "No Engine";
         appInfo.engineVersion                                   = VK_MAKE_VERSION(1, 0, 0);
-        appInfo.apiVersion                                      = VK_API_VERSION_1_0;
+        // 1.2 for timeline semaphores, devices that only report 1.0 still work through the fence fallback
+        appInfo.apiVersion                                      = VK_API_VERSION_1_2;
 
         VkInstanceCreateInfo createInfo = {};
 
@@ -160,7 +193,7 @@ namespace VulkanEngine {
         QueueFamilyIndices indices = FindQueueFamilies(m_PhysicalDevice);
 
         std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-        std::set<uint32_t> uniqueQueueFamilies = { indices.GraphicsFamily, indices.PresentFamily };
+        std::set<uint32_t> uniqueQueueFamilies = { indices.GraphicsFamily, indices.PresentFamily, indices.TransferFamily };
 
         float queuePriority = 1.0f;
         for (uint32_t queueFamily : uniqueQueueFamilies)
@@ -185,9 +218,84 @@ namespace VulkanEngine {
         createInfo.queueCreateInfoCount                         = static_cast<uint32_t>(queueCreateInfos.size());
         createInfo.pQueueCreateInfos                            = queueCreateInfos.data();
 
+        m_EnabledDeviceExtensions = GetRequiredDeviceExtensions();
+
+        // Optional extensions, only enabled when the device has them
+        if (CheckDeviceExtensionSupport(m_PhysicalDevice, VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME))
+        {
+            m_EnabledDeviceExtensions.push_back(VK_EXT_PIPELINE_CREATION_FEEDBACK_EXTENSION_NAME);
+            m_PipelineCreationFeedbackSupported = true;
+        }
+
+        // Timeline semaphores and descriptor indexing are core in 1.2 but still optional feature bits on some drivers
+        VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures = {};
+
+        timelineFeatures.sType                                  = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+
+        VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures = {};
+
+        descriptorIndexingFeatures.sType                        = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+
+        if (m_Properties.apiVersion >= VK_API_VERSION_1_2)
+        {
+            VkPhysicalDeviceFeatures2 features2 = {};
+
+            features2.sType                                     = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+            features2.pNext                                     = &timelineFeatures;
+            timelineFeatures.pNext                              = &descriptorIndexingFeatures;
+
+            vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features2);
+            m_TimelineSemaphoreSupported = timelineFeatures.timelineSemaphore == VK_TRUE;
+            m_DescriptorIndexingSupported =
+                descriptorIndexingFeatures.runtimeDescriptorArray == VK_TRUE &&
+                descriptorIndexingFeatures.descriptorBindingPartiallyBound == VK_TRUE &&
+                descriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending == VK_TRUE &&
+                descriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                descriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind == VK_TRUE &&
+                descriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+        }
+
+        // Only the features the engine uses are enabled, chained in front of whatever came before
+        void* featureChain = nullptr;
+
+        VkPhysicalDeviceDescriptorIndexingFeatures enabledDescriptorIndexingFeatures = {};
+
+        if (m_DescriptorIndexingSupported)
+        {
+            enabledDescriptorIndexingFeatures.sType                                             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+            enabledDescriptorIndexingFeatures.pNext                                             = featureChain;
+            enabledDescriptorIndexingFeatures.runtimeDescriptorArray                            = VK_TRUE;
+            enabledDescriptorIndexingFeatures.descriptorBindingPartiallyBound                   = VK_TRUE;
+            enabledDescriptorIndexingFeatures.descriptorBindingUpdateUnusedWhilePending         = VK_TRUE;
+            enabledDescriptorIndexingFeatures.descriptorBindingSampledImageUpdateAfterBind      = VK_TRUE;
+            enabledDescriptorIndexingFeatures.descriptorBindingStorageBufferUpdateAfterBind     = VK_TRUE;
+            enabledDescriptorIndexingFeatures.shaderSampledImageArrayNonUniformIndexing         = VK_TRUE;
+            featureChain = &enabledDescriptorIndexingFeatures;
+
+            VkPhysicalDeviceProperties2 properties2 = {};
+
+            m_DescriptorIndexingProperties.sType                = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+            properties2.sType                                   = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+            properties2.pNext                                   = &m_DescriptorIndexingProperties;
+
+            vkGetPhysicalDeviceProperties2(m_PhysicalDevice, &properties2);
+            m_DescriptorIndexingProperties.pNext                = nullptr;
+        }
+
+        if (m_TimelineSemaphoreSupported)
+        {
+            timelineFeatures.pNext                              = featureChain;
+            featureChain = &timelineFeatures;
+        }
+
+        createInfo.pNext                                        = featureChain;
+
+        std::cout << "frame sync: " << (m_TimelineSemaphoreSupported ? "timeline semaphore" : "fences") << std::endl;
+        std::cout << "descriptor indexing: " << (m_DescriptorIndexingSupported ? "supported" : "unsupported") << std::endl;
+
         createInfo.pEnabledFeatures                             = &deviceFeatures;
-        createInfo.enabledExtensionCount                        = static_cast<uint32_t>(m_DeviceExtensions.size());
-        createInfo.ppEnabledExtensionNames                      = m_DeviceExtensions.data();
+        createInfo.enabledExtensionCount                        = static_cast<uint32_t>(m_EnabledDeviceExtensions.size());
+        createInfo.ppEnabledExtensionNames                      = m_EnabledDeviceExtensions.data();
 
         // might not really be necessary anymore because device specific validation layers
         // have been deprecated
@@ -208,6 +316,10 @@ namespace VulkanEngine {
 
         vkGetDeviceQueue(m_Device, indices.GraphicsFamily, 0, &m_GraphicsQueue);
         vkGetDeviceQueue(m_Device, indices.PresentFamily, 0, &m_PresentQueue);
+        vkGetDeviceQueue(m_Device, indices.TransferFamily, 0, &m_TransferQueue);
+
+        std::cout << "transfer queue family: " << indices.TransferFamily
+                  << (indices.HasDedicatedTransferFamily() ? " (dedicated)" : " (shared with graphics)") << std::endl;
     }
 
     void VEDevice::CreateCommandPool() 
@@ -226,18 +338,140 @@ namespace VulkanEngine {
         }
     }
 
+    void VEDevice::CreatePipelineCache()
+    {
+        std::vector<char> cacheData;
+
+        std::ifstream file(m_PipelineCachePath, std::ios::ate | std::ios::binary);
+
+        if (file.is_open())
+        {
+            cacheData.resize(static_cast<size_t>(file.tellg()));
+            file.seekg(0);
+            file.read(cacheData.data(), cacheData.size());
+            file.close();
+
+            // A cache from another GPU or driver is at best ignored by the driver, at worst it crashes it
+            if (!IsPipelineCacheCompatible(cacheData))
+            {
+                std::cout << "pipeline cache: discarding " << m_PipelineCachePath << ", it was created by a different device or driver" << std::endl;
+                cacheData.clear();
+            }
+            else
+            {
+                std::cout << "pipeline cache: loaded " << cacheData.size() << " bytes from " << m_PipelineCachePath << std::endl;
+            }
+        }
+
+        VkPipelineCacheCreateInfo cacheInfo = {};
+
+        cacheInfo.sType                                         = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+        cacheInfo.initialDataSize                               = cacheData.size();
+        cacheInfo.pInitialData                                  = cacheData.empty() ? nullptr : cacheData.data();
+
+        if (vkCreatePipelineCache(m_Device, &cacheInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline cache!");
+        }
+    }
+
+    bool VEDevice::IsPipelineCacheCompatible(const std::vector<char>& cacheData)
+    {
+        VkPipelineCacheHeaderVersionOne header;
+
+        if (cacheData.size() < sizeof(header))
+        {
+            return false;
+        }
+
+        memcpy(&header, cacheData.data(), sizeof(header));
+
+        return header.headerSize >= sizeof(header) &&
+               header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+               header.vendorID == m_Properties.vendorID &&
+               header.deviceID == m_Properties.deviceID &&
+               memcmp(header.pipelineCacheUUID, m_Properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    void VEDevice::SavePipelineCache()
+    {
+        size_t dataSize = 0;
+        if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0)
+        {
+            return;
+        }
+
+        std::vector<char> cacheData(dataSize);
+        if (vkGetPipelineCacheData(m_Device, m_PipelineCache, &dataSize, cacheData.data()) != VK_SUCCESS)
+        {
+            return;
+        }
+
+        // Write next to the real file and swap it in, so a crash mid-write never leaves a truncated cache behind
+        std::string tempPath = m_PipelineCachePath + ".tmp";
+
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open())
+        {
+            std::cerr << "pipeline cache: failed to open " << tempPath << " for writing" << std::endl;
+            return;
+        }
+
+        file.write(cacheData.data(), dataSize);
+        file.close();
+
+        if (file.fail())
+        {
+            std::cerr << "pipeline cache: failed to write " << tempPath << std::endl;
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+#ifdef _WIN32
+        bool replaced = MoveFileExA(tempPath.c_str(), m_PipelineCachePath.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        bool replaced = std::rename(tempPath.c_str(), m_PipelineCachePath.c_str()) == 0;
+#endif
+
+        if (!replaced)
+        {
+            std::cerr << "pipeline cache: failed to replace " << m_PipelineCachePath << std::endl;
+            std::remove(tempPath.c_str());
+            return;
+        }
+
+        std::cout << "pipeline cache: saved " << dataSize << " bytes to " << m_PipelineCachePath << std::endl;
+    }
+
+    uint32_t VEDevice::GetTimestampValidBits()
+    {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &queueFamilyCount, nullptr);
+
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_PhysicalDevice, &queueFamilyCount, queueFamilies.data());
+
+        return queueFamilies[FindPhysicalQueueFamilies().GraphicsFamily].timestampValidBits;
+    }
+
     void VEDevice::CreateSurface() 
     {
-        m_Window.CreateWindowSurface(m_Instance, &m_Surface);
+        if (IsHeadless())
+        {
+            return;
+        }
+
+        m_Window->CreateWindowSurface(m_Instance, &m_Surface);
     }
 
     bool VEDevice::IsDeviceSuitable(VkPhysicalDevice device)
     {
         QueueFamilyIndices indices                              = FindQueueFamilies(device);
         bool extensionsSupported                                = CheckDeviceExtensionSupport(device);
-        bool SwapChainAdequate                                  = false;
+        bool SwapChainAdequate                                  = IsHeadless();
 
-        if (extensionsSupported) 
+        if (extensionsSupported && !IsHeadless()) 
         {
             SwapChainSupportDetails SwapChainSupport            = QuerySwapChainSupport(device);
             SwapChainAdequate                                   = !SwapChainSupport.Formats.empty() && !SwapChainSupport.PresentModes.empty();
@@ -306,12 +540,18 @@ namespace VulkanEngine {
 
     std::vector<const char*> VEDevice::GetRequiredExtensions() 
     {
-        uint32_t glfwExtensionCount = 0;
-        const char** glfwExtensions;
+        std::vector<const char*> extensions;
 
-        glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        // A headless instance never creates a surface, so it needs none of the window system extensions
+        if (!IsHeadless())
+        {
+            uint32_t glfwExtensionCount = 0;
+            const char** glfwExtensions;
 
-        std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+            glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+            extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+        }
 
         if (EnableValidationLayers) 
         {
@@ -360,7 +600,8 @@ namespace VulkanEngine {
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-        std::set<std::string> requiredExtensions(m_DeviceExtensions.begin(), m_DeviceExtensions.end());
+        std::vector<const char*> deviceExtensions = GetRequiredDeviceExtensions();
+        std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
         for (const auto& extension : availableExtensions) 
         {
@@ -370,6 +611,31 @@ namespace VulkanEngine {
         return requiredExtensions.empty();
     }
 
+    std::vector<const char*> VEDevice::GetRequiredDeviceExtensions() const
+    {
+        // Everything in m_DeviceExtensions is there for presentation
+        return IsHeadless() ? std::vector<const char*>{} : m_DeviceExtensions;
+    }
+
+    bool VEDevice::CheckDeviceExtensionSupport(VkPhysicalDevice device, const char* extensionName)
+    {
+        uint32_t extensionCount;
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+        std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+        vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+
+        for (const auto& extension : availableExtensions)
+        {
+            if (strcmp(extension.extensionName, extensionName) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
     QueueFamilyIndices VEDevice::FindQueueFamilies(VkPhysicalDevice device) 
     {
         QueueFamilyIndices indices;
@@ -389,8 +655,13 @@ namespace VulkanEngine {
                 indices.GraphicsFamilyHasValue = true;
             }
 
-            VkBool32 presentSupport = false;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
+            // Headless frames never get presented, the graphics queue stands in for the present queue
+            VkBool32 presentSupport = IsHeadless() && queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT;
+
+            if (!IsHeadless())
+            {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_Surface, &presentSupport);
+            }
 
             if (queueFamily.queueCount > 0 && presentSupport) 
             {
@@ -406,6 +677,37 @@ namespace VulkanEngine {
             i++;
         }
 
+        if (!indices.GraphicsFamilyHasValue)
+        {
+            return indices;
+        }
+
+        // Prefer a transfer only family, those map to the DMA engines and run next to graphics work.
+        // Next best is any non graphics family that can transfer, e.g. async compute.
+        indices.TransferFamily = indices.GraphicsFamily;
+        int bestScore = 0;
+
+        for (uint32_t family = 0; family < queueFamilyCount; family++)
+        {
+            const auto& queueFamily = queueFamilies[family];
+
+            // Graphics and compute queues support transfers implicitly
+            bool canTransfer = (queueFamily.queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) != 0;
+
+            if (queueFamily.queueCount == 0 || !canTransfer || queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)
+            {
+                continue;
+            }
+
+            int score = queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT ? 1 : 2;
+
+            if (score > bestScore)
+            {
+                bestScore = score;
+                indices.TransferFamily = family;
+            }
+        }
+
         return indices;
     }
 
@@ -475,7 +777,7 @@ namespace VulkanEngine {
         throw std::runtime_error("failed to find suitable memory type!");
     }
 
-    void VEDevice::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VkDeviceMemory& bufferMemory) 
+    void VEDevice::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, VkBuffer& buffer, VEAllocation& bufferAllocation) 
     {
         VkBufferCreateInfo bufferInfo = {};
 
@@ -492,18 +794,18 @@ namespace VulkanEngine {
         VkMemoryRequirements memRequirements;
         vkGetBufferMemoryRequirements(m_Device, buffer, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo = {};
-
-        allocInfo.sType                                         = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize                                = memRequirements.size;
-        allocInfo.memoryTypeIndex                               = FindMemoryType(memRequirements.memoryTypeBits, properties);
+        bufferAllocation = m_Allocator->Allocate(memRequirements, properties, false);
 
-        if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
+        if (vkBindBufferMemory(m_Device, buffer, bufferAllocation.Memory, bufferAllocation.Offset) != VK_SUCCESS)
         {
-            throw std::runtime_error("failed to allocate vertex buffer memory!");
+            throw std::runtime_error("failed to bind vertex buffer memory!");
         }
+    }
 
-        vkBindBufferMemory(m_Device, buffer, bufferMemory, 0);
+    void VEDevice::DestroyBuffer(VkBuffer buffer, VEAllocation& bufferAllocation)
+    {
+        vkDestroyBuffer(m_Device, buffer, nullptr);
+        m_Allocator->Free(bufferAllocation);
     }
 
     VkCommandBuffer VEDevice::BeginSingleTimeCommands()
@@ -586,7 +888,11 @@ namespace VulkanEngine {
         EndSingleTimeCommands(commandBuffer);
     }
 
-    void VEDevice::CreateImageWithInfo(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory) 
+    void VEDevice::CreateImageWithInfo(const VkImageCreateInfo& imageInfo,
+        VkMemoryPropertyFlags properties,
+        VkImage& image,
+        VEAllocation& imageAllocation,
+        VkMemoryPropertyFlags preferredProperties)
     {
         if (vkCreateImage(m_Device, &imageInfo, nullptr, &image) != VK_SUCCESS) 
         {
@@ -596,21 +902,24 @@ namespace VulkanEngine {
         VkMemoryRequirements memRequirements;
         vkGetImageMemoryRequirements(m_Device, image, &memRequirements);
 
-        VkMemoryAllocateInfo allocInfo = {};
-
-        allocInfo.sType                                         = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-        allocInfo.allocationSize                                = memRequirements.size;
-        allocInfo.memoryTypeIndex                               = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-        if (vkAllocateMemory(m_Device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+        // preferredProperties are only added when some memory type the image can live in has them
+        if (preferredProperties != 0 && m_Allocator->HasMemoryType(memRequirements.memoryTypeBits, properties | preferredProperties))
         {
-            throw std::runtime_error("failed to allocate image memory!");
+            properties |= preferredProperties;
         }
 
-        if (vkBindImageMemory(m_Device, image, imageMemory, 0) != VK_SUCCESS)
+        imageAllocation = m_Allocator->Allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_OPTIMAL);
+
+        if (vkBindImageMemory(m_Device, image, imageAllocation.Memory, imageAllocation.Offset) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to bind image memory!");
         }
     }
 
+    void VEDevice::DestroyImage(VkImage image, VEAllocation& imageAllocation)
+    {
+        vkDestroyImage(m_Device, image, nullptr);
+        m_Allocator->Free(imageAllocation);
+    }
+
 }
\ No newline at end of file
@@ -1,9 +1,14 @@
 #pragma once
 #pragma once
 
+#include "VE_Allocator.h"
+#include "VE_DeletionQueue.h"
+#include "VE_FrameTimeline.h"
+#include "VE_ShaderLibrary.h"
 #include "VE_Window.h"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,11 +23,16 @@ namespace VulkanEngine {
     struct QueueFamilyIndices {
         uint32_t GraphicsFamily;
         uint32_t PresentFamily;
+        // Falls back to GraphicsFamily when the device has no separate transfer family
+        uint32_t TransferFamily;
         bool GraphicsFamilyHasValue = false;
         bool PresentFamilyHasValue = false;
         bool IsComplete() { return GraphicsFamilyHasValue && PresentFamilyHasValue; }
+        bool HasDedicatedTransferFamily() const { return TransferFamily != GraphicsFamily; }
     };
 
+    class VEUploader;
+
     class VEDevice {
     public:
 #ifdef NDEBUG
@@ -31,7 +41,8 @@ namespace VulkanEngine {
         const bool EnableValidationLayers = true;
 #endif
 
-        VEDevice(VEWindow& window);
+        // Without a window the device is headless: no surface, no swap chain extension, present falls back to graphics
+        VEDevice(VEWindow* window);
         ~VEDevice();
 
         // Not copyable or movable
@@ -45,6 +56,16 @@ namespace VulkanEngine {
         VkSurfaceKHR Surface() { return m_Surface; }
         VkQueue GraphicsQueue() { return m_GraphicsQueue; }
         VkQueue PresentQueue() { return m_PresentQueue; }
+        VkQueue TransferQueue() { return m_TransferQueue; }
+        VkPipelineCache PipelineCache() { return m_PipelineCache; }
+        bool IsHeadless() const { return m_Window == nullptr; }
+        bool SupportsPipelineCreationFeedback() const { return m_PipelineCreationFeedbackSupported; }
+        bool SupportsTimelineSemaphores() const { return m_TimelineSemaphoreSupported; }
+        // Update after bind, partially bound and runtime sized descriptor arrays, see VEBindlessTable
+        bool SupportsDescriptorIndexing() const { return m_DescriptorIndexingSupported; }
+        const VkPhysicalDeviceDescriptorIndexingProperties& GetDescriptorIndexingProperties() const { return m_DescriptorIndexingProperties; }
+        // Bits of a timestamp written on the graphics queue that are meaningful, 0 when timestamps are unsupported
+        uint32_t GetTimestampValidBits();
 
         SwapChainSupportDetails GetSwapChainSupport() { return QuerySwapChainSupport(m_PhysicalDevice); }
         uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
@@ -57,7 +78,8 @@ namespace VulkanEngine {
             VkBufferUsageFlags usage,
             VkMemoryPropertyFlags properties,
             VkBuffer& buffer,
-            VkDeviceMemory& bufferMemory);
+            VEAllocation& bufferAllocation);
+        void DestroyBuffer(VkBuffer buffer, VEAllocation& bufferAllocation);
         VkCommandBuffer BeginSingleTimeCommands();
         void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
         void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
@@ -68,7 +90,16 @@ namespace VulkanEngine {
             const VkImageCreateInfo& imageInfo,
             VkMemoryPropertyFlags properties,
             VkImage& image,
-            VkDeviceMemory& imageMemory);
+            VEAllocation& imageAllocation,
+            VkMemoryPropertyFlags preferredProperties = 0);
+        void DestroyImage(VkImage image, VEAllocation& imageAllocation);
+
+        VEAllocator& GetAllocator() { return *m_Allocator; }
+        VEUploader& GetUploader() { return *m_Uploader; }
+        VEFrameTimeline& GetFrameTimeline() { return *m_FrameTimeline; }
+        // Destroys resources once the frames that may still use them have retired on the frame timeline
+        VEDeletionQueue& GetDeletionQueue() { return *m_DeletionQueue; }
+        VEShaderLibrary& GetShaderLibrary() { return *m_ShaderLibrary; }
 
         VkPhysicalDeviceProperties m_Properties;
 
@@ -79,31 +110,50 @@ namespace VulkanEngine {
         void PickPhysicalDevice();
         void CreateLogicalDevice();
         void CreateCommandPool();
+        void CreatePipelineCache();
+        void SavePipelineCache();
 
         // helper functions
         bool IsDeviceSuitable(VkPhysicalDevice device);
         std::vector<const char*> GetRequiredExtensions();
+        std::vector<const char*> GetRequiredDeviceExtensions() const;
         bool CheckValidationLayerSupport();
         QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
         void PopulateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT& createInfo);
         void HasGflwRequiredInstanceExtensions();
         bool CheckDeviceExtensionSupport(VkPhysicalDevice device);
+        bool CheckDeviceExtensionSupport(VkPhysicalDevice device, const char* extensionName);
+        bool IsPipelineCacheCompatible(const std::vector<char>& cacheData);
         SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
 
     private:
         VkInstance m_Instance;
         VkDebugUtilsMessengerEXT m_DebugMessenger;
         VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
-        VEWindow& m_Window;
+        VEWindow* m_Window;
         VkCommandPool m_CommandPool;
+        VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+        std::unique_ptr<VEAllocator> m_Allocator;
+        std::unique_ptr<VEUploader> m_Uploader;
+        std::unique_ptr<VEFrameTimeline> m_FrameTimeline;
+        std::unique_ptr<VEDeletionQueue> m_DeletionQueue;
+        std::unique_ptr<VEShaderLibrary> m_ShaderLibrary;
 
         VkDevice m_Device;
-        VkSurfaceKHR m_Surface;
+        VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
         VkQueue m_GraphicsQueue;
         VkQueue m_PresentQueue;
+        VkQueue m_TransferQueue;
 
         const std::vector<const char*> m_ValidationLayers = { "VK_LAYER_KHRONOS_validation" };
         const std::vector<const char*> m_DeviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+        std::vector<const char*> m_EnabledDeviceExtensions;
+        bool m_PipelineCreationFeedbackSupported = false;
+        bool m_TimelineSemaphoreSupported = false;
+        bool m_DescriptorIndexingSupported = false;
+        VkPhysicalDeviceDescriptorIndexingProperties m_DescriptorIndexingProperties = {};
+
+        const std::string m_PipelineCachePath = "pipeline_cache.bin";
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "VE_DrawList.h"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+
+namespace VulkanEngine {
+
+	constexpr float VEDrawList::DEFAULT_THICKNESS;
+	constexpr uint32_t VEDrawList::DEFAULT_CIRCLE_SEGMENTS;
+
+	uint32_t VEDrawList::PackColor(const glm::vec4& color)
+	{
+		glm::vec4 scaled = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+
+		return static_cast<uint32_t>(scaled.x) |
+			(static_cast<uint32_t>(scaled.y) << 8) |
+			(static_cast<uint32_t>(scaled.z) << 16) |
+			(static_cast<uint32_t>(scaled.w) << 24);
+	}
+
+	void VEDrawList::Clear()
+	{
+		m_Vertices.clear();
+		m_Indices.clear();
+	}
+
+	void VEDrawList::AddQuad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, uint32_t color)
+	{
+		uint32_t first = static_cast<uint32_t>(m_Vertices.size());
+
+		m_Vertices.push_back({ a, color });
+		m_Vertices.push_back({ b, color });
+		m_Vertices.push_back({ c, color });
+		m_Vertices.push_back({ d, color });
+
+		m_Indices.insert(m_Indices.end(), { first, first + 1, first + 2, first, first + 2, first + 3 });
+	}
+
+	void VEDrawList::AddSegment(glm::vec2 from, glm::vec2 to, uint32_t color, float thickness)
+	{
+		glm::vec2 direction = to - from;
+		float length = glm::length(direction);
+
+		if (length < 1e-6f)
+		{
+			return;
+		}
+
+		glm::vec2 normal = glm::vec2(-direction.y, direction.x) * (0.5f * thickness / length);
+
+		AddQuad(from - normal, to - normal, to + normal, from + normal, color);
+	}
+
+	void VEDrawList::AddLine(glm::vec2 from, glm::vec2 to, const glm::vec4& color, float thickness)
+	{
+		AddSegment(from, to, PackColor(color), thickness);
+	}
+
+	void VEDrawList::AddRect(glm::vec2 min, glm::vec2 max, const glm::vec4& color, float thickness)
+	{
+		glm::vec2 corners[] = { min, { max.x, min.y }, max, { min.x, max.y } };
+
+		AddPolyline(corners, 4, color, thickness, true);
+	}
+
+	void VEDrawList::AddRectFilled(glm::vec2 min, glm::vec2 max, const glm::vec4& color)
+	{
+		AddQuad(min, { max.x, min.y }, max, { min.x, max.y }, PackColor(color));
+	}
+
+	void VEDrawList::AddCircle(glm::vec2 center, float radius, const glm::vec4& color, float thickness, uint32_t segments)
+	{
+		segments = std::max(segments, 3u);
+
+		uint32_t packedColor = PackColor(color);
+		uint32_t first = static_cast<uint32_t>(m_Vertices.size());
+		float innerRadius = radius - 0.5f * thickness;
+		float outerRadius = radius + 0.5f * thickness;
+
+		// An inner and outer ring with a quad between each pair of spokes
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			float angle = glm::two_pi<float>() * i / segments;
+			glm::vec2 spoke{ glm::cos(angle), glm::sin(angle) };
+
+			m_Vertices.push_back({ center + spoke * innerRadius, packedColor });
+			m_Vertices.push_back({ center + spoke * outerRadius, packedColor });
+		}
+
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			uint32_t inner = first + i * 2;
+			uint32_t nextInner = first + ((i + 1) % segments) * 2;
+
+			m_Indices.insert(m_Indices.end(), { inner, inner + 1, nextInner + 1, inner, nextInner + 1, nextInner });
+		}
+	}
+
+	void VEDrawList::AddCircleFilled(glm::vec2 center, float radius, const glm::vec4& color, uint32_t segments)
+	{
+		segments = std::max(segments, 3u);
+
+		uint32_t packedColor = PackColor(color);
+		uint32_t first = static_cast<uint32_t>(m_Vertices.size());
+
+		m_Vertices.push_back({ center, packedColor });
+
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			float angle = glm::two_pi<float>() * i / segments;
+
+			m_Vertices.push_back({ center + glm::vec2(glm::cos(angle), glm::sin(angle)) * radius, packedColor });
+		}
+
+		// Triangle fan around the center vertex
+		for (uint32_t i = 0; i < segments; i++)
+		{
+			m_Indices.insert(m_Indices.end(), { first, first + 1 + i, first + 1 + (i + 1) % segments });
+		}
+	}
+
+	void VEDrawList::AddPolyline(const glm::vec2* points, uint32_t pointCount, const glm::vec4& color, float thickness, bool closed)
+	{
+		if (pointCount < 2)
+		{
+			return;
+		}
+
+		uint32_t packedColor = PackColor(color);
+		uint32_t segmentCount = closed ? pointCount : pointCount - 1;
+
+		m_Vertices.reserve(m_Vertices.size() + segmentCount * 4);
+		m_Indices.reserve(m_Indices.size() + segmentCount * 6);
+
+		// Segments overlap at the joints instead of being mitered, invisible at overlay thicknesses
+		for (uint32_t i = 0; i < segmentCount; i++)
+		{
+			AddSegment(points[i], points[(i + 1) % pointCount], packedColor, thickness);
+		}
+	}
+}
\ No newline at end of file
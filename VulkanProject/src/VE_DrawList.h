@@ -0,0 +1,59 @@
+#pragma once
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Immediate mode 2D shapes for debug overlays, trails and the like. Every shape is triangulated into one
+	// growing vertex and index array on the CPU, DrawListRenderSystem uploads and draws the lot at once.
+	// Positions and thicknesses are in clip space, same as the rest of the 2D scene.
+	class VEDrawList
+	{
+	public:
+		// Matches the vertex attributes in DrawList_Shader.vert
+		struct Vertex
+		{
+			glm::vec2 Position;
+			uint32_t Color;		// RGBA8, red in the lowest byte
+		};
+
+		static constexpr float DEFAULT_THICKNESS = 0.004f;
+		static constexpr uint32_t DEFAULT_CIRCLE_SEGMENTS = 32;
+
+		static uint32_t PackColor(const glm::vec4& color);
+
+		// Drops the shapes but keeps the memory, call once per frame before adding new ones
+		void Clear();
+
+		void AddLine(glm::vec2 from, glm::vec2 to, const glm::vec4& color, float thickness = DEFAULT_THICKNESS);
+		void AddRect(glm::vec2 min, glm::vec2 max, const glm::vec4& color, float thickness = DEFAULT_THICKNESS);
+		void AddRectFilled(glm::vec2 min, glm::vec2 max, const glm::vec4& color);
+		void AddCircle(glm::vec2 center, float radius, const glm::vec4& color, float thickness = DEFAULT_THICKNESS, uint32_t segments = DEFAULT_CIRCLE_SEGMENTS);
+		void AddCircleFilled(glm::vec2 center, float radius, const glm::vec4& color, uint32_t segments = DEFAULT_CIRCLE_SEGMENTS);
+		// Joins consecutive points, closed also joins the last point back to the first
+		void AddPolyline(const glm::vec2* points, uint32_t pointCount, const glm::vec4& color, float thickness = DEFAULT_THICKNESS, bool closed = false);
+
+		void AddPolyline(const std::vector<glm::vec2>& points, const glm::vec4& color, float thickness = DEFAULT_THICKNESS, bool closed = false)
+		{
+			AddPolyline(points.data(), static_cast<uint32_t>(points.size()), color, thickness, closed);
+		}
+
+		bool IsEmpty() const { return m_Indices.empty(); }
+		const std::vector<Vertex>& GetVertices() const { return m_Vertices; }
+		const std::vector<uint32_t>& GetIndices() const { return m_Indices; }
+
+	private:
+		// Appends a quad from four corners in winding order
+		void AddQuad(glm::vec2 a, glm::vec2 b, glm::vec2 c, glm::vec2 d, uint32_t color);
+		void AddSegment(glm::vec2 from, glm::vec2 to, uint32_t color, float thickness);
+
+	private:
+		std::vector<Vertex> m_Vertices;
+		std::vector<uint32_t> m_Indices;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "VE_FrameRingBuffer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr VkDeviceSize VEFrameRingBuffer::DEFAULT_FRAME_SIZE;
+
+	namespace {
+
+		VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	VEFrameRingBuffer::VEFrameRingBuffer(VEDevice& device, uint32_t frameCount, VkDeviceSize frameSize, VkBufferUsageFlags usage)
+		: m_Device{ device }, m_FrameCount{ frameCount }
+	{
+		const VkPhysicalDeviceLimits& limits = m_Device.m_Properties.limits;
+
+		// Vertex and index bindings are happy with 16 bytes, descriptors may need more
+		m_DefaultAlignment = std::max<VkDeviceSize>({ 16,
+			limits.minUniformBufferOffsetAlignment,
+			limits.minStorageBufferOffsetAlignment });
+
+		// Partitions start on an atom boundary so flushing one never touches its neighbour
+		VkDeviceSize partitionAlignment = std::max(m_DefaultAlignment, m_Device.GetAllocator().GetNonCoherentAtomSize());
+		m_FrameSize = AlignUp(frameSize, partitionAlignment);
+
+		m_Device.CreateBuffer(m_FrameSize * m_FrameCount,
+			usage,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT,
+			m_Buffer,
+			m_Allocation);
+
+		m_IsCoherent = (m_Device.GetAllocator().GetMemoryTypeProperties(m_Allocation.MemoryTypeIndex) & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+	}
+
+	VEFrameRingBuffer::~VEFrameRingBuffer()
+	{
+		m_Device.DestroyBuffer(m_Buffer, m_Allocation);
+	}
+
+	void VEFrameRingBuffer::BeginFrame(uint32_t frameIndex)
+	{
+		assert(frameIndex < m_FrameCount && "Frame index out of range");
+
+		m_FrameIndex = frameIndex;
+		m_Head.store(0, std::memory_order_relaxed);
+	}
+
+	void VEFrameRingBuffer::Flush()
+	{
+		VkDeviceSize used = m_Head.load(std::memory_order_relaxed);
+
+		if (m_IsCoherent || used == 0)
+		{
+			return;
+		}
+
+		// The allocator widens the range out to nonCoherentAtomSize
+		m_Device.GetAllocator().Flush(m_Allocation, m_FrameIndex * m_FrameSize, std::min(used, m_FrameSize));
+	}
+
+	VEBufferSlice VEFrameRingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+	{
+		if (alignment == 0)
+		{
+			alignment = m_DefaultAlignment;
+		}
+
+		VkDeviceSize head = m_Head.load(std::memory_order_relaxed);
+		VkDeviceSize offset;
+
+		do
+		{
+			offset = AlignUp(head, alignment);
+
+			if (offset + size > m_FrameSize)
+			{
+				throw std::runtime_error("Frame ring buffer is out of space, increase its frame size.");
+			}
+		} while (!m_Head.compare_exchange_weak(head, offset + size, std::memory_order_relaxed));
+
+		VEBufferSlice slice;
+
+		slice.Buffer			= m_Buffer;
+		slice.Offset			= m_FrameIndex * m_FrameSize + offset;
+		slice.Size				= size;
+		slice.MappedData		= static_cast<char*>(m_Allocation.MappedData) + slice.Offset;
+
+		return slice;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+#include "VE_Device.h"
+
+#include <atomic>
+#include <cstring>
+
+namespace VulkanEngine {
+
+	// A piece of the ring buffer that stays valid until the same frame index comes around again
+	struct VEBufferSlice
+	{
+		VkBuffer Buffer					= VK_NULL_HANDLE;
+		VkDeviceSize Offset				= 0;
+		VkDeviceSize Size				= 0;
+		void* MappedData				= nullptr;
+
+		// For vkCmdBindDescriptorSets with a *_DYNAMIC descriptor pointing at the start of the buffer
+		uint32_t DynamicOffset() const { return static_cast<uint32_t>(Offset); }
+
+		VkDescriptorBufferInfo DescriptorInfo() const { return { Buffer, Offset, Size }; }
+	};
+
+	// One persistently mapped buffer split into one partition per frame in flight. Each frame bump allocates
+	// out of its own partition, which is recycled once that frame's fence has been waited on.
+	// Allocate is lock free, so it can be called from the parallel recording threads.
+	class VEFrameRingBuffer
+	{
+	public:
+		static constexpr VkDeviceSize DEFAULT_FRAME_SIZE = 4ull * 1024 * 1024;
+
+		VEFrameRingBuffer(VEDevice& device,
+			uint32_t frameCount,
+			VkDeviceSize frameSize = DEFAULT_FRAME_SIZE,
+			VkBufferUsageFlags usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+				VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+		~VEFrameRingBuffer();
+
+		// Delete the copy constructor and copy operator
+		VEFrameRingBuffer(const VEFrameRingBuffer&) = delete;
+		VEFrameRingBuffer& operator=(const VEFrameRingBuffer&) = delete;
+
+		// Only call once the GPU is done with frameIndex's previous use
+		void BeginFrame(uint32_t frameIndex);
+		// Makes this frame's writes visible to the device, call before submitting
+		void Flush();
+
+		// alignment 0 picks one that is valid for uniform, storage and vertex bindings alike
+		VEBufferSlice Allocate(VkDeviceSize size, VkDeviceSize alignment = 0);
+
+		VEBufferSlice Upload(const void* data, VkDeviceSize size, VkDeviceSize alignment = 0)
+		{
+			VEBufferSlice slice = Allocate(size, alignment);
+			memcpy(slice.MappedData, data, static_cast<size_t>(size));
+			return slice;
+		}
+
+		template<typename T>
+		VEBufferSlice Push(const T& data) { return Upload(&data, sizeof(T)); }
+
+		VkBuffer GetBuffer() const { return m_Buffer; }
+		VkDeviceSize GetFrameSize() const { return m_FrameSize; }
+		// Bytes handed out so far in the current frame
+		VkDeviceSize GetUsedBytes() const { return m_Head.load(std::memory_order_relaxed); }
+
+	private:
+		VEDevice& m_Device;
+		VkBuffer m_Buffer;
+		VEAllocation m_Allocation;
+
+		uint32_t m_FrameCount;
+		VkDeviceSize m_FrameSize;
+		VkDeviceSize m_DefaultAlignment;
+		bool m_IsCoherent;
+
+		uint32_t m_FrameIndex = 0;
+		std::atomic<VkDeviceSize> m_Head{ 0 };	// Offset inside the current frame's partition
+	};
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+#include "VE_FrameTimeline.h"
+
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	VEFrameTimeline::VEFrameTimeline(VkDevice device, bool useTimelineSemaphore)
+		: m_Device{ device }
+	{
+		if (!useTimelineSemaphore)
+		{
+			return;
+		}
+
+		VkSemaphoreTypeCreateInfo typeInfo = {};
+
+		typeInfo.sType				= VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+		typeInfo.semaphoreType		= VK_SEMAPHORE_TYPE_TIMELINE;
+		typeInfo.initialValue		= 0;
+
+		VkSemaphoreCreateInfo semaphoreInfo = {};
+
+		semaphoreInfo.sType			= VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+		semaphoreInfo.pNext			= &typeInfo;
+
+		if (vkCreateSemaphore(m_Device, &semaphoreInfo, nullptr, &m_Semaphore) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create the frame timeline semaphore.");
+		}
+	}
+
+	VEFrameTimeline::~VEFrameTimeline()
+	{
+		Wait(GetSubmittedValue());
+
+		if (m_Semaphore != VK_NULL_HANDLE)
+		{
+			vkDestroySemaphore(m_Device, m_Semaphore, nullptr);
+		}
+
+		for (VkFence fence : m_FreeFences)
+		{
+			vkDestroyFence(m_Device, fence, nullptr);
+		}
+	}
+
+	VkResult VEFrameTimeline::Submit(VkQueue queue, const VkSubmitInfo& submitInfo, uint64_t* signalValue)
+	{
+		assert(submitInfo.pNext == nullptr && "The frame timeline owns the submit's pNext chain.");
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		uint64_t value = m_SubmittedValue.load(std::memory_order_relaxed) + 1;
+		VkResult result;
+
+		if (UsesTimelineSemaphore())
+		{
+			// Binary semaphores ignore their entry in the value arrays, but the counts have to match
+			std::vector<VkSemaphore> signalSemaphores(submitInfo.pSignalSemaphores, submitInfo.pSignalSemaphores + submitInfo.signalSemaphoreCount);
+			std::vector<uint64_t> signalValues(submitInfo.signalSemaphoreCount, 0);
+			std::vector<uint64_t> waitValues(submitInfo.waitSemaphoreCount, 0);
+
+			signalSemaphores.push_back(m_Semaphore);
+			signalValues.push_back(value);
+
+			VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+
+			timelineInfo.sType						= VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+			timelineInfo.waitSemaphoreValueCount	= static_cast<uint32_t>(waitValues.size());
+			timelineInfo.pWaitSemaphoreValues		= waitValues.data();
+			timelineInfo.signalSemaphoreValueCount	= static_cast<uint32_t>(signalValues.size());
+			timelineInfo.pSignalSemaphoreValues		= signalValues.data();
+
+			VkSubmitInfo timelineSubmit = submitInfo;
+
+			timelineSubmit.pNext					= &timelineInfo;
+			timelineSubmit.signalSemaphoreCount		= static_cast<uint32_t>(signalSemaphores.size());
+			timelineSubmit.pSignalSemaphores		= signalSemaphores.data();
+
+			result = vkQueueSubmit(queue, 1, &timelineSubmit, VK_NULL_HANDLE);
+		}
+		else
+		{
+			VkFence fence = AcquireFence();
+
+			result = vkQueueSubmit(queue, 1, &submitInfo, fence);
+
+			if (result == VK_SUCCESS)
+			{
+				m_PendingFences.push_back({ value, fence });
+			}
+			else
+			{
+				m_FreeFences.push_back(fence);
+			}
+		}
+
+		if (result == VK_SUCCESS)
+		{
+			m_SubmittedValue.store(value, std::memory_order_release);
+
+			if (signalValue != nullptr)
+			{
+				*signalValue = value;
+			}
+		}
+
+		return result;
+	}
+
+	uint64_t VEFrameTimeline::GetCompletedValue()
+	{
+		if (UsesTimelineSemaphore())
+		{
+			uint64_t value = 0;
+			vkGetSemaphoreCounterValue(m_Device, m_Semaphore, &value);
+			AdvanceCompletedValue(value);
+
+			return value;
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		PollFences();
+
+		return m_CompletedValue.load(std::memory_order_relaxed);
+	}
+
+	void VEFrameTimeline::Wait(uint64_t value)
+	{
+		// Values only ever grow, so anything already seen as complete needs no call into the driver
+		if (value <= m_CompletedValue.load(std::memory_order_acquire))
+		{
+			return;
+		}
+
+		if (UsesTimelineSemaphore())
+		{
+			VkSemaphoreWaitInfo waitInfo = {};
+
+			waitInfo.sType				= VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+			waitInfo.semaphoreCount		= 1;
+			waitInfo.pSemaphores		= &m_Semaphore;
+			waitInfo.pValues			= &value;
+
+			vkWaitSemaphores(m_Device, &waitInfo, std::numeric_limits<uint64_t>::max());
+			AdvanceCompletedValue(value);
+
+			return;
+		}
+
+		// The lock is held while waiting so no other thread can recycle the fence underneath us
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (const PendingFence& pending : m_PendingFences)
+		{
+			if (pending.Value >= value)
+			{
+				vkWaitForFences(m_Device, 1, &pending.Fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+				break;
+			}
+		}
+
+		PollFences();
+	}
+
+	void VEFrameTimeline::AdvanceCompletedValue(uint64_t value)
+	{
+		// Racing threads may observe values out of order, only ever move the cached value forward
+		uint64_t completed = m_CompletedValue.load(std::memory_order_relaxed);
+		while (completed < value && !m_CompletedValue.compare_exchange_weak(completed, value, std::memory_order_release))
+		{
+		}
+	}
+
+	VkFence VEFrameTimeline::AcquireFence()
+	{
+		PollFences();
+
+		if (!m_FreeFences.empty())
+		{
+			VkFence fence = m_FreeFences.back();
+			m_FreeFences.pop_back();
+
+			return fence;
+		}
+
+		VkFenceCreateInfo fenceInfo = {};
+
+		fenceInfo.sType				= VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		VkFence fence;
+		if (vkCreateFence(m_Device, &fenceInfo, nullptr, &fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create a frame timeline fence.");
+		}
+
+		return fence;
+	}
+
+	void VEFrameTimeline::PollFences()
+	{
+		// Submits to one queue complete in order, so the first unsignaled fence ends the scan
+		while (!m_PendingFences.empty() && vkGetFenceStatus(m_Device, m_PendingFences.front().Fence) == VK_SUCCESS)
+		{
+			PendingFence pending = m_PendingFences.front();
+			m_PendingFences.pop_front();
+
+			vkResetFences(m_Device, 1, &pending.Fence);
+			m_FreeFences.push_back(pending.Fence);
+			m_CompletedValue.store(pending.Value, std::memory_order_release);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Counts submissions to the graphics queue. Every submit made through the timeline signals the next value,
+	// so "the GPU has finished frame N" becomes a single comparison that any subsystem can poll or wait on.
+	//
+	// Backed by a Vulkan 1.2 timeline semaphore when the device supports one. Otherwise every submit gets a
+	// fence from a small pool and the completed value is advanced by polling them in order.
+	class VEFrameTimeline
+	{
+	public:
+		VEFrameTimeline(VkDevice device, bool useTimelineSemaphore);
+		~VEFrameTimeline();
+
+		// Delete the copy constructor and copy operator
+		VEFrameTimeline(const VEFrameTimeline&) = delete;
+		VEFrameTimeline& operator=(const VEFrameTimeline&) = delete;
+
+		// Submits with the next value added to the signal operations, submitInfo must not carry its own pNext chain
+		VkResult Submit(VkQueue queue, const VkSubmitInfo& submitInfo, uint64_t* signalValue);
+
+		// Value of the most recent submit, 0 before the first one
+		uint64_t GetSubmittedValue() const { return m_SubmittedValue.load(std::memory_order_acquire); }
+		uint64_t GetCompletedValue();
+		bool IsComplete(uint64_t value) { return value <= GetCompletedValue(); }
+
+		// Blocks until the submit that signaled value has finished on the GPU
+		void Wait(uint64_t value);
+
+		bool UsesTimelineSemaphore() const { return m_Semaphore != VK_NULL_HANDLE; }
+
+	private:
+		struct PendingFence
+		{
+			uint64_t Value;
+			VkFence Fence;
+		};
+
+		void AdvanceCompletedValue(uint64_t value);
+		VkFence AcquireFence();
+		void PollFences();
+
+	private:
+		VkDevice m_Device;
+		VkSemaphore m_Semaphore = VK_NULL_HANDLE;
+
+		std::atomic<uint64_t> m_SubmittedValue{ 0 };
+		std::atomic<uint64_t> m_CompletedValue{ 0 };
+
+		// Fence fallback, oldest submit first
+		std::deque<PendingFence> m_PendingFences;
+		std::vector<VkFence> m_FreeFences;
+		std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
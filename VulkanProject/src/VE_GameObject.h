@@ -1,5 +1,6 @@
 #pragma once
 #include "VE_Model.h"
+#include "VE_ModelLod.h"
 
 #include <memory>
 
@@ -45,8 +46,36 @@ namespace VulkanEngine {
 
 		id_t GetId() { return m_Id; }
 
+		// World space box around the model after scale, rotation and translation
+		VEBounds2D ComputeBounds()
+		{
+			const VEBounds2D& local = m_Model->GetBounds();
+			glm::mat2 transform = m_Transform2D.Mat2();
+
+			glm::vec2 corners[4] = {
+				transform * local.Min,
+				transform * glm::vec2{ local.Max.x, local.Min.y },
+				transform * glm::vec2{ local.Min.x, local.Max.y },
+				transform * local.Max };
+
+			VEBounds2D bounds{ corners[0], corners[0] };
+			for (const auto& corner : corners)
+			{
+				bounds.Min = glm::min(bounds.Min, corner);
+				bounds.Max = glm::max(bounds.Max, corner);
+			}
+
+			bounds.Min += m_Transform2D.Translation;
+			bounds.Max += m_Transform2D.Translation;
+			return bounds;
+		}
+
 		std::shared_ptr<VEModel> m_Model;
+		// When set, m_Model is swapped for the level that suits the object's size on screen as it is drawn
+		std::shared_ptr<VEModelLodChain> m_LodChain;
+		uint32_t m_LodLevel{ 0 };
 		glm::vec3 m_Color{};
+		uint32_t m_TextureIndex{ ~0u };	// Slot in the bindless table, ~0u draws the flat color
 		Transform2DComponent m_Transform2D;
 		RigidBody2DComponent m_RigidBody2D;
 
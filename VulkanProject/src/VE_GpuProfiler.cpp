@@ -0,0 +1,215 @@
+#include "VE_GpuProfiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VEGpuProfiler::MAX_SCOPES_PER_FRAME;
+	constexpr uint32_t VEGpuProfiler::HISTORY_LENGTH;
+	constexpr uint32_t VEGpuProfiler::INVALID_SCOPE;
+
+	VEGpuProfiler::VEGpuProfiler(VEDevice& device, uint32_t framesInFlight)
+		: m_Device{ device }
+	{
+		m_TimestampValidBits	= m_Device.GetTimestampValidBits();
+		m_TimestampPeriod		= m_Device.m_Properties.limits.timestampPeriod;
+
+		if (!IsSupported())
+		{
+			std::cout << "gpu profiler: the graphics queue does not support timestamps" << std::endl;
+			return;
+		}
+
+		m_Frames.resize(framesInFlight);
+
+		VkQueryPoolCreateInfo poolInfo = {};
+
+		poolInfo.sType			= VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		poolInfo.queryType		= VK_QUERY_TYPE_TIMESTAMP;
+		poolInfo.queryCount		= MAX_SCOPES_PER_FRAME * 2;
+
+		for (auto& frame : m_Frames)
+		{
+			if (vkCreateQueryPool(m_Device.Device(), &poolInfo, nullptr, &frame.QueryPool) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create timestamp query pool.");
+			}
+		}
+	}
+
+	VEGpuProfiler::~VEGpuProfiler()
+	{
+		for (auto& frame : m_Frames)
+		{
+			vkDestroyQueryPool(m_Device.Device(), frame.QueryPool, nullptr);
+		}
+	}
+
+	void VEGpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+	{
+		if (!IsSupported())
+		{
+			return;
+		}
+
+		m_CurrentFrame = frameIndex;
+
+		FrameQueries& frame = m_Frames[frameIndex];
+
+		CollectResults(frame);
+		frame.Scopes.clear();
+
+		vkCmdResetQueryPool(commandBuffer, frame.QueryPool, 0, MAX_SCOPES_PER_FRAME * 2);
+	}
+
+	void VEGpuProfiler::CollectResults(FrameQueries& frame)
+	{
+		if (frame.Scopes.empty())
+		{
+			return;
+		}
+
+		uint32_t queryCount = static_cast<uint32_t>(frame.Scopes.size()) * 2;
+
+		// Each query is followed by its availability word, nothing here ever waits on the GPU
+		std::vector<uint64_t> results(queryCount * 2);
+
+		vkGetQueryPoolResults(m_Device.Device(),
+			frame.QueryPool,
+			0,
+			queryCount,
+			results.size() * sizeof(uint64_t),
+			results.data(),
+			2 * sizeof(uint64_t),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+
+		uint64_t validMask = m_TimestampValidBits >= 64 ? ~0ull : (1ull << m_TimestampValidBits) - 1;
+
+		for (size_t i = 0; i < frame.Scopes.size(); i++)
+		{
+			const uint64_t* begin = &results[i * 4];
+			const uint64_t* end = &results[i * 4 + 2];
+
+			// A scope whose end was never written, or a frame that was dropped, has nothing to report
+			if (begin[1] == 0 || end[1] == 0)
+			{
+				continue;
+			}
+
+			uint64_t ticks = (end[0] - begin[0]) & validMask;
+			float milliseconds = static_cast<float>(static_cast<double>(ticks) * m_TimestampPeriod / 1000000.0);
+
+			ScopeHistory& history = m_Scopes[frame.Scopes[i]];
+
+			history.Samples[history.NextSample] = milliseconds;
+			history.NextSample = (history.NextSample + 1) % HISTORY_LENGTH;
+			history.SampleCount = std::min(history.SampleCount + 1, HISTORY_LENGTH);
+		}
+	}
+
+	uint32_t VEGpuProfiler::AllocateScope(const char* name)
+	{
+		if (!IsSupported())
+		{
+			return INVALID_SCOPE;
+		}
+
+		FrameQueries& frame = m_Frames[m_CurrentFrame];
+
+		if (frame.Scopes.size() == MAX_SCOPES_PER_FRAME)
+		{
+			return INVALID_SCOPE;
+		}
+
+		auto it = m_ScopeIndices.find(name);
+
+		if (it == m_ScopeIndices.end())
+		{
+			it = m_ScopeIndices.emplace(name, static_cast<uint32_t>(m_Scopes.size())).first;
+
+			m_Scopes.emplace_back();
+			m_Scopes.back().Name = name;
+		}
+
+		frame.Scopes.push_back(it->second);
+
+		return static_cast<uint32_t>(frame.Scopes.size()) - 1;
+	}
+
+	void VEGpuProfiler::WriteBeginTimestamp(VkCommandBuffer commandBuffer, uint32_t scope)
+	{
+		if (scope == INVALID_SCOPE)
+		{
+			return;
+		}
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_Frames[m_CurrentFrame].QueryPool, scope * 2);
+	}
+
+	void VEGpuProfiler::WriteEndTimestamp(VkCommandBuffer commandBuffer, uint32_t scope)
+	{
+		if (scope == INVALID_SCOPE)
+		{
+			return;
+		}
+
+		vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_Frames[m_CurrentFrame].QueryPool, scope * 2 + 1);
+	}
+
+	std::vector<VEGpuScopeStats> VEGpuProfiler::GetStats() const
+	{
+		std::vector<VEGpuScopeStats> stats;
+		stats.reserve(m_Scopes.size());
+
+		for (const auto& history : m_Scopes)
+		{
+			VEGpuScopeStats scopeStats;
+
+			scopeStats.Name			= history.Name;
+			scopeStats.SampleCount	= history.SampleCount;
+
+			if (history.SampleCount > 0)
+			{
+				scopeStats.LastMs	= history.Samples[(history.NextSample + HISTORY_LENGTH - 1) % HISTORY_LENGTH];
+				scopeStats.MinMs	= history.Samples[0];
+				scopeStats.MaxMs	= history.Samples[0];
+
+				float total = 0.0f;
+				for (uint32_t i = 0; i < history.SampleCount; i++)
+				{
+					scopeStats.MinMs = std::min(scopeStats.MinMs, history.Samples[i]);
+					scopeStats.MaxMs = std::max(scopeStats.MaxMs, history.Samples[i]);
+					total += history.Samples[i];
+				}
+
+				scopeStats.AvgMs	= total / history.SampleCount;
+			}
+
+			stats.push_back(scopeStats);
+		}
+
+		return stats;
+	}
+
+	void VEGpuProfiler::PrintStats() const
+	{
+		if (!IsSupported())
+		{
+			return;
+		}
+
+		std::cout << "gpu timings over the last " << HISTORY_LENGTH << " frames (min / avg / max):" << std::endl;
+
+		for (const auto& scopeStats : GetStats())
+		{
+			std::cout << std::fixed << std::setprecision(3)
+				<< "\t" << scopeStats.Name
+				<< ": " << scopeStats.MinMs
+				<< " / " << scopeStats.AvgMs
+				<< " / " << scopeStats.MaxMs << " ms" << std::endl;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+#include "VE_Device.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Rolling GPU time of one named scope over the last HISTORY_LENGTH samples
+	struct VEGpuScopeStats
+	{
+		std::string Name;
+		float LastMs						= 0.0f;
+		float MinMs							= 0.0f;
+		float AvgMs							= 0.0f;
+		float MaxMs							= 0.0f;
+		uint32_t SampleCount				= 0;
+	};
+
+	// Measures GPU time between pairs of timestamps, with one query pool per frame in flight.
+	//
+	// A frame's results are read back the next time its slot comes around, after the renderer has waited
+	// for that frame to retire, so reading them never stalls. Scopes with the same name are merged.
+	class VEGpuProfiler
+	{
+	public:
+		static constexpr uint32_t MAX_SCOPES_PER_FRAME	= 64;
+		static constexpr uint32_t HISTORY_LENGTH		= 120;
+		static constexpr uint32_t INVALID_SCOPE			= ~0u;
+
+		VEGpuProfiler(VEDevice& device, uint32_t framesInFlight);
+		~VEGpuProfiler();
+
+		// Delete the copy constructor and copy operator
+		VEGpuProfiler(const VEGpuProfiler&) = delete;
+		VEGpuProfiler& operator=(const VEGpuProfiler&) = delete;
+
+		// Collects the results frameIndex produced last time and resets its queries, outside any render pass
+		void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+
+		// Reserves a scope in the current frame, returns INVALID_SCOPE when timestamps are unsupported or the
+		// frame is full. Must be called on the thread that drives the frame.
+		uint32_t AllocateScope(const char* name);
+
+		// The two halves of a scope may be written into different command buffers, as long as they execute in order.
+		// Safe to call from any thread for distinct command buffers.
+		void WriteBeginTimestamp(VkCommandBuffer commandBuffer, uint32_t scope);
+		void WriteEndTimestamp(VkCommandBuffer commandBuffer, uint32_t scope);
+
+		uint32_t BeginScope(VkCommandBuffer commandBuffer, const char* name)
+		{
+			uint32_t scope = AllocateScope(name);
+			WriteBeginTimestamp(commandBuffer, scope);
+
+			return scope;
+		}
+
+		void EndScope(VkCommandBuffer commandBuffer, uint32_t scope) { WriteEndTimestamp(commandBuffer, scope); }
+
+		bool IsSupported() const { return m_TimestampValidBits != 0; }
+
+		// In the order the scopes were first seen
+		std::vector<VEGpuScopeStats> GetStats() const;
+		void PrintStats() const;
+
+	private:
+		struct FrameQueries
+		{
+			VkQueryPool QueryPool				= VK_NULL_HANDLE;
+			// Index into m_Scopes for every scope allocated in the frame
+			std::vector<uint32_t> Scopes;
+		};
+
+		struct ScopeHistory
+		{
+			std::string Name;
+			float Samples[HISTORY_LENGTH]		= {};
+			uint32_t SampleCount				= 0;
+			uint32_t NextSample					= 0;
+		};
+
+		void CollectResults(FrameQueries& frame);
+
+	private:
+		VEDevice& m_Device;
+		uint32_t m_TimestampValidBits;
+		float m_TimestampPeriod;	// Nanoseconds per tick
+
+		std::vector<FrameQueries> m_Frames;
+		uint32_t m_CurrentFrame					= 0;
+
+		std::vector<ScopeHistory> m_Scopes;
+		std::unordered_map<std::string, uint32_t> m_ScopeIndices;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "VE_MappedFile.h"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanEngine {
+
+#ifdef _WIN32
+
+	VEMappedFile::VEMappedFile(const std::string& path)
+		: m_Path{ path }
+	{
+		m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (m_File == INVALID_HANDLE_VALUE)
+		{
+			m_File = nullptr;
+			throw std::runtime_error("Failed to open file: " + path);
+		}
+
+		LARGE_INTEGER size;
+		GetFileSizeEx(m_File, &size);
+		m_Size = static_cast<size_t>(size.QuadPart);
+
+		// Mapping an empty file fails, there is nothing to view anyway
+		if (m_Size == 0)
+		{
+			return;
+		}
+
+		m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		m_Data = m_Mapping != nullptr ? MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+
+		if (m_Data == nullptr)
+		{
+			if (m_Mapping != nullptr)
+			{
+				CloseHandle(m_Mapping);
+			}
+
+			CloseHandle(m_File);
+			throw std::runtime_error("Failed to map file: " + path);
+		}
+	}
+
+	VEMappedFile::~VEMappedFile()
+	{
+		if (m_Data != nullptr)
+		{
+			UnmapViewOfFile(m_Data);
+			CloseHandle(m_Mapping);
+		}
+
+		CloseHandle(m_File);
+	}
+
+	bool VEMappedFile::Exists(const std::string& path)
+	{
+		DWORD attributes = GetFileAttributesA(path.c_str());
+		return attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY) == 0;
+	}
+
+#else
+
+	VEMappedFile::VEMappedFile(const std::string& path)
+		: m_Path{ path }
+	{
+		m_File = open(path.c_str(), O_RDONLY);
+
+		if (m_File < 0)
+		{
+			throw std::runtime_error("Failed to open file: " + path);
+		}
+
+		struct stat status;
+		fstat(m_File, &status);
+		m_Size = static_cast<size_t>(status.st_size);
+
+		// Mapping an empty file fails, there is nothing to view anyway
+		if (m_Size == 0)
+		{
+			return;
+		}
+
+		void* data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, m_File, 0);
+
+		if (data == MAP_FAILED)
+		{
+			close(m_File);
+			throw std::runtime_error("Failed to map file: " + path);
+		}
+
+		m_Data = data;
+	}
+
+	VEMappedFile::~VEMappedFile()
+	{
+		if (m_Data != nullptr)
+		{
+			munmap(const_cast<void*>(m_Data), m_Size);
+		}
+
+		close(m_File);
+	}
+
+	bool VEMappedFile::Exists(const std::string& path)
+	{
+		struct stat status;
+		return stat(path.c_str(), &status) == 0 && S_ISREG(status.st_mode);
+	}
+
+#endif
+}
\ No newline at end of file
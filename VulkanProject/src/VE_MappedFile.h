@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace VulkanEngine {
+
+	// Read only view of a whole file through the OS page cache. Nothing is read up front, pages are faulted
+	// in as they are touched, so copying a range out costs no more than the copy itself.
+	class VEMappedFile
+	{
+	public:
+		explicit VEMappedFile(const std::string& path);
+		~VEMappedFile();
+
+		// Delete the copy constructor and copy operator
+		VEMappedFile(const VEMappedFile&) = delete;
+		VEMappedFile& operator=(const VEMappedFile&) = delete;
+
+		const uint8_t* GetData() const { return static_cast<const uint8_t*>(m_Data); }
+		size_t GetSize() const { return m_Size; }
+		const std::string& GetPath() const { return m_Path; }
+
+		static bool Exists(const std::string& path);
+
+	private:
+		std::string m_Path;
+		const void* m_Data = nullptr;
+		size_t m_Size = 0;
+
+#ifdef _WIN32
+		void* m_File = nullptr;
+		void* m_Mapping = nullptr;
+#else
+		int m_File = -1;
+#endif
+	};
+}
\ No newline at end of file
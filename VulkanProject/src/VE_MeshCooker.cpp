@@ -0,0 +1,227 @@
+#include "VE_MeshCooker.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace VulkanEngine {
+
+	namespace {
+
+		// Merges vertices at the same position, so shared corners are stored once
+		class VertexWelder
+		{
+		public:
+			explicit VertexWelder(VEMeshFile::SourceMesh& mesh) : m_Mesh{ mesh } {}
+
+			uint32_t Add(glm::vec2 position)
+			{
+				auto result = m_Indices.emplace(std::make_pair(position.x, position.y), static_cast<uint32_t>(m_Mesh.Vertices.size()));
+
+				if (result.second)
+				{
+					m_Mesh.Vertices.push_back({ position });
+				}
+
+				return result.first->second;
+			}
+
+		private:
+			VEMeshFile::SourceMesh& m_Mesh;
+			std::map<std::pair<float, float>, uint32_t> m_Indices;
+		};
+
+		void AddSierpinski(VertexWelder& welder,
+			std::vector<uint32_t>& indices,
+			uint32_t depth,
+			glm::vec2 top,
+			glm::vec2 right,
+			glm::vec2 left)
+		{
+			if (depth == 0)
+			{
+				indices.push_back(welder.Add(top));
+				indices.push_back(welder.Add(right));
+				indices.push_back(welder.Add(left));
+				return;
+			}
+
+			glm::vec2 leftTop	= 0.5f * (left + top);
+			glm::vec2 rightTop	= 0.5f * (right + top);
+			glm::vec2 leftRight	= 0.5f * (left + right);
+
+			AddSierpinski(welder, indices, depth - 1, leftTop, leftRight, left);
+			AddSierpinski(welder, indices, depth - 1, rightTop, right, leftRight);
+			AddSierpinski(welder, indices, depth - 1, top, rightTop, leftTop);
+		}
+
+		// 1 based, or relative to the end when negative
+		uint32_t ResolveIndex(long index, size_t vertexCount, const std::string& path)
+		{
+			long resolved = index > 0 ? index - 1 : static_cast<long>(vertexCount) + index;
+
+			if (index == 0 || resolved < 0 || resolved >= static_cast<long>(vertexCount))
+			{
+				throw std::runtime_error("Face index out of range in " + path);
+			}
+
+			return static_cast<uint32_t>(resolved);
+		}
+	}
+
+	VEMeshFile::SourceMesh VEMeshCooker::CreateCircle(uint32_t numSides)
+	{
+		VEMeshFile::SourceMesh mesh;
+
+		mesh.Name = "circle_" + std::to_string(numSides);
+
+		for (uint32_t i = 0; i < numSides; i++)
+		{
+			float angle = i * glm::two_pi<float>() / numSides;
+			mesh.Vertices.push_back({ { glm::cos(angle), glm::sin(angle) } });
+		}
+
+		mesh.Vertices.push_back({});  // center vertex at 0, 0
+
+		for (uint32_t i = 0; i < numSides; i++)
+		{
+			mesh.Indices.push_back(i);
+			mesh.Indices.push_back((i + 1) % numSides);
+			mesh.Indices.push_back(numSides);
+		}
+
+		return mesh;
+	}
+
+	VEMeshFile::SourceMesh VEMeshCooker::CreateSierpinski(uint32_t depth)
+	{
+		VEMeshFile::SourceMesh mesh;
+		VertexWelder welder{ mesh };
+
+		mesh.Name = "sierpinski_" + std::to_string(depth);
+
+		AddSierpinski(welder, mesh.Indices, depth, { 0.0f, -0.5f }, { 0.5f, 0.5f }, { -0.5f, 0.5f });
+
+		return mesh;
+	}
+
+	VEMeshFile::SourceMesh VEMeshCooker::LoadTextMesh(const std::string& path)
+	{
+		std::ifstream file{ path };
+
+		if (!file.is_open())
+		{
+			throw std::runtime_error("Failed to open file: " + path);
+		}
+
+		VEMeshFile::SourceMesh mesh;
+
+		// Named after the file, without directories or extension
+		size_t nameStart = path.find_last_of("/\\");
+		nameStart = nameStart == std::string::npos ? 0 : nameStart + 1;
+		mesh.Name = path.substr(nameStart, path.find_last_of('.') > nameStart ? path.find_last_of('.') - nameStart : std::string::npos);
+
+		std::string line;
+
+		while (std::getline(file, line))
+		{
+			std::istringstream stream{ line };
+			std::string statement;
+			stream >> statement;
+
+			if (statement == "v")
+			{
+				VEModel::Vertex vertex = {};
+				float z;
+
+				stream >> vertex.position.x >> vertex.position.y;
+
+				if (stream.fail())
+				{
+					throw std::runtime_error("Malformed vertex in " + path + ": " + line);
+				}
+
+				// Color is optional, white without it
+				if (!(stream >> z >> vertex.color.x >> vertex.color.y >> vertex.color.z))
+				{
+					vertex.color = glm::vec3{ 1.0f };
+				}
+
+				mesh.Vertices.push_back(vertex);
+			}
+			else if (statement == "f")
+			{
+				std::vector<uint32_t> face;
+				std::string corner;
+
+				while (stream >> corner)
+				{
+					face.push_back(ResolveIndex(std::stol(corner.substr(0, corner.find('/'))), mesh.Vertices.size(), path));
+				}
+
+				if (face.size() < 3)
+				{
+					throw std::runtime_error("Face with fewer than 3 corners in " + path + ": " + line);
+				}
+
+				for (size_t i = 1; i + 1 < face.size(); i++)
+				{
+					mesh.Indices.push_back(face[0]);
+					mesh.Indices.push_back(face[i]);
+					mesh.Indices.push_back(face[i + 1]);
+				}
+			}
+		}
+
+		if (mesh.Vertices.empty() || mesh.Indices.empty())
+		{
+			throw std::runtime_error("Text mesh has no faces: " + path);
+		}
+
+		return mesh;
+	}
+
+	std::vector<VEMeshFile::SourceMesh> VEMeshCooker::CreateBuiltinMeshes()
+	{
+		std::vector<VEMeshFile::SourceMesh> meshes;
+
+		for (uint32_t numSides = 8; numSides <= 128; numSides *= 2)
+		{
+			meshes.push_back(CreateCircle(numSides));
+		}
+
+		for (uint32_t depth = 1; depth <= 8; depth++)
+		{
+			meshes.push_back(CreateSierpinski(depth));
+		}
+
+		return meshes;
+	}
+
+	void VEMeshCooker::Cook(const std::string& outputPath, const std::vector<std::string>& textInputs)
+	{
+		std::vector<VEMeshFile::SourceMesh> meshes = CreateBuiltinMeshes();
+
+		for (const auto& input : textInputs)
+		{
+			meshes.push_back(LoadTextMesh(input));
+		}
+
+		VEMeshFile::Write(outputPath, meshes);
+
+		for (const auto& mesh : meshes)
+		{
+			std::cout << "cooked " << mesh.Name << ": " << mesh.Vertices.size() << " vertices, " << mesh.Indices.size() / 3 << " triangles" << std::endl;
+		}
+
+		std::cout << "wrote " << meshes.size() << " meshes to " << outputPath << std::endl;
+	}
+}
\ No newline at end of file
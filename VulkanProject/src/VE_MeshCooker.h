@@ -0,0 +1,30 @@
+#pragma once
+#include "VE_MeshFile.h"
+
+#include <string>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Builds the meshes that go into a VEMeshFile, from the procedural generators or from text files. Runs
+	// offline through --cook, so the application only pays for generating deep meshes when none were cooked.
+	class VEMeshCooker
+	{
+	public:
+		// Triangle fan around a center vertex, with rim vertices on the unit circle
+		static VEMeshFile::SourceMesh CreateCircle(uint32_t numSides);
+		// 3^depth triangles, corners shared between neighbouring triangles are merged
+		static VEMeshFile::SourceMesh CreateSierpinski(uint32_t depth);
+
+		// Reads the OBJ subset: "v x y [z [r g b]]" vertices, z is ignored, and "f a b c ..." faces of 1 based
+		// (or negative, relative) indices, fanned into triangles. Anything after a '/' in a face and every
+		// other statement is skipped. The mesh is named after the file.
+		static VEMeshFile::SourceMesh LoadTextMesh(const std::string& path);
+
+		// Circles of 8 to 128 sides named circle_<sides> and sierpinski_<depth> for depths 1 to 8
+		static std::vector<VEMeshFile::SourceMesh> CreateBuiltinMeshes();
+
+		// Writes the builtin meshes plus one per text file to outputPath
+		static void Cook(const std::string& outputPath, const std::vector<std::string>& textInputs);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "VE_MeshFile.h"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VEMeshFile::MAGIC;
+	constexpr uint32_t VEMeshFile::VERSION;
+	constexpr uint32_t VEMeshFile::NAME_LENGTH;
+	constexpr uint64_t VEMeshFile::DATA_ALIGNMENT;
+	constexpr uint32_t VEMeshFile::INVALID_MESH;
+
+	namespace {
+
+		uint64_t AlignUp(uint64_t value, uint64_t alignment)
+		{
+			return (value + alignment - 1) / alignment * alignment;
+		}
+	}
+
+	VEMeshFile::VEMeshFile(const std::string& path)
+		: m_File{ path }
+	{
+		Header header;
+
+		if (m_File.GetSize() < sizeof(header))
+		{
+			throw std::runtime_error("Mesh file is truncated: " + path);
+		}
+
+		// The mapping is page aligned, but copy the table out anyway rather than rely on the packing
+		memcpy(&header, m_File.GetData(), sizeof(header));
+
+		if (header.Magic != MAGIC)
+		{
+			throw std::runtime_error("Not a mesh file: " + path);
+		}
+
+		if (header.Version != VERSION || header.VertexStride != sizeof(VEModel::PackedVertex))
+		{
+			throw std::runtime_error("Mesh file was cooked for another version or vertex layout, cook it again: " + path);
+		}
+
+		if (m_File.GetSize() < sizeof(Header) + sizeof(Entry) * static_cast<uint64_t>(header.MeshCount))
+		{
+			throw std::runtime_error("Mesh file is truncated: " + path);
+		}
+
+		m_Entries.resize(header.MeshCount);
+		memcpy(m_Entries.data(), m_File.GetData() + sizeof(Header), sizeof(Entry) * header.MeshCount);
+
+		for (auto& entry : m_Entries)
+		{
+			entry.Name[NAME_LENGTH - 1] = '\0';
+
+			uint64_t indexEnd = entry.IndexOffset + static_cast<uint64_t>(entry.IndexSize) * entry.IndexCount;
+			bool validIndexSize = entry.IndexCount == 0 || entry.IndexSize == sizeof(uint16_t) || entry.IndexSize == sizeof(uint32_t);
+
+			if (entry.VertexCount == 0 ||
+				!validIndexSize ||
+				entry.DataOffset % DATA_ALIGNMENT != 0 ||
+				entry.DataOffset + entry.DataSize > m_File.GetSize() ||
+				sizeof(VEModel::PackedVertex) * static_cast<uint64_t>(entry.VertexCount) > entry.IndexOffset ||
+				indexEnd > entry.DataSize)
+			{
+				throw std::runtime_error("Mesh file has a corrupt entry for " + std::string(entry.Name) + ": " + path);
+			}
+		}
+	}
+
+	uint32_t VEMeshFile::FindMesh(const std::string& name) const
+	{
+		for (uint32_t i = 0; i < GetMeshCount(); i++)
+		{
+			if (name == m_Entries[i].Name)
+			{
+				return i;
+			}
+		}
+
+		return INVALID_MESH;
+	}
+
+	VEModel::PackedMesh VEMeshFile::GetPackedMesh(uint32_t mesh) const
+	{
+		const Entry& entry = m_Entries[mesh];
+		VEModel::PackedMesh packedMesh = {};
+
+		packedMesh.Data			= m_File.GetData() + entry.DataOffset;
+		packedMesh.Size			= entry.DataSize;
+		packedMesh.VertexCount	= entry.VertexCount;
+		packedMesh.IndexCount	= entry.IndexCount;
+		packedMesh.IndexType	= entry.IndexSize == sizeof(uint32_t) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+		packedMesh.IndexOffset	= entry.IndexOffset;
+		packedMesh.Bounds		= { { entry.BoundsMin[0], entry.BoundsMin[1] }, { entry.BoundsMax[0], entry.BoundsMax[1] } };
+
+		return packedMesh;
+	}
+
+	std::unique_ptr<VEModel> VEMeshFile::CreateModel(VEDevice& device, uint32_t mesh) const
+	{
+		return std::make_unique<VEModel>(device, GetPackedMesh(mesh));
+	}
+
+	void VEMeshFile::Write(const std::string& path, const std::vector<SourceMesh>& meshes)
+	{
+		Header header = {};
+
+		header.Magic			= MAGIC;
+		header.Version			= VERSION;
+		header.VertexStride		= sizeof(VEModel::PackedVertex);
+		header.MeshCount		= static_cast<uint32_t>(meshes.size());
+
+		std::vector<Entry> entries(meshes.size());
+		std::vector<std::vector<uint8_t>> data(meshes.size());
+		uint64_t offset = AlignUp(sizeof(Header) + sizeof(Entry) * meshes.size(), DATA_ALIGNMENT);
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			if (meshes[i].Name.size() >= NAME_LENGTH)
+			{
+				throw std::runtime_error("Mesh name is too long: " + meshes[i].Name);
+			}
+
+			VEModel::PackedMesh packedMesh = VEModel::Pack(meshes[i].Vertices, meshes[i].Indices, data[i]);
+			Entry& entry = entries[i];
+
+			memset(&entry, 0, sizeof(entry));
+			memcpy(entry.Name, meshes[i].Name.c_str(), meshes[i].Name.size());
+
+			entry.VertexCount	= packedMesh.VertexCount;
+			entry.IndexCount	= packedMesh.IndexCount;
+			entry.IndexSize		= packedMesh.IndexType == VK_INDEX_TYPE_UINT32 ? sizeof(uint32_t) : sizeof(uint16_t);
+			entry.DataOffset	= offset;
+			entry.DataSize		= packedMesh.Size;
+			entry.IndexOffset	= packedMesh.IndexOffset;
+			entry.BoundsMin[0]	= packedMesh.Bounds.Min.x;
+			entry.BoundsMin[1]	= packedMesh.Bounds.Min.y;
+			entry.BoundsMax[0]	= packedMesh.Bounds.Max.x;
+			entry.BoundsMax[1]	= packedMesh.Bounds.Max.y;
+
+			offset = AlignUp(offset + packedMesh.Size, DATA_ALIGNMENT);
+		}
+
+		std::ofstream file{ path, std::ios::binary | std::ios::trunc };
+
+		if (!file.is_open())
+		{
+			throw std::runtime_error("Failed to open file: " + path);
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(entries.data()), sizeof(Entry) * entries.size());
+
+		const char padding[DATA_ALIGNMENT] = {};
+
+		for (size_t i = 0; i < meshes.size(); i++)
+		{
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			file.write(padding, static_cast<std::streamsize>(entries[i].DataOffset - position));
+			file.write(reinterpret_cast<const char*>(data[i].data()), static_cast<std::streamsize>(data[i].size()));
+		}
+
+		if (!file.good())
+		{
+			throw std::runtime_error("Failed to write mesh file: " + path);
+		}
+	}
+}
\ No newline at end of file
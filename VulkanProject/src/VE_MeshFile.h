@@ -0,0 +1,79 @@
+#pragma once
+#include "VE_MappedFile.h"
+#include "VE_Model.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// A set of named meshes cooked into one binary file:
+	//
+	//   Header      magic, version and the vertex layout it was cooked for
+	//   Entry[]     one per mesh, MeshCount of them
+	//   data        per mesh, VEModel::PackedMesh layout starting on a DATA_ALIGNMENT boundary
+	//
+	// Loading maps the file and hands each mesh's data to the uploader as is, nothing is parsed or converted.
+	// Everything is little endian. Files from another version or vertex layout are rejected, cook them again.
+	class VEMeshFile
+	{
+	public:
+		static constexpr uint32_t MAGIC = 0x4D464556;	// "VEFM"
+		static constexpr uint32_t VERSION = 1;
+		static constexpr uint32_t NAME_LENGTH = 32;
+		static constexpr uint64_t DATA_ALIGNMENT = 16;
+		static constexpr uint32_t INVALID_MESH = ~0u;
+
+		struct Header
+		{
+			uint32_t Magic;
+			uint32_t Version;
+			uint32_t VertexStride;	// sizeof(VEModel::PackedVertex)
+			uint32_t MeshCount;
+		};
+
+		struct Entry
+		{
+			char Name[NAME_LENGTH];	// Null terminated
+			uint32_t VertexCount;
+			uint32_t IndexCount;
+			uint32_t IndexSize;		// 2 or 4, matching VK_INDEX_TYPE_UINT16 or UINT32
+			uint32_t Reserved;
+			uint64_t DataOffset;	// From the start of the file
+			uint64_t DataSize;
+			uint64_t IndexOffset;	// From DataOffset
+			float BoundsMin[2];
+			float BoundsMax[2];
+		};
+
+		// A mesh to cook, before packing
+		struct SourceMesh
+		{
+			std::string Name;
+			std::vector<VEModel::Vertex> Vertices;
+			std::vector<uint32_t> Indices;	// Empty draws the vertices in order
+		};
+
+		// Maps path and validates the header and mesh table
+		explicit VEMeshFile(const std::string& path);
+
+		// Delete the copy constructor and copy operator
+		VEMeshFile(const VEMeshFile&) = delete;
+		VEMeshFile& operator=(const VEMeshFile&) = delete;
+
+		uint32_t GetMeshCount() const { return static_cast<uint32_t>(m_Entries.size()); }
+		std::string GetMeshName(uint32_t mesh) const { return m_Entries[mesh].Name; }
+		uint32_t FindMesh(const std::string& name) const;
+
+		// Points into the mapping, valid for as long as the file is
+		VEModel::PackedMesh GetPackedMesh(uint32_t mesh) const;
+		std::unique_ptr<VEModel> CreateModel(VEDevice& device, uint32_t mesh) const;
+
+		static void Write(const std::string& path, const std::vector<SourceMesh>& meshes);
+
+	private:
+		VEMappedFile m_File;
+		std::vector<Entry> m_Entries;
+	};
+}
\ No newline at end of file
@@ -1,41 +1,162 @@
 #include "VE_Model.h"
 
 #include <cassert>
+#include <cstring>
 
 namespace VulkanEngine {
-	VEModel::VEModel(VEDevice& device, const std::vector<Vertex>& vertices)
+	VEModel::VEModel(VEDevice& device, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
 		: m_Device{device}
 	{
-		CreateVertexBuffers(vertices);
+		std::vector<uint8_t> data;
+		CreateVertexBuffers(Pack(vertices, indices, data));
+	}
+
+	VEModel::VEModel(VEDevice& device, const PackedMesh& mesh)
+		: m_Device{ device }
+	{
+		CreateVertexBuffers(mesh);
 	}
 
 	VEModel::~VEModel()
 	{
-		vkDestroyBuffer(m_Device.Device(), m_VertexBuffer, nullptr);
-		vkFreeMemory(m_Device.Device(), m_VertexBufferMemory, nullptr);
+		if (!IsReady())
+		{
+			m_Device.GetUploader().Cancel(m_UploadTicket);
+		}
+
+		m_Device.DestroyBuffer(m_VertexBuffer, m_VertexBufferAllocation);
+	}
+
+	VEModel::PackedMesh VEModel::Pack(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, std::vector<uint8_t>& data)
+	{
+		assert(!vertices.empty() && "Cannot pack a mesh without vertices");
+
+		PackedMesh mesh = {};
+
+		mesh.VertexCount = static_cast<uint32_t>(vertices.size());
+		mesh.IndexCount = static_cast<uint32_t>(indices.size());
+		mesh.IndexType = mesh.VertexCount <= UINT16_MAX + 1u ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+
+		mesh.Bounds = { vertices[0].position, vertices[0].position };
+		for (const auto& vertex : vertices)
+		{
+			mesh.Bounds.Min = glm::min(mesh.Bounds.Min, vertex.position);
+			mesh.Bounds.Max = glm::max(mesh.Bounds.Max, vertex.position);
+		}
+
+		size_t indexSize = mesh.IndexType == VK_INDEX_TYPE_UINT16 ? sizeof(uint16_t) : sizeof(uint32_t);
+
+		// Packed vertices are 8 bytes, so the indices start aligned for either index type
+		mesh.IndexOffset = sizeof(PackedVertex) * mesh.VertexCount;
+		mesh.Size = mesh.IndexOffset + indexSize * mesh.IndexCount;
+
+		data.resize(static_cast<size_t>(mesh.Size));
+		mesh.Data = data.data();
+
+		// Quantize against the bounds so every model gets the full 16 bits of precision, whatever its size
+		glm::vec2 offset = mesh.Bounds.Center();
+		glm::vec2 scale = QuantizationScale(mesh.Bounds);
+		PackedVertex* packedVertices = reinterpret_cast<PackedVertex*>(data.data());
+
+		for (uint32_t i = 0; i < mesh.VertexCount; i++)
+		{
+			packedVertices[i].position = glm::packSnorm2x16((vertices[i].position - offset) / scale);
+			packedVertices[i].color = glm::packUnorm4x8(glm::vec4(vertices[i].color, 1.0f));
+		}
+
+		for (uint32_t i = 0; i < mesh.IndexCount; i++)
+		{
+			assert(indices[i] < mesh.VertexCount && "Index out of range");
+
+			uint8_t* destination = data.data() + mesh.IndexOffset + i * indexSize;
+
+			if (mesh.IndexType == VK_INDEX_TYPE_UINT16)
+			{
+				uint16_t index = static_cast<uint16_t>(indices[i]);
+				memcpy(destination, &index, sizeof(index));
+			}
+			else
+			{
+				memcpy(destination, &indices[i], sizeof(uint32_t));
+			}
+		}
+
+		return mesh;
+	}
+
+	glm::vec2 VEModel::QuantizationScale(const VEBounds2D& bounds)
+	{
+		glm::vec2 scale = bounds.HalfExtent();
+
+		// A flat axis has nothing to quantize, any scale decodes it to the center
+		for (int axis = 0; axis < 2; axis++)
+		{
+			if (scale[axis] <= 0.0f)
+			{
+				scale[axis] = 1.0f;
+			}
+		}
+
+		return scale;
 	}
 
-	void VEModel::CreateVertexBuffers(const std::vector<Vertex>& vertices)
+	void VEModel::CreateVertexBuffers(const PackedMesh& mesh)
 	{
-		m_VertexCount = static_cast<uint32_t>(vertices.size());
-		assert(m_VertexCount >= 3 && "Vertex count must be atleast 3.");
+		m_VertexCount = mesh.VertexCount;
+		m_IndexCount = mesh.IndexCount;
+		m_IndexType = mesh.IndexType;
+		m_IndexOffset = mesh.IndexOffset;
+		assert((m_IndexCount > 0 ? m_IndexCount : m_VertexCount) >= 3 && "Vertex count must be atleast 3.");
 
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * m_VertexCount;
-		m_Device.CreateBuffer(bufferSize,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		m_Bounds = mesh.Bounds;
+		m_PositionOffset = m_Bounds.Center();
+		m_PositionScale = QuantizationScale(m_Bounds);
+
+		VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+		VkAccessFlags dstAccess = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT;
+
+		if (m_IndexCount > 0)
+		{
+			usage |= VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+			dstAccess |= VK_ACCESS_INDEX_READ_BIT;
+		}
+
+		m_Device.CreateBuffer(mesh.Size,
+			usage,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 			m_VertexBuffer,
-			m_VertexBufferMemory);
+			m_VertexBufferAllocation);
+
+		// The uploader copies into staging right away, so mesh.Data only has to live until this returns
+		m_UploadTicket = m_Device.GetUploader().UploadBuffer(m_VertexBuffer,
+			0,
+			mesh.Data,
+			mesh.Size,
+			VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			dstAccess);
+	}
+
+	bool VEModel::IsReady() const
+	{
+		// Once ready it stays ready, skip the uploader's lock from then on
+		if (!m_Ready.load(std::memory_order_relaxed) && m_Device.GetUploader().IsReady(m_UploadTicket))
+		{
+			m_Ready.store(true, std::memory_order_relaxed);
+		}
 
-		void* data;
-		vkMapMemory(m_Device.Device(), m_VertexBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), static_cast<size_t>(bufferSize));
-		vkUnmapMemory(m_Device.Device(), m_VertexBufferMemory);
+		return m_Ready.load(std::memory_order_relaxed);
 	}
 
 	void VEModel::Draw(VkCommandBuffer commandBuffer)
 	{
-		vkCmdDraw(commandBuffer, m_VertexCount, 1, 0, 0);
+		if (m_IndexCount > 0)
+		{
+			vkCmdDrawIndexed(commandBuffer, m_IndexCount, 1, 0, 0, 0);
+		}
+		else
+		{
+			vkCmdDraw(commandBuffer, m_VertexCount, 1, 0, 0);
+		}
 	}
 
 	void VEModel::Bind(VkCommandBuffer commandBuffer)
@@ -44,30 +165,35 @@ namespace VulkanEngine {
 		VkDeviceSize offsets[]				= { 0 };
 
 		vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+		if (m_IndexCount > 0)
+		{
+			vkCmdBindIndexBuffer(commandBuffer, m_VertexBuffer, m_IndexOffset, m_IndexType);
+		}
 	}
-	std::vector<VkVertexInputBindingDescription> VEModel::Vertex::GetBindingDescriptions()
+	std::vector<VkVertexInputBindingDescription> VEModel::PackedVertex::GetBindingDescriptions()
 	{
 		std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
 
 		bindingDescriptions[0].binding		= 0;
-		bindingDescriptions[0].stride		= sizeof(Vertex);
+		bindingDescriptions[0].stride		= sizeof(PackedVertex);
 		bindingDescriptions[0].inputRate	= VK_VERTEX_INPUT_RATE_VERTEX;
 
 		return bindingDescriptions;
 	}
-	std::vector<VkVertexInputAttributeDescription> VEModel::Vertex::GetAttributeDescriptions()
+	std::vector<VkVertexInputAttributeDescription> VEModel::PackedVertex::GetAttributeDescriptions()
 	{
 		std::vector<VkVertexInputAttributeDescription> attributeDescriptions(2);
 
 		attributeDescriptions[0].binding	= 0;
 		attributeDescriptions[0].location	= 0;
-		attributeDescriptions[0].format		= VK_FORMAT_R32G32_SFLOAT;
-		attributeDescriptions[0].offset		= offsetof(Vertex, position);
+		attributeDescriptions[0].format		= VK_FORMAT_R16G16_SNORM;
+		attributeDescriptions[0].offset		= offsetof(PackedVertex, position);
 
 		attributeDescriptions[1].binding	= 0;
 		attributeDescriptions[1].location	= 1;
-		attributeDescriptions[1].format		= VK_FORMAT_R32G32B32_SFLOAT;
-		attributeDescriptions[1].offset		= offsetof(Vertex, color);
+		attributeDescriptions[1].format		= VK_FORMAT_R8G8B8A8_UNORM;
+		attributeDescriptions[1].offset		= offsetof(PackedVertex, color);
 
 		return attributeDescriptions;
 	}
@@ -1,10 +1,14 @@
 #pragma once
+#include "VE_Bounds2D.h"
 #include "VE_Device.h"
+#include "VE_Uploader.h"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 namespace VulkanEngine {
@@ -12,16 +16,43 @@ namespace VulkanEngine {
 	class VEModel
 	{
 	public:
+		// What models are built from, packed into a PackedVertex on upload
 		struct Vertex
 		{
 			glm::vec2 position;
 			glm::vec3 color;
+		};
+
+		// What the vertex buffer holds, 8 bytes instead of the 20 of a Vertex. The default pipeline config
+		// describes this layout and the vertex fetch unpacks it, so shaders still read a vec2 and a vec3.
+		struct PackedVertex
+		{
+			uint32_t position;	// R16G16_SNORM, spanning the model bounds, see GetPositionScale
+			uint32_t color;		// R8G8B8A8_UNORM, red in the lowest byte
 
 			static std::vector<VkVertexInputBindingDescription> GetBindingDescriptions();
 			static std::vector<VkVertexInputAttributeDescription> GetAttributeDescriptions();
 		};
 
-		VEModel(VEDevice& device, const std::vector<Vertex>& vertices);
+		// Packed vertices followed by indices, laid out exactly as the vertex buffer holds them so it is
+		// filled with a single copy, e.g. straight out of a memory mapped VEMeshFile
+		struct PackedMesh
+		{
+			const void* Data			= nullptr;
+			VkDeviceSize Size			= 0;
+			uint32_t VertexCount		= 0;
+			uint32_t IndexCount			= 0;	// 0 draws the vertices in order
+			VkIndexType IndexType		= VK_INDEX_TYPE_UINT16;
+			VkDeviceSize IndexOffset	= 0;	// From Data, a multiple of the index size
+			VEBounds2D Bounds;					// The positions are quantized against these
+		};
+
+		// Writes vertices and indices to data in the PackedMesh layout, with 16 bit indices when every vertex
+		// fits. The result points into data.
+		static PackedMesh Pack(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, std::vector<uint8_t>& data);
+
+		VEModel(VEDevice& device, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices = {});
+		VEModel(VEDevice& device, const PackedMesh& mesh);
 		~VEModel();
 
 		// Delete the copy constructor and copy operator
@@ -31,13 +62,37 @@ namespace VulkanEngine {
 		void Bind(VkCommandBuffer commandBuffer);
 		void Draw(VkCommandBuffer commandBuffer);
 
+		// False until the vertex upload has reached the graphics queue, unready models are skipped when drawing
+		bool IsReady() const;
+
+		uint32_t GetVertexCount() const { return m_VertexCount; }
+		uint32_t GetIndexCount() const { return m_IndexCount; }
+
+		// Model space box around every vertex
+		const VEBounds2D& GetBounds() const { return m_Bounds; }
+
+		// A packed position p is at GetPositionOffset() + p * GetPositionScale() in model space, fold this
+		// into the transform when drawing
+		glm::vec2 GetPositionOffset() const { return m_PositionOffset; }
+		glm::vec2 GetPositionScale() const { return m_PositionScale; }
+
 	private:
-		void CreateVertexBuffers(const std::vector<Vertex>& vertices);
+		void CreateVertexBuffers(const PackedMesh& mesh);
+		// Half extent of the bounds, with flat axes set to 1
+		static glm::vec2 QuantizationScale(const VEBounds2D& bounds);
 
 	private:
 		VEDevice& m_Device;
-		VkBuffer m_VertexBuffer;
-		VkDeviceMemory m_VertexBufferMemory;
+		VkBuffer m_VertexBuffer;			// Indices follow the vertices at m_IndexOffset
+		VEAllocation m_VertexBufferAllocation;
 		uint32_t m_VertexCount;
+		uint32_t m_IndexCount = 0;
+		VkIndexType m_IndexType = VK_INDEX_TYPE_UINT16;
+		VkDeviceSize m_IndexOffset = 0;
+		VEBounds2D m_Bounds;
+		glm::vec2 m_PositionOffset{ 0.0f };
+		glm::vec2 m_PositionScale{ 1.0f };
+		VEUploadTicket m_UploadTicket;
+		mutable std::atomic<bool> m_Ready{ false };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,37 @@
+#include "VE_ModelLod.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace VulkanEngine {
+
+	constexpr float VEModelLodChain::HYSTERESIS;
+
+	void VEModelLodChain::AddLevel(std::shared_ptr<VEModel> model, float maxPixelRadius)
+	{
+		assert((m_Levels.empty() || maxPixelRadius > m_Levels.back().MaxPixelRadius) && "Levels have to be added coarsest first");
+
+		m_Levels.push_back({ std::move(model), maxPixelRadius });
+	}
+
+	uint32_t VEModelLodChain::SelectLevel(float pixelRadius, uint32_t currentLevel) const
+	{
+		assert(!m_Levels.empty() && "Cannot select from an empty chain");
+
+		uint32_t level = std::min(currentLevel, GetLevelCount() - 1);
+
+		// Refine while the object has outgrown the current level, by more than the margin
+		while (level + 1 < GetLevelCount() && pixelRadius > m_Levels[level].MaxPixelRadius * (1.0f + HYSTERESIS))
+		{
+			level++;
+		}
+
+		// Coarsen while the next coarser level would do, with the margin to spare
+		while (level > 0 && pixelRadius < m_Levels[level - 1].MaxPixelRadius * (1.0f - HYSTERESIS))
+		{
+			level--;
+		}
+
+		return level;
+	}
+}
\ No newline at end of file
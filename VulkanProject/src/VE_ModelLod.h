@@ -0,0 +1,35 @@
+#pragma once
+#include "VE_Model.h"
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// The same shape at increasing levels of detail, picked per object from the radius it covers on screen.
+	// Levels are added coarsest first, each with the largest radius in pixels it still looks right at.
+	class VEModelLodChain
+	{
+	public:
+		// A level is kept until the radius leaves its range by this fraction, so objects hovering around a
+		// threshold do not flip between levels every frame
+		static constexpr float HYSTERESIS = 0.15f;
+
+		void AddLevel(std::shared_ptr<VEModel> model, float maxPixelRadius);
+
+		// currentLevel is the level the object was drawn with last time
+		uint32_t SelectLevel(float pixelRadius, uint32_t currentLevel) const;
+
+		const std::shared_ptr<VEModel>& GetModel(uint32_t level) const { return m_Levels[level].Model; }
+		uint32_t GetLevelCount() const { return static_cast<uint32_t>(m_Levels.size()); }
+
+	private:
+		struct Level
+		{
+			std::shared_ptr<VEModel> Model;
+			float MaxPixelRadius;
+		};
+
+		std::vector<Level> m_Levels;
+	};
+}
\ No newline at end of file
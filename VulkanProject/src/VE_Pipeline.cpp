@@ -2,19 +2,19 @@
 #include"VE_Model.h"
 
 #include <cassert>
-#include <fstream>
+#include <chrono>
 #include <iostream>
 #include <stdexcept>
 
 namespace VulkanEngine {
 	
 	VEPipeline::VEPipeline(VEDevice& device,
-		const std::string& vertShaderPath,
-		const std::string& fragShaderPath,
+		const std::string& vertShaderName,
+		const std::string& fragShaderName,
 		const PipelineConfigInfo& configInfo)
 		: m_Device{ device }
 	{
-		CreateGraphicsPipeline(vertShaderPath, fragShaderPath, configInfo);
+		CreateGraphicsPipeline(vertShaderName, fragShaderName, configInfo);
 	}
 
 	VEPipeline::~VEPipeline()
@@ -24,37 +24,15 @@ namespace VulkanEngine {
 		vkDestroyPipeline(m_Device.Device(), m_GraphicsPipeline, nullptr);
 	}
 
-	std::vector<char> VEPipeline::ReadFile(const std::string& filepath)
-	{
-		// Read the file in as binary information and set a cursor at the end of the file
-		std::ifstream file(filepath, std::ios::ate | std::ios::binary);
-
-		if (!file.is_open())
-		{
-			throw std::runtime_error("Failed to open file: " + filepath);
-		}
-
-		// Get the size of the file from the location of the cursor
-		size_t fileSize = static_cast<size_t>(file.tellg());
-		std::vector<char> buffer(fileSize);
-
-		// Move the cursor to the begining of the file and read its contents into the buffer
-		file.seekg(0);
-		file.read(buffer.data(), fileSize);
-
-		file.close();
-		return buffer;
-	}
-
-	void VEPipeline::CreateGraphicsPipeline(const std::string& vertShaderPath,
-		const std::string& fragShaderPath,
+	void VEPipeline::CreateGraphicsPipeline(const std::string& vertShaderName,
+		const std::string& fragShaderName,
 		const PipelineConfigInfo& configInfo)
 	{
 		assert(configInfo.PipelineLayout != VK_NULL_HANDLE && "Cannot create graphics pipeline:: there is no PipelineLayout in configInfo");
 		assert(configInfo.RenderPass != VK_NULL_HANDLE && "Cannot create graphics pipeline:: there is no RenderPass in configInfo");
 
-		auto vertShader = ReadFile(vertShaderPath);
-		auto fragShader = ReadFile(fragShaderPath);
+		VEShaderCode vertShader = m_Device.GetShaderLibrary().Load(vertShaderName);
+		VEShaderCode fragShader = m_Device.GetShaderLibrary().Load(fragShaderName);
 
 		CreateShaderModule(vertShader, &m_VertShaderModule);
 		CreateShaderModule(fragShader, &m_FragShaderModule);
@@ -77,8 +55,8 @@ namespace VulkanEngine {
 		shaderStages[1].pNext									= nullptr;
 		shaderStages[1].pSpecializationInfo						= nullptr;
 
-		auto bindingDescriptions = VEModel::Vertex::GetBindingDescriptions();
-		auto attributeDescriptions = VEModel::Vertex::GetAttributeDescriptions();
+		auto& bindingDescriptions = configInfo.BindingDescriptions;
+		auto& attributeDescriptions = configInfo.AttributeDescriptions;
 
 		VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 
@@ -109,21 +87,51 @@ namespace VulkanEngine {
 		pipelineInfo.basePipelineIndex							= -1;
 		pipelineInfo.basePipelineHandle							= VK_NULL_HANDLE;
 
-		if (vkCreateGraphicsPipelines(m_Device.Device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
+		// Ask the driver whether the pipeline came out of the cache, when it can tell us
+		VkPipelineCreationFeedbackEXT pipelineFeedback = {};
+		VkPipelineCreationFeedbackEXT stageFeedbacks[2] = {};
+		VkPipelineCreationFeedbackCreateInfoEXT feedbackInfo = {};
+
+		feedbackInfo.sType										= VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO_EXT;
+		feedbackInfo.pPipelineCreationFeedback					= &pipelineFeedback;
+		feedbackInfo.pipelineStageCreationFeedbackCount			= pipelineInfo.stageCount;
+		feedbackInfo.pPipelineStageCreationFeedbacks			= stageFeedbacks;
+
+		if (m_Device.SupportsPipelineCreationFeedback())
+		{
+			pipelineInfo.pNext									= &feedbackInfo;
+		}
+
+		auto startTime = std::chrono::high_resolution_clock::now();
+
+		if (vkCreateGraphicsPipelines(m_Device.Device(), m_Device.PipelineCache(), 1, &pipelineInfo, nullptr, &m_GraphicsPipeline) != VK_SUCCESS)
 		{
 			throw std::runtime_error("Failed to create the graphics pipeline");
 		}
 
+		auto endTime = std::chrono::high_resolution_clock::now();
+		double milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+		if (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT_EXT)
+		{
+			bool cacheHit = (pipelineFeedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT_EXT) != 0;
+			std::cout << "Pipeline " << vertShaderName << " created in " << pipelineFeedback.duration / 1.0e6 << " ms ("
+				<< (cacheHit ? "cache hit" : "cache miss") << ")" << std::endl;
+		}
+		else
+		{
+			std::cout << "Pipeline " << vertShaderName << " created in " << milliseconds << " ms" << std::endl;
+		}
 	}
 
-	void VEPipeline::CreateShaderModule(const std::vector<char>& shader, VkShaderModule* shaderModule)
+	void VEPipeline::CreateShaderModule(const VEShaderCode& shader, VkShaderModule* shaderModule)
 	{
 		VkShaderModuleCreateInfo info = {};
 
+		// Straight from the executable or the file mapping, without a copy
 		info.sType												= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		info.codeSize											= shader.size();
-		// Vulkan expects the info to be a uint32
-		info.pCode												= reinterpret_cast<const uint32_t*>(shader.data());
+		info.codeSize											= shader.Size;
+		info.pCode												= shader.Code;
 
 		if (vkCreateShaderModule(m_Device.Device(), &info, nullptr, shaderModule) != VK_SUCCESS)
 		{
@@ -207,5 +215,81 @@ namespace VulkanEngine {
 		configInfo.DynamicStateInfo.dynamicStateCount			= static_cast<uint32_t>(configInfo.DynamicStateEnables.size());
 		configInfo.DynamicStateInfo.flags						= 0;
 
+		configInfo.BindingDescriptions							= VEModel::PackedVertex::GetBindingDescriptions();
+		configInfo.AttributeDescriptions						= VEModel::PackedVertex::GetAttributeDescriptions();
+
+	}
+
+	void VEPipeline::CopyPipelineConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& destination)
+	{
+		destination.ViewportInfo								= source.ViewportInfo;
+		destination.InputAssemblyInfo							= source.InputAssemblyInfo;
+		destination.RasterizationInfo							= source.RasterizationInfo;
+		destination.MultisampleInfo								= source.MultisampleInfo;
+		destination.ColorBlendAttachment						= source.ColorBlendAttachment;
+		destination.ColorBlendInfo								= source.ColorBlendInfo;
+		destination.DepthStencilInfo							= source.DepthStencilInfo;
+		destination.DynamicStateEnables							= source.DynamicStateEnables;
+		destination.DynamicStateInfo							= source.DynamicStateInfo;
+		destination.BindingDescriptions							= source.BindingDescriptions;
+		destination.AttributeDescriptions						= source.AttributeDescriptions;
+		destination.PipelineLayout								= source.PipelineLayout;
+		destination.RenderPass									= source.RenderPass;
+		destination.Subpass										= source.Subpass;
+
+		// Re-point the internal pointers at the destination's own storage
+		destination.ColorBlendInfo.pAttachments					= &destination.ColorBlendAttachment;
+		destination.DynamicStateInfo.pDynamicStates				= destination.DynamicStateEnables.data();
+		destination.DynamicStateInfo.dynamicStateCount			= static_cast<uint32_t>(destination.DynamicStateEnables.size());
+	}
+
+	VEComputePipeline::VEComputePipeline(VEDevice& device,
+		const std::string& compShaderName,
+		VkPipelineLayout pipelineLayout,
+		const VkSpecializationInfo* specializationInfo)
+		: m_Device{ device }
+	{
+		assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline:: there is no PipelineLayout");
+
+		VEShaderCode compShader = m_Device.GetShaderLibrary().Load(compShaderName);
+
+		VkShaderModuleCreateInfo moduleInfo = {};
+
+		moduleInfo.sType										= VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		moduleInfo.codeSize										= compShader.Size;
+		moduleInfo.pCode										= compShader.Code;
+
+		if (vkCreateShaderModule(m_Device.Device(), &moduleInfo, nullptr, &m_CompShaderModule) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create shader module.");
+		}
+
+		VkComputePipelineCreateInfo pipelineInfo = {};
+
+		pipelineInfo.sType										= VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType								= VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage								= VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module								= m_CompShaderModule;
+		pipelineInfo.stage.pName								= "main";
+		pipelineInfo.stage.pSpecializationInfo					= specializationInfo;
+		pipelineInfo.layout										= pipelineLayout;
+		pipelineInfo.basePipelineIndex							= -1;
+		pipelineInfo.basePipelineHandle							= VK_NULL_HANDLE;
+
+		if (vkCreateComputePipelines(m_Device.Device(), m_Device.PipelineCache(), 1, &pipelineInfo, nullptr, &m_ComputePipeline) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create the compute pipeline");
+		}
+	}
+
+	VEComputePipeline::~VEComputePipeline()
+	{
+		vkDestroyShaderModule(m_Device.Device(), m_CompShaderModule, nullptr);
+		vkDestroyPipeline(m_Device.Device(), m_ComputePipeline, nullptr);
+	}
+
+	void VEComputePipeline::Bind(VkCommandBuffer commandBuffer)
+	{
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_ComputePipeline);
 	}
 }
\ No newline at end of file
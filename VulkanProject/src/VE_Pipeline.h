@@ -20,6 +20,8 @@ namespace VulkanEngine {
 		VkPipelineDepthStencilStateCreateInfo DepthStencilInfo;
 		std::vector<VkDynamicState> DynamicStateEnables;
 		VkPipelineDynamicStateCreateInfo DynamicStateInfo;
+		std::vector<VkVertexInputBindingDescription> BindingDescriptions;
+		std::vector<VkVertexInputAttributeDescription> AttributeDescriptions;
 		VkPipelineLayout PipelineLayout		= nullptr;
 		VkRenderPass RenderPass				= nullptr;
 		uint32_t Subpass					= 0;
@@ -28,9 +30,10 @@ namespace VulkanEngine {
 	class VEPipeline
 	{
 	public:
+		// Shaders are named by source file, e.g. "Simple_Shader.vert", and come from VEDevice::GetShaderLibrary
 		VEPipeline(VEDevice& device,
-			const std::string& vertShaderPath,
-			const std::string& fragShaderPath,
+			const std::string& vertShaderName,
+			const std::string& fragShaderName,
 			const PipelineConfigInfo& configInfo);
 		~VEPipeline();
 
@@ -40,15 +43,15 @@ namespace VulkanEngine {
 		void Bind(VkCommandBuffer commandBuffer);
 
 		static void DefaultPipelineConfigInfo(PipelineConfigInfo& configInfo);
+		// PipelineConfigInfo points into itself, so a plain memberwise copy would leave dangling pointers
+		static void CopyPipelineConfigInfo(const PipelineConfigInfo& source, PipelineConfigInfo& destination);
 
 	private:
-		static std::vector<char> ReadFile(const std::string& filepath);
-
-		void CreateGraphicsPipeline(const std::string& vertShaderPath,
-			const std::string& fragShaderPath,
+		void CreateGraphicsPipeline(const std::string& vertShaderName,
+			const std::string& fragShaderName,
 			const PipelineConfigInfo& configInfo);
 
-		void CreateShaderModule(const std::vector<char>& shader, VkShaderModule* shaderModule);
+		void CreateShaderModule(const VEShaderCode& shader, VkShaderModule* shaderModule);
 
 	private:
 		VEDevice& m_Device;
@@ -56,6 +59,25 @@ namespace VulkanEngine {
 		VkShaderModule m_VertShaderModule;
 		VkShaderModule m_FragShaderModule;
 	};
-}
 
+	class VEComputePipeline
+	{
+	public:
+		// specializationInfo lets one shader file provide several pipelines, it is only read during construction
+		VEComputePipeline(VEDevice& device,
+			const std::string& compShaderName,
+			VkPipelineLayout pipelineLayout,
+			const VkSpecializationInfo* specializationInfo = nullptr);
+		~VEComputePipeline();
 
+		VEComputePipeline(const VEComputePipeline&) = delete;
+		VEComputePipeline& operator=(const VEComputePipeline&) = delete;
+
+		void Bind(VkCommandBuffer commandBuffer);
+
+	private:
+		VEDevice& m_Device;
+		VkPipeline m_ComputePipeline;
+		VkShaderModule m_CompShaderModule;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "VE_PipelineCompiler.h"
+#include "VE_Profiler.h"
+
+#include <functional>
+#include <iostream>
+
+namespace VulkanEngine {
+
+	namespace {
+
+		template<typename T>
+		void HashCombine(size_t& seed, const T& value)
+		{
+			seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+		}
+	}
+
+	VEPipelineCompiler::VEPipelineCompiler(VEDevice& device, uint32_t threadCount)
+		: m_Device{ device }, m_ThreadPool{ threadCount }
+	{
+	}
+
+	VEPipelineCompiler::~VEPipelineCompiler()
+	{
+		WaitIdle();
+	}
+
+	VEPipelineHandle VEPipelineCompiler::Compile(const std::string& vertShaderName,
+		const std::string& fragShaderName,
+		const PipelineConfigInfo& configInfo)
+	{
+		size_t hash = HashPipeline(vertShaderName, fragShaderName, configInfo);
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		auto it = m_Pipelines.find(hash);
+		if (it != m_Pipelines.end())
+		{
+			return VEPipelineHandle{ it->second };
+		}
+
+		// The caller's config usually lives on its stack, so the worker gets its own copy
+		std::shared_ptr<PipelineConfigInfo> config(new PipelineConfigInfo{});
+		VEPipeline::CopyPipelineConfigInfo(configInfo, *config);
+
+		VEDevice& device = m_Device;
+		std::shared_future<std::shared_ptr<VEPipeline>> future = m_ThreadPool.Submit([&device, vertShaderName, fragShaderName, config]()
+		{
+			VE_PROFILE_SCOPE("Compile pipeline");
+			return std::make_shared<VEPipeline>(device, vertShaderName, fragShaderName, *config);
+		}).share();
+
+		m_Pipelines.emplace(hash, future);
+		return VEPipelineHandle{ future };
+	}
+
+	void VEPipelineCompiler::WaitIdle()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto& pipeline : m_Pipelines)
+		{
+			pipeline.second.wait();
+		}
+	}
+
+	size_t VEPipelineCompiler::HashPipeline(const std::string& vertShaderName,
+		const std::string& fragShaderName,
+		const PipelineConfigInfo& configInfo)
+	{
+		size_t seed = 0;
+
+		HashCombine(seed, vertShaderName);
+		HashCombine(seed, fragShaderName);
+
+		// Only the state that reaches vkCreateGraphicsPipelines, the pointers inside the config are not stable
+		HashCombine(seed, configInfo.InputAssemblyInfo.topology);
+		HashCombine(seed, configInfo.InputAssemblyInfo.primitiveRestartEnable);
+
+		HashCombine(seed, configInfo.ViewportInfo.viewportCount);
+		HashCombine(seed, configInfo.ViewportInfo.scissorCount);
+
+		HashCombine(seed, configInfo.RasterizationInfo.depthClampEnable);
+		HashCombine(seed, configInfo.RasterizationInfo.rasterizerDiscardEnable);
+		HashCombine(seed, configInfo.RasterizationInfo.polygonMode);
+		HashCombine(seed, configInfo.RasterizationInfo.lineWidth);
+		HashCombine(seed, configInfo.RasterizationInfo.cullMode);
+		HashCombine(seed, configInfo.RasterizationInfo.frontFace);
+		HashCombine(seed, configInfo.RasterizationInfo.depthBiasEnable);
+		HashCombine(seed, configInfo.RasterizationInfo.depthBiasConstantFactor);
+		HashCombine(seed, configInfo.RasterizationInfo.depthBiasClamp);
+		HashCombine(seed, configInfo.RasterizationInfo.depthBiasSlopeFactor);
+
+		HashCombine(seed, configInfo.MultisampleInfo.rasterizationSamples);
+		HashCombine(seed, configInfo.MultisampleInfo.sampleShadingEnable);
+		HashCombine(seed, configInfo.MultisampleInfo.minSampleShading);
+		HashCombine(seed, configInfo.MultisampleInfo.alphaToCoverageEnable);
+		HashCombine(seed, configInfo.MultisampleInfo.alphaToOneEnable);
+
+		HashCombine(seed, configInfo.ColorBlendAttachment.blendEnable);
+		HashCombine(seed, configInfo.ColorBlendAttachment.srcColorBlendFactor);
+		HashCombine(seed, configInfo.ColorBlendAttachment.dstColorBlendFactor);
+		HashCombine(seed, configInfo.ColorBlendAttachment.colorBlendOp);
+		HashCombine(seed, configInfo.ColorBlendAttachment.srcAlphaBlendFactor);
+		HashCombine(seed, configInfo.ColorBlendAttachment.dstAlphaBlendFactor);
+		HashCombine(seed, configInfo.ColorBlendAttachment.alphaBlendOp);
+		HashCombine(seed, configInfo.ColorBlendAttachment.colorWriteMask);
+
+		HashCombine(seed, configInfo.ColorBlendInfo.logicOpEnable);
+		HashCombine(seed, configInfo.ColorBlendInfo.logicOp);
+		HashCombine(seed, configInfo.ColorBlendInfo.attachmentCount);
+		for (float constant : configInfo.ColorBlendInfo.blendConstants)
+		{
+			HashCombine(seed, constant);
+		}
+
+		HashCombine(seed, configInfo.DepthStencilInfo.depthTestEnable);
+		HashCombine(seed, configInfo.DepthStencilInfo.depthWriteEnable);
+		HashCombine(seed, configInfo.DepthStencilInfo.depthCompareOp);
+		HashCombine(seed, configInfo.DepthStencilInfo.depthBoundsTestEnable);
+		HashCombine(seed, configInfo.DepthStencilInfo.stencilTestEnable);
+		HashCombine(seed, configInfo.DepthStencilInfo.minDepthBounds);
+		HashCombine(seed, configInfo.DepthStencilInfo.maxDepthBounds);
+
+		for (VkDynamicState state : configInfo.DynamicStateEnables)
+		{
+			HashCombine(seed, state);
+		}
+
+		for (const auto& binding : configInfo.BindingDescriptions)
+		{
+			HashCombine(seed, binding.binding);
+			HashCombine(seed, binding.stride);
+			HashCombine(seed, binding.inputRate);
+		}
+
+		for (const auto& attribute : configInfo.AttributeDescriptions)
+		{
+			HashCombine(seed, attribute.location);
+			HashCombine(seed, attribute.binding);
+			HashCombine(seed, attribute.format);
+			HashCombine(seed, attribute.offset);
+		}
+
+		HashCombine(seed, configInfo.PipelineLayout);
+		HashCombine(seed, configInfo.RenderPass);
+		HashCombine(seed, configInfo.Subpass);
+
+		return seed;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+#include "VE_Device.h"
+#include "VE_Pipeline.h"
+#include "VE_ThreadPool.h"
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace VulkanEngine {
+
+	// Reference to a pipeline that may still be compiling on a worker thread
+	class VEPipelineHandle
+	{
+	public:
+		VEPipelineHandle() = default;
+		explicit VEPipelineHandle(std::shared_future<std::shared_ptr<VEPipeline>> future) : m_Future{ future } {}
+
+		bool IsValid() const { return m_Future.valid(); }
+		bool IsReady() const { return m_Future.valid() && m_Future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+		// Returns nullptr while the pipeline is still compiling, rethrows if compilation failed
+		VEPipeline* Get() const { return IsReady() ? m_Future.get().get() : nullptr; }
+
+		// Blocks until compilation has finished, successfully or not
+		void Wait() const { m_Future.wait(); }
+
+	private:
+		std::shared_future<std::shared_ptr<VEPipeline>> m_Future;
+	};
+
+	// Compiles pipelines on a thread pool so render systems can be created without stalling the frame loop.
+	// Requests with the same shaders and PipelineConfigInfo share a single pipeline.
+	class VEPipelineCompiler
+	{
+	public:
+		VEPipelineCompiler(VEDevice& device, uint32_t threadCount = 0);
+		~VEPipelineCompiler();
+
+		// Delete the copy constructor and copy operator
+		VEPipelineCompiler(const VEPipelineCompiler&) = delete;
+		VEPipelineCompiler& operator=(const VEPipelineCompiler&) = delete;
+
+		VEPipelineHandle Compile(const std::string& vertShaderName,
+			const std::string& fragShaderName,
+			const PipelineConfigInfo& configInfo);
+
+		// Blocks until every queued pipeline has finished compiling
+		void WaitIdle();
+
+		static size_t HashPipeline(const std::string& vertShaderName,
+			const std::string& fragShaderName,
+			const PipelineConfigInfo& configInfo);
+
+	private:
+		VEDevice& m_Device;
+		std::unordered_map<size_t, std::shared_future<std::shared_ptr<VEPipeline>>> m_Pipelines;
+		std::mutex m_Mutex;
+
+		// Declared last so the workers are joined before the pipelines they write to go away
+		VEThreadPool m_ThreadPool;
+	};
+}
\ No newline at end of file
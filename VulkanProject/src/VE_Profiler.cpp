@@ -0,0 +1,173 @@
+#include "VE_Profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VEProfiler::EVENTS_PER_THREAD;
+
+	static void WriteJsonString(std::ostream& out, const std::string& value)
+	{
+		out << '"';
+
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out << '\\';
+			}
+
+			out << c;
+		}
+
+		out << '"';
+	}
+
+	VEProfiler& VEProfiler::Get()
+	{
+		static VEProfiler profiler;
+		return profiler;
+	}
+
+	VEProfiler::ThreadBuffer& VEProfiler::GetThreadBuffer()
+	{
+		thread_local ThreadBuffer* buffer = nullptr;
+
+		if (buffer == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+
+			m_Threads.push_back(std::make_unique<ThreadBuffer>());
+			buffer = m_Threads.back().get();
+
+			buffer->ThreadId = static_cast<uint32_t>(m_Threads.size());
+			buffer->Name = "Thread " + std::to_string(buffer->ThreadId);
+			buffer->Events.resize(EVENTS_PER_THREAD);
+		}
+
+		return *buffer;
+	}
+
+	void VEProfiler::SetThreadName(const std::string& name)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(buffer.Mutex);
+		buffer.Name = name;
+	}
+
+	void VEProfiler::Record(const char* name, int64_t begin, int64_t end)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(buffer.Mutex);
+		buffer.Events[buffer.WriteCount % EVENTS_PER_THREAD] = { name, begin, end };
+		buffer.WriteCount++;
+	}
+
+	void VEProfiler::BeginCapture(uint32_t frameCount, const std::string& path)
+	{
+		if (IsCapturing() || frameCount == 0)
+		{
+			return;
+		}
+
+		m_RequestedFrames = frameCount;
+		m_CapturePath = path;
+	}
+
+	void VEProfiler::MarkFrame()
+	{
+		int64_t now = Now();
+
+		if (IsCapturing())
+		{
+			Record("Frame", m_FrameStart, now);
+
+			if (--m_FramesRemaining == 0)
+			{
+				m_Capturing.store(false, std::memory_order_relaxed);
+				WriteCapture();
+			}
+		}
+		else if (m_RequestedFrames > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+
+				for (auto& buffer : m_Threads)
+				{
+					std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+					buffer->WriteCount = 0;
+				}
+			}
+
+			m_FramesRemaining = m_RequestedFrames;
+			m_RequestedFrames = 0;
+			m_CaptureStart = now;
+			m_Capturing.store(true, std::memory_order_relaxed);
+		}
+
+		m_FrameStart = now;
+	}
+
+	void VEProfiler::WriteCapture()
+	{
+		std::ofstream file{ m_CapturePath };
+
+		if (!file.is_open())
+		{
+			std::cerr << "profiler: failed to open " << m_CapturePath << std::endl;
+			return;
+		}
+
+		file << std::fixed << std::setprecision(3);
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+		uint64_t eventCount = 0;
+		bool first = true;
+
+		std::lock_guard<std::mutex> lock(m_ThreadsMutex);
+
+		for (auto& buffer : m_Threads)
+		{
+			std::lock_guard<std::mutex> bufferLock(buffer->Mutex);
+
+			if (buffer->WriteCount == 0)
+			{
+				continue;
+			}
+
+			file << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ThreadId
+				<< ",\"args\":{\"name\":";
+			WriteJsonString(file, buffer->Name);
+			file << "}}";
+			first = false;
+
+			uint64_t begin = buffer->WriteCount > EVENTS_PER_THREAD ? buffer->WriteCount - EVENTS_PER_THREAD : 0;
+
+			for (uint64_t i = begin; i < buffer->WriteCount; i++)
+			{
+				const Event& event = buffer->Events[i % EVENTS_PER_THREAD];
+
+				// Scopes that straddle the start of the capture are clipped to it
+				int64_t start = std::max(event.Begin, m_CaptureStart);
+
+				file << ",\n{\"name\":";
+				WriteJsonString(file, event.Name);
+				file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ThreadId
+					<< ",\"ts\":" << (start - m_CaptureStart) / 1000.0
+					<< ",\"dur\":" << (event.End - start) / 1000.0 << "}";
+			}
+
+			eventCount += buffer->WriteCount - begin;
+		}
+
+		file << "\n]}\n";
+
+		std::cout << "profiler: wrote " << eventCount << " events to " << m_CapturePath << std::endl;
+	}
+}
\ No newline at end of file
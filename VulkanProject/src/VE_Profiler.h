@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Define VE_DISABLE_PROFILER to compile every VE_PROFILE_* macro out of the build
+#ifndef VE_DISABLE_PROFILER
+#define VE_PROFILE_CONCAT_INNER(a, b) a##b
+#define VE_PROFILE_CONCAT(a, b) VE_PROFILE_CONCAT_INNER(a, b)
+// name has to outlive the capture, string literals and __FUNCTION__ do
+#define VE_PROFILE_SCOPE(name) VulkanEngine::VEProfileScope VE_PROFILE_CONCAT(veProfileScope, __LINE__){ name }
+#define VE_PROFILE_FUNCTION() VE_PROFILE_SCOPE(__FUNCTION__)
+#define VE_PROFILE_THREAD(name) VulkanEngine::VEProfiler::Get().SetThreadName(name)
+#define VE_PROFILE_FRAME() VulkanEngine::VEProfiler::Get().MarkFrame()
+#define VE_PROFILE_CAPTURE(frameCount, path) VulkanEngine::VEProfiler::Get().BeginCapture(frameCount, path)
+#else
+#define VE_PROFILE_SCOPE(name) ((void)0)
+#define VE_PROFILE_FUNCTION() ((void)0)
+#define VE_PROFILE_THREAD(name) ((void)0)
+#define VE_PROFILE_FRAME() ((void)0)
+#define VE_PROFILE_CAPTURE(frameCount, path) ((void)0)
+#endif
+
+namespace VulkanEngine {
+
+	// Collects CPU scopes from every thread into per-thread ring buffers and writes them out as Chrome
+	// trace event JSON (chrome://tracing, Perfetto, or Tracy through its import-chrome tool).
+	//
+	// Nothing is recorded outside a capture, an idle scope costs one relaxed atomic load. Captures start
+	// and stop on frame boundaries, see MarkFrame.
+	class VEProfiler
+	{
+	public:
+		// Per thread, the oldest events are overwritten once a capture outgrows it
+		static constexpr uint32_t EVENTS_PER_THREAD = 1 << 16;
+
+		static VEProfiler& Get();
+
+		// Delete the copy constructor and copy operator
+		VEProfiler(const VEProfiler&) = delete;
+		VEProfiler& operator=(const VEProfiler&) = delete;
+
+		// Records the frameCount frames following the next MarkFrame and then writes them to path
+		void BeginCapture(uint32_t frameCount, const std::string& path);
+		bool IsCapturing() const { return m_Capturing.load(std::memory_order_relaxed); }
+
+		// Called once per frame by the main loop, also records the frame itself as a scope
+		void MarkFrame();
+
+		void SetThreadName(const std::string& name);
+		void Record(const char* name, int64_t begin, int64_t end);
+
+		// Nanoseconds on a monotonic clock
+		static int64_t Now()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+	private:
+		struct Event
+		{
+			const char* Name;
+			int64_t Begin;
+			int64_t End;
+		};
+
+		// Written by its owning thread only, the lock is uncontended except while a capture is written out
+		struct ThreadBuffer
+		{
+			uint32_t ThreadId;
+			std::string Name;
+			std::vector<Event> Events;
+			uint64_t WriteCount				= 0;
+			std::mutex Mutex;
+		};
+
+		VEProfiler() = default;
+
+		ThreadBuffer& GetThreadBuffer();
+		void WriteCapture();
+
+	private:
+		std::atomic<bool> m_Capturing{ false };
+
+		// Only touched by the thread calling BeginCapture and MarkFrame
+		uint32_t m_RequestedFrames			= 0;
+		uint32_t m_FramesRemaining			= 0;
+		std::string m_CapturePath;
+		int64_t m_CaptureStart				= 0;
+		int64_t m_FrameStart				= 0;
+
+		std::vector<std::unique_ptr<ThreadBuffer>> m_Threads;
+		std::mutex m_ThreadsMutex;
+	};
+
+	class VEProfileScope
+	{
+	public:
+		VEProfileScope(const char* name)
+			: m_Name{ VEProfiler::Get().IsCapturing() ? name : nullptr }, m_Begin{ m_Name != nullptr ? VEProfiler::Now() : 0 }
+		{
+		}
+
+		~VEProfileScope()
+		{
+			if (m_Name != nullptr)
+			{
+				VEProfiler::Get().Record(m_Name, m_Begin, VEProfiler::Now());
+			}
+		}
+
+		// Delete the copy constructor and copy operator
+		VEProfileScope(const VEProfileScope&) = delete;
+		VEProfileScope& operator=(const VEProfileScope&) = delete;
+
+	private:
+		const char* m_Name;
+		int64_t m_Begin;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,1014 @@
+#include "VE_RenderGraph.h"
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VERenderGraph::INVALID_RESOURCE;
+
+	struct ResourceUsageInfo
+	{
+		VkPipelineStageFlags Stages;
+		VkAccessFlags ReadAccess;
+		VkAccessFlags WriteAccess;
+		VkImageLayout Layout;
+		VkImageUsageFlags ImageUsage;
+		VkBufferUsageFlags BufferUsage;
+	};
+
+	// Indexed by VEResourceUsage
+	static const ResourceUsageInfo RESOURCE_USAGE_INFOS[] = {
+		// ColorAttachment
+		{ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, 0 },
+		// DepthStencilAttachment
+		{ VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, 0 },
+		// SampledFragment
+		{ VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT },
+		// SampledCompute
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT, VK_BUFFER_USAGE_UNIFORM_TEXEL_BUFFER_BIT },
+		// StorageCompute
+		{ VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT },
+		// StorageVertex
+		{ VK_PIPELINE_STAGE_VERTEX_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_SHADER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT },
+		// VertexBuffer
+		{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT },
+		// IndexBuffer
+		{ VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			VK_ACCESS_INDEX_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_INDEX_BUFFER_BIT },
+		// IndirectBuffer
+		{ VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+			VK_ACCESS_INDIRECT_COMMAND_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_UNDEFINED, 0, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT },
+		// TransferSrc
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT,
+			VK_ACCESS_TRANSFER_READ_BIT, 0,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT, VK_BUFFER_USAGE_TRANSFER_SRC_BIT },
+		// TransferDst
+		{ VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, VK_ACCESS_TRANSFER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT, VK_BUFFER_USAGE_TRANSFER_DST_BIT },
+	};
+
+	static_assert(sizeof(RESOURCE_USAGE_INFOS) / sizeof(RESOURCE_USAGE_INFOS[0]) == static_cast<size_t>(VEResourceUsage::Count),
+		"RESOURCE_USAGE_INFOS is out of sync with VEResourceUsage");
+
+	static const ResourceUsageInfo& GetUsageInfo(VEResourceUsage usage)
+	{
+		return RESOURCE_USAGE_INFOS[static_cast<uint32_t>(usage)];
+	}
+
+	static VkImageAspectFlags GetAspectMask(VkFormat format)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_D16_UNORM:
+		case VK_FORMAT_X8_D24_UNORM_PACK32:
+		case VK_FORMAT_D32_SFLOAT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT;
+		case VK_FORMAT_D16_UNORM_S8_UINT:
+		case VK_FORMAT_D24_UNORM_S8_UINT:
+		case VK_FORMAT_D32_SFLOAT_S8_UINT:
+			return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+		case VK_FORMAT_S8_UINT:
+			return VK_IMAGE_ASPECT_STENCIL_BIT;
+		default:
+			return VK_IMAGE_ASPECT_COLOR_BIT;
+		}
+	}
+
+	VERenderGraph::PassBuilder& VERenderGraph::PassBuilder::Read(uint32_t resource, VEResourceUsage usage)
+	{
+		m_Graph.AddAccess(m_Pass, resource, usage, false);
+		return *this;
+	}
+
+	VERenderGraph::PassBuilder& VERenderGraph::PassBuilder::Write(uint32_t resource, VEResourceUsage usage)
+	{
+		assert(GetUsageInfo(usage).WriteAccess != 0 && "Usage cannot write");
+
+		m_Graph.AddAccess(m_Pass, resource, usage, true);
+		return *this;
+	}
+
+	VERenderGraph::PassBuilder& VERenderGraph::PassBuilder::WriteColorAttachment(uint32_t resource, VkAttachmentLoadOp loadOp, VkClearColorValue clearColor)
+	{
+		VkClearValue clearValue = {};
+		clearValue.color = clearColor;
+
+		m_Graph.AddAttachment(m_Pass, resource, VEResourceUsage::ColorAttachment, loadOp, clearValue);
+		return *this;
+	}
+
+	VERenderGraph::PassBuilder& VERenderGraph::PassBuilder::WriteDepthAttachment(uint32_t resource, VkAttachmentLoadOp loadOp, VkClearDepthStencilValue clearValue)
+	{
+		VkClearValue value = {};
+		value.depthStencil = clearValue;
+
+		m_Graph.AddAttachment(m_Pass, resource, VEResourceUsage::DepthStencilAttachment, loadOp, value);
+		return *this;
+	}
+
+	VERenderGraph::PassBuilder& VERenderGraph::PassBuilder::SetSideEffect()
+	{
+		m_Graph.m_Passes[m_Pass].SideEffect = true;
+		return *this;
+	}
+
+	VERenderGraph::VERenderGraph(VEDevice& device)
+		: m_Device{ device }
+	{
+
+	}
+
+	VERenderGraph::~VERenderGraph()
+	{
+		DestroyCompiledResources();
+	}
+
+	uint32_t VERenderGraph::CreateImage(const std::string& name, const VERenderGraphImageDesc& desc)
+	{
+		assert(desc.Extent.width > 0 && desc.Extent.height > 0 && "Transient image has no extent");
+
+		Resource resource = {};
+
+		resource.Name		= name;
+		resource.IsImage	= true;
+		resource.ImageDesc	= desc;
+
+		m_Resources.push_back(resource);
+		m_Compiled = false;
+
+		return static_cast<uint32_t>(m_Resources.size() - 1);
+	}
+
+	uint32_t VERenderGraph::CreateBuffer(const std::string& name, const VERenderGraphBufferDesc& desc)
+	{
+		assert(desc.Size > 0 && "Transient buffer has no size");
+
+		Resource resource = {};
+
+		resource.Name		= name;
+		resource.BufferDesc	= desc;
+
+		m_Resources.push_back(resource);
+		m_Compiled = false;
+
+		return static_cast<uint32_t>(m_Resources.size() - 1);
+	}
+
+	uint32_t VERenderGraph::ImportImage(const std::string& name,
+		VkImage image,
+		VkImageView imageView,
+		VkFormat format,
+		VkExtent2D extent,
+		VkImageLayout initialLayout,
+		VkImageLayout finalLayout)
+	{
+		Resource resource = {};
+
+		resource.Name				= name;
+		resource.IsImage			= true;
+		resource.Imported			= true;
+		resource.ImageDesc.Format	= format;
+		resource.ImageDesc.Extent	= extent;
+		resource.InitialLayout		= initialLayout;
+		resource.FinalLayout		= finalLayout;
+		resource.Image				= image;
+		resource.ImageView			= imageView;
+		resource.State.Layout		= initialLayout;
+
+		m_Resources.push_back(resource);
+		m_Compiled = false;
+
+		return static_cast<uint32_t>(m_Resources.size() - 1);
+	}
+
+	uint32_t VERenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size)
+	{
+		Resource resource = {};
+
+		resource.Name				= name;
+		resource.Imported			= true;
+		resource.BufferDesc.Size	= size;
+		resource.Buffer				= buffer;
+
+		m_Resources.push_back(resource);
+		m_Compiled = false;
+
+		return static_cast<uint32_t>(m_Resources.size() - 1);
+	}
+
+	void VERenderGraph::SetImportedImage(uint32_t resource, VkImage image, VkImageView imageView)
+	{
+		assert(m_Resources[resource].Imported && m_Resources[resource].IsImage && "Only imported images can be replaced");
+
+		m_Resources[resource].Image		= image;
+		m_Resources[resource].ImageView	= imageView;
+	}
+
+	uint32_t VERenderGraph::AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, ExecuteFunction execute)
+	{
+		Pass pass = {};
+
+		pass.Name		= name;
+		pass.Execute	= std::move(execute);
+
+		m_Passes.push_back(std::move(pass));
+		m_Compiled = false;
+
+		uint32_t passIndex = static_cast<uint32_t>(m_Passes.size() - 1);
+
+		PassBuilder builder{ *this, passIndex };
+		setup(builder);
+
+		return passIndex;
+	}
+
+	void VERenderGraph::AddAccess(uint32_t pass, uint32_t resource, VEResourceUsage usage, bool write)
+	{
+		assert(resource < m_Resources.size() && "Unknown render graph resource");
+		assert((m_Resources[resource].IsImage || GetUsageInfo(usage).BufferUsage != 0) && "Usage does not apply to buffers");
+		assert((!m_Resources[resource].IsImage || GetUsageInfo(usage).ImageUsage != 0) && "Usage does not apply to images");
+
+		auto& accesses = m_Passes[pass].Accesses;
+
+		// One access per resource and usage, so a read and a write of the same usage share a barrier
+		for (auto& access : accesses)
+		{
+			if (access.Resource == resource && access.Usage == usage)
+			{
+				access.Read = access.Read || !write;
+				access.Write = access.Write || write;
+				return;
+			}
+		}
+
+		accesses.push_back({ resource, usage, !write, write });
+	}
+
+	void VERenderGraph::AddAttachment(uint32_t pass, uint32_t resource, VEResourceUsage usage, VkAttachmentLoadOp loadOp, VkClearValue clearValue)
+	{
+		assert(m_Resources[resource].IsImage && "Attachments have to be images");
+
+		Pass& renderPass = m_Passes[pass];
+
+		assert((renderPass.Attachments.empty() ||
+			m_Resources[renderPass.Attachments.back().Resource].ImageDesc.Extent.width == m_Resources[resource].ImageDesc.Extent.width) &&
+			"Attachments of a pass must share their extent");
+
+		renderPass.Attachments.push_back({ resource, usage, loadOp, clearValue });
+
+		AddAccess(pass, resource, usage, true);
+
+		// Loading what an earlier pass left behind depends on that pass
+		if (loadOp == VK_ATTACHMENT_LOAD_OP_LOAD)
+		{
+			AddAccess(pass, resource, usage, false);
+		}
+	}
+
+	void VERenderGraph::Compile()
+	{
+		DestroyCompiledResources();
+
+		CullPasses();
+		ComputeLifetimes();
+		CreateTransientResources();
+		AssignHeaps();
+		CreateRenderPasses();
+
+		m_Compiled = true;
+	}
+
+	void VERenderGraph::CullPasses()
+	{
+		// Walking backwards, a pass survives when it has side effects or writes something a surviving pass reads.
+		// A full write hides the resource from earlier passes, they only matter if something in between reads it.
+		std::vector<bool> needed(m_Resources.size(), false);
+
+		for (size_t i = m_Passes.size(); i-- > 0;)
+		{
+			Pass& pass = m_Passes[i];
+			bool alive = pass.SideEffect;
+
+			for (const auto& access : pass.Accesses)
+			{
+				if (access.Write && (needed[access.Resource] || m_Resources[access.Resource].Imported))
+				{
+					alive = true;
+				}
+			}
+
+			pass.Culled = !alive;
+
+			if (!alive)
+			{
+				continue;
+			}
+
+			for (const auto& access : pass.Accesses)
+			{
+				if (access.Write)
+				{
+					needed[access.Resource] = false;
+				}
+			}
+
+			for (const auto& access : pass.Accesses)
+			{
+				if (access.Read)
+				{
+					needed[access.Resource] = true;
+				}
+			}
+		}
+	}
+
+	void VERenderGraph::ComputeLifetimes()
+	{
+		for (auto& resource : m_Resources)
+		{
+			resource.FirstPass	= INVALID_RESOURCE;
+			resource.LastPass	= INVALID_RESOURCE;
+		}
+
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			if (m_Passes[i].Culled)
+			{
+				continue;
+			}
+
+			for (const auto& access : m_Passes[i].Accesses)
+			{
+				Resource& resource = m_Resources[access.Resource];
+
+				if (resource.Imported)
+				{
+					continue;
+				}
+
+				if (resource.FirstPass == INVALID_RESOURCE)
+				{
+					// Transient contents do not survive between frames, the first use has to produce them
+					if (access.Read)
+					{
+						throw std::runtime_error("Render graph resource " + resource.Name + " is read by " + m_Passes[i].Name + " before it is written.");
+					}
+
+					resource.FirstPass = i;
+				}
+
+				resource.LastPass = i;
+			}
+		}
+	}
+
+	void VERenderGraph::CreateTransientResources()
+	{
+		// Usage flags are the union of every surviving access
+		std::vector<VkImageUsageFlags> imageUsages(m_Resources.size(), 0);
+		std::vector<VkBufferUsageFlags> bufferUsages(m_Resources.size(), 0);
+
+		for (const auto& pass : m_Passes)
+		{
+			if (pass.Culled)
+			{
+				continue;
+			}
+
+			for (const auto& access : pass.Accesses)
+			{
+				imageUsages[access.Resource] |= GetUsageInfo(access.Usage).ImageUsage;
+				bufferUsages[access.Resource] |= GetUsageInfo(access.Usage).BufferUsage;
+			}
+		}
+
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			Resource& resource = m_Resources[i];
+
+			// Imports are owned elsewhere, and transients no surviving pass touches are never created
+			if (resource.Imported || resource.FirstPass == INVALID_RESOURCE)
+			{
+				continue;
+			}
+
+			resource.State = {};
+
+			if (resource.IsImage)
+			{
+				VkImageCreateInfo imageInfo = {};
+
+				imageInfo.sType				= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType			= VK_IMAGE_TYPE_2D;
+				imageInfo.format			= resource.ImageDesc.Format;
+				imageInfo.extent.width		= resource.ImageDesc.Extent.width;
+				imageInfo.extent.height		= resource.ImageDesc.Extent.height;
+				imageInfo.extent.depth		= 1;
+				imageInfo.mipLevels			= 1;
+				imageInfo.arrayLayers		= 1;
+				imageInfo.samples			= VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.tiling			= VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.usage				= imageUsages[i] | resource.ImageDesc.Usage;
+				imageInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+				imageInfo.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;
+
+				if (vkCreateImage(m_Device.Device(), &imageInfo, nullptr, &resource.Image) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create render graph image " + resource.Name + ".");
+				}
+
+				vkGetImageMemoryRequirements(m_Device.Device(), resource.Image, &resource.MemoryRequirements);
+			}
+			else
+			{
+				VkBufferCreateInfo bufferInfo = {};
+
+				bufferInfo.sType			= VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+				bufferInfo.size				= resource.BufferDesc.Size;
+				bufferInfo.usage			= bufferUsages[i] | resource.BufferDesc.Usage;
+				bufferInfo.sharingMode		= VK_SHARING_MODE_EXCLUSIVE;
+
+				if (vkCreateBuffer(m_Device.Device(), &bufferInfo, nullptr, &resource.Buffer) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create render graph buffer " + resource.Name + ".");
+				}
+
+				vkGetBufferMemoryRequirements(m_Device.Device(), resource.Buffer, &resource.MemoryRequirements);
+			}
+		}
+	}
+
+	void VERenderGraph::AssignHeaps()
+	{
+		std::vector<uint32_t> transients;
+
+		for (uint32_t i = 0; i < m_Resources.size(); i++)
+		{
+			if (!m_Resources[i].Imported && m_Resources[i].FirstPass != INVALID_RESOURCE)
+			{
+				transients.push_back(i);
+			}
+		}
+
+		// Largest first, so the heaps are sized by the resources that open them
+		std::sort(transients.begin(), transients.end(), [this](uint32_t a, uint32_t b)
+			{
+				return m_Resources[a].MemoryRequirements.size > m_Resources[b].MemoryRequirements.size;
+			});
+
+		for (uint32_t index : transients)
+		{
+			Resource& resource = m_Resources[index];
+			const VkMemoryRequirements& requirements = resource.MemoryRequirements;
+
+			// Images and buffers keep to separate heaps, which sidesteps bufferImageGranularity
+			for (uint32_t h = 0; h < m_Heaps.size() && resource.Heap == INVALID_RESOURCE; h++)
+			{
+				Heap& heap = m_Heaps[h];
+
+				if (heap.ForImages != resource.IsImage || (heap.MemoryRequirements.memoryTypeBits & requirements.memoryTypeBits) == 0)
+				{
+					continue;
+				}
+
+				bool overlaps = std::any_of(heap.Resources.begin(), heap.Resources.end(), [&](uint32_t other)
+					{
+						return m_Resources[other].FirstPass <= resource.LastPass && resource.FirstPass <= m_Resources[other].LastPass;
+					});
+
+				if (!overlaps)
+				{
+					resource.Heap = h;
+				}
+			}
+
+			if (resource.Heap == INVALID_RESOURCE)
+			{
+				Heap heap = {};
+
+				heap.ForImages							= resource.IsImage;
+				heap.MemoryRequirements.memoryTypeBits	= requirements.memoryTypeBits;
+
+				m_Heaps.push_back(heap);
+				resource.Heap = static_cast<uint32_t>(m_Heaps.size() - 1);
+			}
+
+			Heap& heap = m_Heaps[resource.Heap];
+
+			heap.Resources.push_back(index);
+			heap.MemoryRequirements.size			= std::max(heap.MemoryRequirements.size, requirements.size);
+			heap.MemoryRequirements.alignment		= std::max(heap.MemoryRequirements.alignment, requirements.alignment);
+			heap.MemoryRequirements.memoryTypeBits	&= requirements.memoryTypeBits;
+		}
+
+		for (auto& heap : m_Heaps)
+		{
+			heap.Allocation = m_Device.GetAllocator().Allocate(heap.MemoryRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, heap.ForImages);
+
+			for (uint32_t index : heap.Resources)
+			{
+				Resource& resource = m_Resources[index];
+
+				if (!resource.IsImage)
+				{
+					vkBindBufferMemory(m_Device.Device(), resource.Buffer, heap.Allocation.Memory, heap.Allocation.Offset);
+					continue;
+				}
+
+				vkBindImageMemory(m_Device.Device(), resource.Image, heap.Allocation.Memory, heap.Allocation.Offset);
+
+				VkImageViewCreateInfo viewInfo = {};
+
+				viewInfo.sType								= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+				viewInfo.image								= resource.Image;
+				viewInfo.viewType							= VK_IMAGE_VIEW_TYPE_2D;
+				viewInfo.format								= resource.ImageDesc.Format;
+				viewInfo.subresourceRange.aspectMask		= GetAspectMask(resource.ImageDesc.Format);
+				viewInfo.subresourceRange.baseMipLevel		= 0;
+				viewInfo.subresourceRange.levelCount		= 1;
+				viewInfo.subresourceRange.baseArrayLayer	= 0;
+				viewInfo.subresourceRange.layerCount		= 1;
+
+				if (vkCreateImageView(m_Device.Device(), &viewInfo, nullptr, &resource.ImageView) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create render graph image view " + resource.Name + ".");
+				}
+			}
+		}
+	}
+
+	void VERenderGraph::CreateRenderPasses()
+	{
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			Pass& pass = m_Passes[i];
+
+			if (pass.Culled || pass.Attachments.empty())
+			{
+				continue;
+			}
+
+			std::vector<VkAttachmentDescription> attachments;
+			std::vector<VkAttachmentReference> colorReferences;
+			VkAttachmentReference depthReference = {};
+			bool hasDepth = false;
+
+			for (uint32_t a = 0; a < pass.Attachments.size(); a++)
+			{
+				const Attachment& attachment = pass.Attachments[a];
+				const Resource& resource = m_Resources[attachment.Resource];
+				VkImageLayout layout = GetUsageInfo(attachment.Usage).Layout;
+
+				// Nothing after this pass looks at a transient attachment it was the last to touch
+				bool store = resource.Imported || resource.LastPass != i;
+
+				// The graph has the image in the attachment layout before the pass begins
+				VkAttachmentDescription description = {};
+
+				description.format				= resource.ImageDesc.Format;
+				description.samples				= VK_SAMPLE_COUNT_1_BIT;
+				description.loadOp				= attachment.LoadOp;
+				description.storeOp				= store ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.stencilLoadOp		= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+				description.stencilStoreOp		= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+				description.initialLayout		= layout;
+				description.finalLayout			= layout;
+
+				attachments.push_back(description);
+
+				if (attachment.Usage == VEResourceUsage::DepthStencilAttachment)
+				{
+					assert(!hasDepth && "A pass can have only one depth attachment");
+
+					depthReference = { a, layout };
+					hasDepth = true;
+				}
+				else
+				{
+					colorReferences.push_back({ a, layout });
+				}
+			}
+
+			VkSubpassDescription subpass = {};
+
+			subpass.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
+			subpass.colorAttachmentCount		= static_cast<uint32_t>(colorReferences.size());
+			subpass.pColorAttachments			= colorReferences.data();
+			subpass.pDepthStencilAttachment		= hasDepth ? &depthReference : nullptr;
+
+			// No subpass dependencies, the barriers recorded around the pass order it against everything else
+			VkRenderPassCreateInfo renderPassInfo = {};
+
+			renderPassInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+			renderPassInfo.attachmentCount		= static_cast<uint32_t>(attachments.size());
+			renderPassInfo.pAttachments			= attachments.data();
+			renderPassInfo.subpassCount			= 1;
+			renderPassInfo.pSubpasses			= &subpass;
+
+			if (vkCreateRenderPass(m_Device.Device(), &renderPassInfo, nullptr, &pass.RenderPass) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to create the render pass of " + pass.Name + ".");
+			}
+
+			pass.Extent = m_Resources[pass.Attachments.front().Resource].ImageDesc.Extent;
+		}
+	}
+
+	void VERenderGraph::DestroyCompiledResources()
+	{
+		// Frames recorded with the previous compile may still be in flight
+		VEDeletionQueue& deletionQueue = m_Device.GetDeletionQueue();
+		VkDevice device = m_Device.Device();
+
+		for (auto& pass : m_Passes)
+		{
+			VkRenderPass renderPass = pass.RenderPass;
+			std::vector<VkFramebuffer> framebuffers;
+
+			for (const auto& entry : pass.Framebuffers)
+			{
+				framebuffers.push_back(entry.second);
+			}
+
+			if (renderPass != VK_NULL_HANDLE)
+			{
+				deletionQueue.Push([device, renderPass, framebuffers]()
+					{
+						for (VkFramebuffer framebuffer : framebuffers)
+						{
+							vkDestroyFramebuffer(device, framebuffer, nullptr);
+						}
+
+						vkDestroyRenderPass(device, renderPass, nullptr);
+					});
+			}
+
+			pass.RenderPass = VK_NULL_HANDLE;
+			pass.Framebuffers.clear();
+		}
+
+		for (auto& resource : m_Resources)
+		{
+			if (resource.Imported)
+			{
+				continue;
+			}
+
+			VkImage image = resource.Image;
+			VkImageView imageView = resource.ImageView;
+			VkBuffer buffer = resource.Buffer;
+
+			if (image != VK_NULL_HANDLE || buffer != VK_NULL_HANDLE)
+			{
+				deletionQueue.Push([device, image, imageView, buffer]()
+					{
+						vkDestroyImageView(device, imageView, nullptr);
+						vkDestroyImage(device, image, nullptr);
+						vkDestroyBuffer(device, buffer, nullptr);
+					});
+			}
+
+			resource.Image		= VK_NULL_HANDLE;
+			resource.ImageView	= VK_NULL_HANDLE;
+			resource.Buffer		= VK_NULL_HANDLE;
+			resource.Heap		= INVALID_RESOURCE;
+		}
+
+		for (auto& heap : m_Heaps)
+		{
+			if (heap.Allocation.Memory != VK_NULL_HANDLE)
+			{
+				deletionQueue.Push([&device = m_Device, allocation = heap.Allocation]() mutable
+					{
+						device.GetAllocator().Free(allocation);
+					});
+			}
+		}
+
+		m_Heaps.clear();
+		m_Compiled = false;
+	}
+
+	void VERenderGraph::TransitionResource(Resource& resource, VEResourceUsage usage, bool read, bool write, Barriers& barriers)
+	{
+		const ResourceUsageInfo& info = GetUsageInfo(usage);
+		ResourceState& state = resource.State;
+
+		VkImageLayout layout = resource.IsImage ? info.Layout : VK_IMAGE_LAYOUT_UNDEFINED;
+		VkAccessFlags dstAccess = (read ? info.ReadAccess : 0) | (write ? info.WriteAccess : 0);
+
+		if (write || layout != state.Layout)
+		{
+			// Wait for the last write and every read since, only the write has memory to make available
+			VkPipelineStageFlags srcStages = state.WriteStages | state.ReadStages;
+
+			barriers.SrcStages |= srcStages;
+			barriers.DstStages |= info.Stages;
+
+			if (layout != state.Layout)
+			{
+				VkImageMemoryBarrier imageBarrier = {};
+
+				imageBarrier.sType								= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+				imageBarrier.srcAccessMask						= state.WriteAccess;
+				imageBarrier.dstAccessMask						= dstAccess;
+				imageBarrier.oldLayout							= state.Layout;
+				imageBarrier.newLayout							= layout;
+				imageBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+				imageBarrier.image								= resource.Image;
+				imageBarrier.subresourceRange.aspectMask		= GetAspectMask(resource.ImageDesc.Format);
+				imageBarrier.subresourceRange.baseMipLevel		= 0;
+				imageBarrier.subresourceRange.levelCount		= VK_REMAINING_MIP_LEVELS;
+				imageBarrier.subresourceRange.baseArrayLayer	= 0;
+				imageBarrier.subresourceRange.layerCount		= VK_REMAINING_ARRAY_LAYERS;
+
+				barriers.ImageBarriers.push_back(imageBarrier);
+			}
+			else if (state.WriteAccess != 0)
+			{
+				barriers.MemoryBarrier.srcAccessMask |= state.WriteAccess;
+				barriers.MemoryBarrier.dstAccessMask |= dstAccess;
+			}
+
+			// A layout transition counts as a write that is already visible to this access
+			state.WriteStages	= info.Stages;
+			state.WriteAccess	= write ? info.WriteAccess : 0;
+			state.ReadStages	= write ? 0 : info.Stages;
+			state.VisibleStages	= write ? 0 : info.Stages;
+			state.VisibleAccess	= write ? 0 : dstAccess;
+			state.Layout		= layout;
+
+			return;
+		}
+
+		// Reads after reads need nothing, a read after a write only once per stage and access
+		if (state.WriteStages != 0 && ((info.Stages & ~state.VisibleStages) != 0 || (dstAccess & ~state.VisibleAccess) != 0))
+		{
+			barriers.SrcStages |= state.WriteStages;
+			barriers.DstStages |= info.Stages;
+
+			if (state.WriteAccess != 0)
+			{
+				barriers.MemoryBarrier.srcAccessMask |= state.WriteAccess;
+				barriers.MemoryBarrier.dstAccessMask |= dstAccess;
+			}
+
+			state.VisibleStages |= info.Stages;
+			state.VisibleAccess |= dstAccess;
+		}
+
+		state.ReadStages |= info.Stages;
+	}
+
+	void VERenderGraph::FlushBarriers(VkCommandBuffer commandBuffer, Barriers& barriers)
+	{
+		if (barriers.DstStages == 0)
+		{
+			return;
+		}
+
+		barriers.MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+		bool hasMemoryBarrier = barriers.MemoryBarrier.srcAccessMask != 0;
+
+		vkCmdPipelineBarrier(commandBuffer,
+			barriers.SrcStages != 0 ? barriers.SrcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			barriers.DstStages,
+			0,
+			hasMemoryBarrier ? 1 : 0, hasMemoryBarrier ? &barriers.MemoryBarrier : nullptr,
+			0, nullptr,
+			static_cast<uint32_t>(barriers.ImageBarriers.size()), barriers.ImageBarriers.data());
+	}
+
+	VkFramebuffer VERenderGraph::GetFramebuffer(Pass& pass)
+	{
+		std::vector<VkImageView> attachmentViews;
+
+		for (const auto& attachment : pass.Attachments)
+		{
+			attachmentViews.push_back(m_Resources[attachment.Resource].ImageView);
+		}
+
+		auto found = pass.Framebuffers.find(attachmentViews);
+
+		if (found != pass.Framebuffers.end())
+		{
+			return found->second;
+		}
+
+		VkFramebufferCreateInfo framebufferInfo = {};
+
+		framebufferInfo.sType				= VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass			= pass.RenderPass;
+		framebufferInfo.attachmentCount		= static_cast<uint32_t>(attachmentViews.size());
+		framebufferInfo.pAttachments		= attachmentViews.data();
+		framebufferInfo.width				= pass.Extent.width;
+		framebufferInfo.height				= pass.Extent.height;
+		framebufferInfo.layers				= 1;
+
+		VkFramebuffer framebuffer;
+
+		if (vkCreateFramebuffer(m_Device.Device(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create the framebuffer of " + pass.Name + ".");
+		}
+
+		pass.Framebuffers.emplace(std::move(attachmentViews), framebuffer);
+
+		return framebuffer;
+	}
+
+	void VERenderGraph::Execute(VkCommandBuffer commandBuffer)
+	{
+		assert(m_Compiled && "Render graph has to be compiled before it is executed");
+
+		for (auto& resource : m_Resources)
+		{
+			if (resource.Imported && resource.IsImage)
+			{
+				resource.State.Layout = resource.InitialLayout;
+			}
+		}
+
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			Pass& pass = m_Passes[i];
+
+			if (pass.Culled)
+			{
+				continue;
+			}
+
+			Barriers barriers;
+
+			for (const auto& access : pass.Accesses)
+			{
+				Resource& resource = m_Resources[access.Resource];
+
+				// A transient starts out with undefined contents, after whatever last used its memory
+				if (!resource.Imported && resource.FirstPass == i)
+				{
+					const Heap& heap = m_Heaps[resource.Heap];
+
+					resource.State = {};
+					resource.State.WriteStages = heap.PendingStages;
+					resource.State.WriteAccess = heap.PendingAccess;
+				}
+
+				TransitionResource(resource, access.Usage, access.Read, access.Write, barriers);
+			}
+
+			FlushBarriers(commandBuffer, barriers);
+
+			if (pass.RenderPass == VK_NULL_HANDLE)
+			{
+				pass.Execute(commandBuffer, *this);
+			}
+			else
+			{
+				std::vector<VkClearValue> clearValues;
+
+				for (const auto& attachment : pass.Attachments)
+				{
+					clearValues.push_back(attachment.ClearValue);
+				}
+
+				VkRenderPassBeginInfo renderPassInfo = {};
+
+				renderPassInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+				renderPassInfo.renderPass			= pass.RenderPass;
+				renderPassInfo.framebuffer			= GetFramebuffer(pass);
+				renderPassInfo.renderArea.offset	= { 0, 0 };
+				renderPassInfo.renderArea.extent	= pass.Extent;
+				renderPassInfo.clearValueCount		= static_cast<uint32_t>(clearValues.size());
+				renderPassInfo.pClearValues			= clearValues.data();
+
+				vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+				VkViewport viewport = {};
+
+				viewport.x							= 0.0f;
+				viewport.y							= 0.0f;
+				viewport.width						= static_cast<float>(pass.Extent.width);
+				viewport.height						= static_cast<float>(pass.Extent.height);
+				viewport.minDepth					= 0.0f;
+				viewport.maxDepth					= 1.0f;
+
+				VkRect2D scissor{ { 0, 0 }, pass.Extent };
+
+				vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+				vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+				pass.Execute(commandBuffer, *this);
+
+				vkCmdEndRenderPass(commandBuffer);
+			}
+
+			for (const auto& access : pass.Accesses)
+			{
+				Resource& resource = m_Resources[access.Resource];
+
+				// Hand the memory over to the next transient placed in it
+				if (!resource.Imported && resource.LastPass == i)
+				{
+					Heap& heap = m_Heaps[resource.Heap];
+
+					heap.PendingStages = resource.State.WriteStages | resource.State.ReadStages;
+					heap.PendingAccess = resource.State.WriteAccess;
+				}
+			}
+		}
+
+		Barriers barriers;
+
+		for (auto& resource : m_Resources)
+		{
+			if (!resource.Imported || !resource.IsImage ||
+				resource.FinalLayout == VK_IMAGE_LAYOUT_UNDEFINED || resource.FinalLayout == resource.State.Layout)
+			{
+				continue;
+			}
+
+			VkImageMemoryBarrier imageBarrier = {};
+
+			imageBarrier.sType								= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			imageBarrier.srcAccessMask						= resource.State.WriteAccess;
+			imageBarrier.dstAccessMask						= 0;
+			imageBarrier.oldLayout							= resource.State.Layout;
+			imageBarrier.newLayout							= resource.FinalLayout;
+			imageBarrier.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image								= resource.Image;
+			imageBarrier.subresourceRange.aspectMask		= GetAspectMask(resource.ImageDesc.Format);
+			imageBarrier.subresourceRange.baseMipLevel		= 0;
+			imageBarrier.subresourceRange.levelCount		= VK_REMAINING_MIP_LEVELS;
+			imageBarrier.subresourceRange.baseArrayLayer	= 0;
+			imageBarrier.subresourceRange.layerCount		= VK_REMAINING_ARRAY_LAYERS;
+
+			barriers.SrcStages |= resource.State.WriteStages | resource.State.ReadStages;
+			barriers.DstStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+			barriers.ImageBarriers.push_back(imageBarrier);
+
+			// Whatever runs after the graph is unknown, so the next frame waits for all of it
+			resource.State = {};
+			resource.State.WriteStages = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			resource.State.Layout = resource.FinalLayout;
+		}
+
+		FlushBarriers(commandBuffer, barriers);
+	}
+
+	void VERenderGraph::PrintStats() const
+	{
+		uint32_t culledCount = 0;
+		uint32_t transientCount = 0;
+		VkDeviceSize unaliasedBytes = 0;
+		VkDeviceSize heapBytes = 0;
+
+		for (const auto& pass : m_Passes)
+		{
+			culledCount += pass.Culled ? 1 : 0;
+		}
+
+		for (const auto& resource : m_Resources)
+		{
+			if (!resource.Imported && resource.FirstPass != INVALID_RESOURCE)
+			{
+				transientCount++;
+				unaliasedBytes += resource.MemoryRequirements.size;
+			}
+		}
+
+		for (const auto& heap : m_Heaps)
+		{
+			heapBytes += heap.MemoryRequirements.size;
+		}
+
+		std::cout << std::fixed << std::setprecision(2)
+			<< "render graph: " << m_Passes.size() << " passes (" << culledCount << " culled), "
+			<< transientCount << " transient resources in " << m_Heaps.size() << " heaps, "
+			<< heapBytes / (1024.0 * 1024.0) << " MiB instead of " << unaliasedBytes / (1024.0 * 1024.0) << " MiB" << std::endl;
+	}
+}
\ No newline at end of file
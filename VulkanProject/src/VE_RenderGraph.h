@@ -0,0 +1,233 @@
+#pragma once
+#include "VE_Device.h"
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// How a pass touches a resource, each one maps to a pipeline stage, access mask and image layout
+	enum class VEResourceUsage : uint32_t
+	{
+		ColorAttachment,
+		DepthStencilAttachment,
+		SampledFragment,
+		SampledCompute,
+		StorageCompute,
+		StorageVertex,
+		VertexBuffer,
+		IndexBuffer,
+		IndirectBuffer,
+		TransferSrc,
+		TransferDst,
+		Count
+	};
+
+	struct VERenderGraphImageDesc
+	{
+		VkFormat Format						= VK_FORMAT_R8G8B8A8_UNORM;
+		VkExtent2D Extent					= { 0, 0 };
+		// Added to the usage flags derived from the passes
+		VkImageUsageFlags Usage				= 0;
+	};
+
+	struct VERenderGraphBufferDesc
+	{
+		VkDeviceSize Size					= 0;
+		// Added to the usage flags derived from the passes
+		VkBufferUsageFlags Usage			= 0;
+	};
+
+	// A frame described as passes that declare what they read and write. Compile culls the passes nothing
+	// depends on, places transient resources whose lifetimes do not overlap in the same memory and builds a
+	// render pass for every pass with attachments. Execute records the passes in declaration order with the
+	// barriers and layout transitions derived from the declarations, batched into one vkCmdPipelineBarrier
+	// per pass.
+	//
+	// Resource state carries over from one Execute to the next, so reusing a resource in the next frame
+	// waits for this frame's last use of it.
+	class VERenderGraph
+	{
+	public:
+		using ExecuteFunction = std::function<void(VkCommandBuffer commandBuffer, const VERenderGraph& graph)>;
+
+		static constexpr uint32_t INVALID_RESOURCE = ~0u;
+
+		class PassBuilder
+		{
+		public:
+			PassBuilder& Read(uint32_t resource, VEResourceUsage usage);
+			PassBuilder& Write(uint32_t resource, VEResourceUsage usage);
+
+			// The pass is recorded inside a render pass the graph begins, with the viewport and scissor set to the attachments.
+			// Loading the previous contents counts as a read.
+			PassBuilder& WriteColorAttachment(uint32_t resource,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				VkClearColorValue clearColor = { { 0.0f, 0.0f, 0.0f, 1.0f } });
+			PassBuilder& WriteDepthAttachment(uint32_t resource,
+				VkAttachmentLoadOp loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				VkClearDepthStencilValue clearValue = { 1.0f, 0 });
+
+			// Never culled, e.g. a pass that presents or reads results back
+			PassBuilder& SetSideEffect();
+
+		private:
+			friend class VERenderGraph;
+
+			PassBuilder(VERenderGraph& graph, uint32_t pass) : m_Graph{ graph }, m_Pass{ pass } {}
+
+			VERenderGraph& m_Graph;
+			uint32_t m_Pass;
+		};
+
+		explicit VERenderGraph(VEDevice& device);
+		~VERenderGraph();
+
+		// Delete the copy constructor and copy operator
+		VERenderGraph(const VERenderGraph&) = delete;
+		VERenderGraph& operator=(const VERenderGraph&) = delete;
+
+		// Resources owned by the graph, their contents do not survive from one frame to the next
+		uint32_t CreateImage(const std::string& name, const VERenderGraphImageDesc& desc);
+		uint32_t CreateBuffer(const std::string& name, const VERenderGraphBufferDesc& desc);
+
+		// Resources owned elsewhere. An imported image is in initialLayout at the start of every Execute and is
+		// left in finalLayout, or wherever the last pass left it when finalLayout is VK_IMAGE_LAYOUT_UNDEFINED.
+		uint32_t ImportImage(const std::string& name,
+			VkImage image,
+			VkImageView imageView,
+			VkFormat format,
+			VkExtent2D extent,
+			VkImageLayout initialLayout,
+			VkImageLayout finalLayout);
+		uint32_t ImportBuffer(const std::string& name, VkBuffer buffer, VkDeviceSize size = VK_WHOLE_SIZE);
+		// For imports that change from frame to frame, such as swap chain images
+		void SetImportedImage(uint32_t resource, VkImage image, VkImageView imageView);
+
+		// setup declares the pass's resource usage right away, execute records it
+		uint32_t AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, ExecuteFunction execute);
+
+		// Call after the last AddPass and again after any change to the declarations
+		void Compile();
+		void Execute(VkCommandBuffer commandBuffer);
+
+		VkImage GetImage(uint32_t resource) const { return m_Resources[resource].Image; }
+		VkImageView GetImageView(uint32_t resource) const { return m_Resources[resource].ImageView; }
+		VkBuffer GetBuffer(uint32_t resource) const { return m_Resources[resource].Buffer; }
+		// Null for passes without attachments, valid after Compile
+		VkRenderPass GetRenderPass(uint32_t pass) const { return m_Passes[pass].RenderPass; }
+		bool IsPassCulled(uint32_t pass) const { return m_Passes[pass].Culled; }
+
+		void PrintStats() const;
+
+	private:
+		struct ResourceState
+		{
+			VkPipelineStageFlags WriteStages		= 0;	// Last write, or layout transition
+			VkAccessFlags WriteAccess				= 0;
+			VkPipelineStageFlags ReadStages			= 0;	// Reads since the last write, a later write waits for them
+			VkPipelineStageFlags VisibleStages		= 0;	// Stages and accesses the last write is already visible to
+			VkAccessFlags VisibleAccess				= 0;
+			VkImageLayout Layout					= VK_IMAGE_LAYOUT_UNDEFINED;
+		};
+
+		struct Resource
+		{
+			std::string Name;
+			bool IsImage							= false;
+			bool Imported							= false;
+
+			VERenderGraphImageDesc ImageDesc;
+			VERenderGraphBufferDesc BufferDesc;
+			VkImageLayout InitialLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
+			VkImageLayout FinalLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
+
+			VkImage Image							= VK_NULL_HANDLE;
+			VkImageView ImageView					= VK_NULL_HANDLE;
+			VkBuffer Buffer							= VK_NULL_HANDLE;
+
+			// Transient only, set by Compile
+			uint32_t FirstPass						= INVALID_RESOURCE;
+			uint32_t LastPass						= INVALID_RESOURCE;
+			uint32_t Heap							= INVALID_RESOURCE;
+			VkMemoryRequirements MemoryRequirements	= {};
+
+			ResourceState State;
+		};
+
+		struct Access
+		{
+			uint32_t Resource;
+			VEResourceUsage Usage;
+			bool Read;
+			bool Write;
+		};
+
+		struct Attachment
+		{
+			uint32_t Resource;
+			VEResourceUsage Usage;
+			VkAttachmentLoadOp LoadOp;
+			VkClearValue ClearValue;
+		};
+
+		struct Pass
+		{
+			std::string Name;
+			std::vector<Access> Accesses;
+			std::vector<Attachment> Attachments;	// At most one depth attachment
+			bool SideEffect							= false;
+			bool Culled								= false;
+			ExecuteFunction Execute;
+
+			VkRenderPass RenderPass					= VK_NULL_HANDLE;
+			VkExtent2D Extent						= { 0, 0 };
+			// Imported attachments may change every frame, so framebuffers are cached by their views
+			std::map<std::vector<VkImageView>, VkFramebuffer> Framebuffers;
+		};
+
+		// A block of memory shared by transient resources that are never alive at the same time
+		struct Heap
+		{
+			bool ForImages							= false;
+			VkMemoryRequirements MemoryRequirements	= {};
+			std::vector<uint32_t> Resources;
+			VEAllocation Allocation;
+			// The last use of the previous occupant, its successor's first use waits for it
+			VkPipelineStageFlags PendingStages		= 0;
+			VkAccessFlags PendingAccess				= 0;
+		};
+
+		struct Barriers
+		{
+			VkPipelineStageFlags SrcStages			= 0;
+			VkPipelineStageFlags DstStages			= 0;
+			VkMemoryBarrier MemoryBarrier			= {};
+			std::vector<VkImageMemoryBarrier> ImageBarriers;
+		};
+
+		void AddAccess(uint32_t pass, uint32_t resource, VEResourceUsage usage, bool write);
+		void AddAttachment(uint32_t pass, uint32_t resource, VEResourceUsage usage, VkAttachmentLoadOp loadOp, VkClearValue clearValue);
+
+		void CullPasses();
+		void ComputeLifetimes();
+		void CreateTransientResources();
+		void AssignHeaps();
+		void CreateRenderPasses();
+		void DestroyCompiledResources();
+
+		void TransitionResource(Resource& resource, VEResourceUsage usage, bool read, bool write, Barriers& barriers);
+		static void FlushBarriers(VkCommandBuffer commandBuffer, Barriers& barriers);
+		VkFramebuffer GetFramebuffer(Pass& pass);
+
+	private:
+		VEDevice& m_Device;
+
+		std::vector<Resource> m_Resources;
+		std::vector<Pass> m_Passes;
+		std::vector<Heap> m_Heaps;
+		bool m_Compiled								= false;
+	};
+}
\ No newline at end of file
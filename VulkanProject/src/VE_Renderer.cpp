@@ -1,56 +1,163 @@
 #include "VE_Renderer.h"
+#include "VE_Profiler.h"
+#include "VE_Uploader.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <future>
 #include <iostream>
 #include <stdexcept>
 
 namespace VulkanEngine {
 
-	VERenderer::VERenderer(VEWindow& window, VEDevice& device)
-		: m_Window{window}, m_Device{device}
+	constexpr uint32_t VERenderer::MIN_ITEMS_PER_CHUNK;
+	constexpr uint32_t VERenderer::LATENCY_HISTORY_LENGTH;
+
+	VERenderer::VERenderer(VEWindow* window, VEDevice& device, const VESwapChainConfig& config, VkExtent2D headlessExtent)
+		: m_Window{window}, m_HeadlessExtent{headlessExtent}, m_Device{device}, m_Config{config}
 	{
+		assert((m_Window != nullptr) != m_Device.IsHeadless() && "The renderer needs a window exactly when the device has a surface.");
+		assert((!IsHeadless() || (headlessExtent.width > 0 && headlessExtent.height > 0)) && "Headless rendering needs an extent.");
+
 		RecreateSwapChain();
 		CreateCommandBuffers();
+		CreateRecordingSlots();
+
+		m_FrameRingBuffer = std::make_unique<VEFrameRingBuffer>(m_Device, m_Config.FramesInFlight);
+		m_GpuProfiler = std::make_unique<VEGpuProfiler>(m_Device, m_Config.FramesInFlight);
 	}
 
 	VERenderer::~VERenderer()
 	{
+		DestroyRecordingSlots();
 		FreeCommandBuffers();
 	}
 
 	void VERenderer::RecreateSwapChain()
 	{
-		auto extent = m_Window.GetExtent();
+		VE_PROFILE_FUNCTION();
 
+		auto startTime = std::chrono::steady_clock::now();
+		auto extent = IsHeadless() ? m_HeadlessExtent : m_Window->GetExtent();
+
+		// A minimized window has no extent, wait until it comes back
 		while (extent.width == 0 || extent.height == 0)
 		{
-			extent = m_Window.GetExtent();
+			extent = m_Window->GetExtent();
 			glfwWaitEvents();
+			startTime = std::chrono::steady_clock::now();
 		}
 
-		vkDeviceWaitIdle(m_Device.Device());
-
 		if (m_SwapChain == nullptr)
 		{
-			m_SwapChain = std::make_unique<VESwapChain>(m_Device, extent);
+			m_SwapChain = std::make_unique<VESwapChain>(m_Device, extent, m_Config);
+			return;
+		}
+
+		// No device wait, frames already submitted keep rendering into the old chain's images and framebuffers
+		std::shared_ptr<VESwapChain> oldSwapChain = std::move(m_SwapChain);
+
+		m_SwapChain = std::make_unique<VESwapChain>(m_Device, extent, m_Config, oldSwapChain);
+
+		if (!oldSwapChain->CompareSwapFormats(*m_SwapChain.get()))
+		{
+			throw std::runtime_error("Swap chain image (or depth) format has changed.");
 		}
-		else
+
+		// The old chain is destroyed once the last frame submitted through it retires
+		m_Device.GetDeletionQueue().Push([oldSwapChain]() mutable { oldSwapChain.reset(); });
+
+		float elapsedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+		std::cout << "Swap chain recreated (" << extent.width << "x" << extent.height << ") in " << elapsedMs << " ms" << std::endl;
+	}
+
+	void VERenderer::SetPresentMode(VkPresentModeKHR presentMode)
+	{
+		assert(!m_IsFrameStarted && "Can't change the present mode while a frame is in progress.");
+
+		if (IsHeadless() || presentMode == m_Config.PresentMode)
+		{
+			return;
+		}
+
+		m_Config.PresentMode = presentMode;
+		RecreateSwapChain();
+	}
+
+	void VERenderer::WaitForLastSubmittedFrame()
+	{
+		VE_PROFILE_FUNCTION();
+		assert(!m_IsFrameStarted && "Can't wait for the GPU while a frame is in progress.");
+
+		VEFrameTimeline& timeline = m_Device.GetFrameTimeline();
+		timeline.Wait(timeline.GetSubmittedValue());
+
+		ResolveLatencySamples();
+	}
+
+	void VERenderer::MarkInputSampled()
+	{
+		m_InputTime		= std::chrono::steady_clock::now();
+		m_HasInputTime	= true;
+	}
+
+	void VERenderer::ResolveLatencySamples()
+	{
+		VEFrameTimeline& timeline = m_Device.GetFrameTimeline();
+		auto now = std::chrono::steady_clock::now();
+
+		// The GPU finishes frames in order, so the first sample still pending ends the search
+		while (!m_PendingLatencySamples.empty() && timeline.IsComplete(m_PendingLatencySamples.front().SubmitValue))
 		{
-			std::shared_ptr<VESwapChain> oldSwapChain = std::move(m_SwapChain);
+			float latencyMs = std::chrono::duration<float, std::milli>(now - m_PendingLatencySamples.front().InputTime).count();
+			m_PendingLatencySamples.pop_front();
 
-			m_SwapChain = std::make_unique<VESwapChain>(m_Device, extent, oldSwapChain);
+			m_LatencyHistory.push_back(latencyMs);
 
-			if (!oldSwapChain->CompareSwapFormats(*m_SwapChain.get()))
+			if (m_LatencyHistory.size() > LATENCY_HISTORY_LENGTH)
 			{
-				throw std::runtime_error("Swap chain image (or depth) format has changed.");
+				m_LatencyHistory.pop_front();
 			}
 		}
 	}
 
+	VELatencyStats VERenderer::GetLatencyStats() const
+	{
+		VELatencyStats stats;
+
+		if (m_LatencyHistory.empty())
+		{
+			return stats;
+		}
+
+		stats.MinMs			= *std::min_element(m_LatencyHistory.begin(), m_LatencyHistory.end());
+		stats.MaxMs			= *std::max_element(m_LatencyHistory.begin(), m_LatencyHistory.end());
+		stats.SampleCount	= static_cast<uint32_t>(m_LatencyHistory.size());
+
+		for (float latencyMs : m_LatencyHistory)
+		{
+			stats.AverageMs += latencyMs;
+		}
+
+		stats.AverageMs /= stats.SampleCount;
+
+		return stats;
+	}
+
+	void VERenderer::PrintLatencyStats() const
+	{
+		VELatencyStats stats = GetLatencyStats();
+
+		std::cout << "Input to GPU completion over the last " << stats.SampleCount << " frames ("
+			<< VESwapChain::PresentModeName(m_SwapChain->GetPresentMode()) << ", "
+			<< m_Config.FramesInFlight << " frame(s) in flight): "
+			<< "min " << stats.MinMs << " ms, avg " << stats.AverageMs << " ms, max " << stats.MaxMs << " ms" << std::endl;
+	}
+
 	void VERenderer::CreateCommandBuffers()
 	{
-		m_CommandBuffers.resize(VESwapChain::MAX_FRAMES_IN_FLIGHT);
+		m_CommandBuffers.resize(m_Config.FramesInFlight);
 
 		VkCommandBufferAllocateInfo allocInfo = {};
 
@@ -75,11 +182,191 @@ namespace VulkanEngine {
 		m_CommandBuffers.clear();
 	}
 
+	void VERenderer::CreateRecordingSlots()
+	{
+		uint32_t slotCount = m_RecordingThreads.GetThreadCount() + 1;
+
+		VkCommandPoolCreateInfo poolInfo = {};
+
+		poolInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex		= m_Device.FindPhysicalQueueFamilies().GraphicsFamily;
+		// Every buffer is re-recorded each frame, the whole pool gets reset at once
+		poolInfo.flags					= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		m_RecordingSlots.resize(m_Config.FramesInFlight);
+
+		for (auto& frameSlots : m_RecordingSlots)
+		{
+			frameSlots.resize(slotCount);
+
+			for (auto& slot : frameSlots)
+			{
+				if (vkCreateCommandPool(m_Device.Device(), &poolInfo, nullptr, &slot.CommandPool) != VK_SUCCESS)
+				{
+					throw std::runtime_error("Failed to create recording command pool.");
+				}
+			}
+		}
+	}
+
+	void VERenderer::DestroyRecordingSlots()
+	{
+		for (auto& frameSlots : m_RecordingSlots)
+		{
+			for (auto& slot : frameSlots)
+			{
+				// Destroying the pool frees its command buffers with it
+				vkDestroyCommandPool(m_Device.Device(), slot.CommandPool, nullptr);
+			}
+		}
+
+		m_RecordingSlots.clear();
+	}
+
+	void VERenderer::ResetRecordingSlots()
+	{
+		for (auto& slot : m_RecordingSlots[m_CurrentFrameIndex])
+		{
+			if (slot.UsedCount == 0)
+			{
+				continue;
+			}
+
+			vkResetCommandPool(m_Device.Device(), slot.CommandPool, 0);
+			slot.UsedCount = 0;
+		}
+	}
+
+	VkCommandBuffer VERenderer::BeginSecondaryCommandBuffer(RecordingSlot& slot)
+	{
+		if (slot.UsedCount == slot.CommandBuffers.size())
+		{
+			VkCommandBufferAllocateInfo allocInfo = {};
+
+			allocInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.level					= VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+			allocInfo.commandPool			= slot.CommandPool;
+			allocInfo.commandBufferCount	= 1;
+
+			VkCommandBuffer commandBuffer;
+			if (vkAllocateCommandBuffers(m_Device.Device(), &allocInfo, &commandBuffer) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to allocate secondary command buffer.");
+			}
+
+			slot.CommandBuffers.push_back(commandBuffer);
+		}
+
+		VkCommandBuffer commandBuffer = slot.CommandBuffers[slot.UsedCount++];
+
+		VkCommandBufferInheritanceInfo inheritanceInfo = {};
+
+		inheritanceInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritanceInfo.renderPass			= m_SwapChain->GetRenderPass();
+		inheritanceInfo.subpass				= 0;
+		inheritanceInfo.framebuffer			= m_SwapChain->GetFrameBuffer(m_CurrentImageIndex);
+
+		VkCommandBufferBeginInfo beginInfo = {};
+
+		beginInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags					= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo		= &inheritanceInfo;
+
+		if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to begin recording secondary command buffer.");
+		}
+
+		// Dynamic state is not inherited from the primary buffer
+		SetViewportAndScissor(commandBuffer);
+
+		return commandBuffer;
+	}
+
+	void VERenderer::RecordParallel(VkCommandBuffer commandBuffer,
+		uint32_t itemCount,
+		const RecordChunkFunction& recordChunk,
+		const char* gpuScope)
+	{
+		assert(m_IsFrameStarted && "Can't call RecordParallel while a frame is not in progress.");
+		assert(m_SubpassContents == VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS && "RecordParallel needs a render pass begun with secondary command buffer contents");
+
+		if (itemCount == 0)
+		{
+			return;
+		}
+
+		auto& slots = m_RecordingSlots[m_CurrentFrameIndex];
+
+		uint32_t chunkCount = std::min(static_cast<uint32_t>(slots.size()), (itemCount + MIN_ITEMS_PER_CHUNK - 1) / MIN_ITEMS_PER_CHUNK);
+		uint32_t chunkSize = (itemCount + chunkCount - 1) / chunkCount;
+
+		// The primary may only execute commands here, so the scope is written into the first and last secondaries
+		uint32_t scope = gpuScope != nullptr ? m_GpuProfiler->AllocateScope(gpuScope) : VEGpuProfiler::INVALID_SCOPE;
+
+		std::vector<VkCommandBuffer> secondaryBuffers(chunkCount);
+		std::vector<std::future<void>> pending;
+		pending.reserve(chunkCount);
+
+		auto recordSlot = [&](uint32_t chunk)
+		{
+			VE_PROFILE_SCOPE("Record chunk");
+
+			uint32_t first = chunk * chunkSize;
+			uint32_t count = std::min(chunkSize, itemCount - first);
+
+			VkCommandBuffer secondary = BeginSecondaryCommandBuffer(slots[chunk]);
+
+			if (chunk == 0)
+			{
+				m_GpuProfiler->WriteBeginTimestamp(secondary, scope);
+			}
+
+			recordChunk(secondary, first, count);
+
+			if (chunk == chunkCount - 1)
+			{
+				m_GpuProfiler->WriteEndTimestamp(secondary, scope);
+			}
+
+			if (vkEndCommandBuffer(secondary) != VK_SUCCESS)
+			{
+				throw std::runtime_error("Failed to record secondary command buffer.");
+			}
+
+			secondaryBuffers[chunk] = secondary;
+		};
+
+		for (uint32_t chunk = 1; chunk < chunkCount; chunk++)
+		{
+			pending.push_back(m_RecordingThreads.Submit([&recordSlot, chunk]() { recordSlot(chunk); }));
+		}
+
+		recordSlot(0);
+
+		// get() rethrows anything a worker threw
+		for (auto& job : pending)
+		{
+			job.get();
+		}
+
+		vkCmdExecuteCommands(commandBuffer, chunkCount, secondaryBuffers.data());
+	}
+
 	VkCommandBuffer VERenderer::BeginFrame()
 	{
+		VE_PROFILE_FUNCTION();
 		assert(!m_IsFrameStarted && "Can't call BeginFrame while it's already in progress.");
 
-		auto result = m_SwapChain->AcquireNextImage(&m_CurrentImageIndex);
+		VkResult result;
+		{
+			VE_PROFILE_SCOPE("Wait and acquire");
+			result = m_SwapChain->AcquireNextImage(&m_CurrentImageIndex);
+		}
+
+		// Picks up the frames the acquire wait just saw complete
+		ResolveLatencySamples();
+		m_Device.GetDeletionQueue().Collect();
 
 		if (result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
@@ -93,6 +380,12 @@ namespace VulkanEngine {
 		}
 
 		m_IsFrameStarted = true;
+		m_FrameNumber++;
+
+		// The frame timeline wait in AcquireNextImage guarantees this frame's secondaries and ring buffer
+		// partition are no longer in use
+		ResetRecordingSlots();
+		m_FrameRingBuffer->BeginFrame(m_CurrentFrameIndex);
 		
 		auto commandBuffer = GetCurrentCommandBuffer();
 
@@ -105,11 +398,18 @@ namespace VulkanEngine {
 			throw std::runtime_error("Failed to begin recording command buffer.");
 		}
 
+		// Hands finished background uploads over to the graphics queue before anything can read them
+		m_Device.GetUploader().RecordAcquireBarriers(commandBuffer);
+
+		// This frame slot has retired, so last time's timestamps are ready to read
+		m_GpuProfiler->BeginFrame(commandBuffer, m_CurrentFrameIndex);
+
 		return commandBuffer;
 	}
 
 	void VERenderer::EndFrame()
 	{
+		VE_PROFILE_FUNCTION();
 		assert(m_IsFrameStarted && "Can't call EndFrame while a frame is not in progress.");
 
 		auto commandBuffer = GetCurrentCommandBuffer();
@@ -119,11 +419,24 @@ namespace VulkanEngine {
 			throw std::runtime_error("Failed to record command buffer.");
 		}
 
-		auto result = m_SwapChain->SubmitCommandBuffers(&commandBuffer, &m_CurrentImageIndex);
+		m_FrameRingBuffer->Flush();
 
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_Window.WasWindowResized())
+		VkResult result;
 		{
-			m_Window.ResetWindowResizeFlag();
+			VE_PROFILE_SCOPE("Submit and present");
+			result = m_SwapChain->SubmitCommandBuffers(&commandBuffer, &m_CurrentImageIndex);
+		}
+
+		if (m_HasInputTime)
+		{
+			// Nothing else submits to the frame timeline, so its latest value is this frame
+			m_PendingLatencySamples.push_back({ m_Device.GetFrameTimeline().GetSubmittedValue(), m_InputTime });
+			m_HasInputTime = false;
+		}
+
+		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || (!IsHeadless() && m_Window->WasWindowResized()))
+		{
+			m_Window->ResetWindowResizeFlag();
 			RecreateSwapChain();
 		}
 		else if (result != VK_SUCCESS)
@@ -132,10 +445,10 @@ namespace VulkanEngine {
 		}
 
 		m_IsFrameStarted	= false;
-		m_CurrentFrameIndex	= (m_CurrentFrameIndex + 1) % VESwapChain::MAX_FRAMES_IN_FLIGHT;
+		m_CurrentFrameIndex	= (m_CurrentFrameIndex + 1) % m_Config.FramesInFlight;
 	}
 
-	void VERenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer)
+	void VERenderer::BeginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents)
 	{
 		assert(m_IsFrameStarted && "Can't call BeginSwapChainRenderPass while a frame is not in progress.");
 		assert(commandBuffer == GetCurrentCommandBuffer() && "Can't begin render pass on command buffer from a different frame");
@@ -157,8 +470,21 @@ namespace VulkanEngine {
 		renderPassInfo.clearValueCount		= static_cast<uint32_t>(clearValues.size());
 		renderPassInfo.pClearValues			= clearValues.data();
 
-		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		m_RenderPassScope = m_GpuProfiler->BeginScope(commandBuffer, "Render pass");
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+
+		m_SubpassContents = contents;
 
+		// With secondary contents the primary may only execute commands, each secondary sets its own
+		if (contents == VK_SUBPASS_CONTENTS_INLINE)
+		{
+			SetViewportAndScissor(commandBuffer);
+		}
+	}
+
+	void VERenderer::SetViewportAndScissor(VkCommandBuffer commandBuffer)
+	{
 		VkViewport viewport = {};
 
 		viewport.x							= 0.0f;
@@ -172,7 +498,6 @@ namespace VulkanEngine {
 
 		vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 		vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
-
 	}
 
 	void VERenderer::EndSwapChainRenderPass(VkCommandBuffer commandBuffer)
@@ -182,6 +507,7 @@ namespace VulkanEngine {
 
 		vkCmdEndRenderPass(commandBuffer);
 
+		m_GpuProfiler->EndScope(commandBuffer, m_RenderPassScope);
 	}
 
 }
\ No newline at end of file
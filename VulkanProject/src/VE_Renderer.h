@@ -1,18 +1,43 @@
 #pragma once
 #include "VE_Device.h"
+#include "VE_FrameRingBuffer.h"
+#include "VE_GpuProfiler.h"
 #include "VE_SwapChain.h"
+#include "VE_ThreadPool.h"
 #include "VE_Window.h"
 
 #include <cassert>
+#include <chrono>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace VulkanEngine {
 
+	// Time from MarkInputSampled until the frame built from that input finished on the GPU, in milliseconds
+	struct VELatencyStats
+	{
+		float MinMs						= 0.0f;
+		float AverageMs					= 0.0f;
+		float MaxMs						= 0.0f;
+		uint32_t SampleCount			= 0;
+	};
+
 	class VERenderer
 	{
 	public:
-		VERenderer(VEWindow& window, VEDevice& device);
+		// Records commandBuffer's share of a draw list, items [first, first + count)
+		using RecordChunkFunction = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+		// Below this many items per chunk the cost of an extra secondary buffer outweighs the parallelism
+		static constexpr uint32_t MIN_ITEMS_PER_CHUNK = 512;
+		// Frames the latency statistics are taken over
+		static constexpr uint32_t LATENCY_HISTORY_LENGTH = 120;
+
+		// Without a window the device has to be headless, frames then go to offscreen images of headlessExtent
+		VERenderer(VEWindow* window, VEDevice& device, const VESwapChainConfig& config = {}, VkExtent2D headlessExtent = { 0, 0 });
 		~VERenderer();
 
 		// Delete the copy constructor and copy operator
@@ -20,8 +45,26 @@ namespace VulkanEngine {
 		VERenderer& operator=(const VERenderer&) = delete;
 
 		VkRenderPass GetSwapChainRenderPass() const { return m_SwapChain->GetRenderPass(); }
+		VkExtent2D GetSwapChainExtent() const { return m_SwapChain->GetSwapChainExtent(); }
+		uint32_t GetFramesInFlight() const { return m_Config.FramesInFlight; }
+
+		// Recreates the swap chain, falls back to FIFO if the surface does not support presentMode
+		void SetPresentMode(VkPresentModeKHR presentMode);
+
+		// Low latency mode: blocks until the GPU has finished every submitted frame, so input polled right
+		// after goes into a frame that does not queue up behind older ones. Trades throughput for latency.
+		void WaitForLastSubmittedFrame();
+
+		// Call right after polling input, the next EndFrame is measured from here
+		void MarkInputSampled();
+		VELatencyStats GetLatencyStats() const;
+		void PrintLatencyStats() const;
 
 		bool IsFrameInProgress() const { return m_IsFrameStarted; }
+		bool IsHeadless() const { return m_Window == nullptr; }
+
+		// Headless only: writes the next frame to submit to path as a PPM image once the GPU is done with it
+		void RequestReadback(const std::string& path) { m_SwapChain->RequestReadback(path); }
 
 		VkCommandBuffer GetCurrentCommandBuffer() const 
 		{
@@ -29,29 +72,92 @@ namespace VulkanEngine {
 			return m_CommandBuffers[m_CurrentFrameIndex];
 		}
 
+		// Per-frame scratch memory for uniforms, instance data and other dynamic uploads
+		VEFrameRingBuffer& GetFrameRingBuffer() const
+		{
+			assert(m_IsFrameStarted && "Cannot get the frame ring buffer when the frame is not in progress.");
+			return *m_FrameRingBuffer;
+		}
+
+		// Times the render pass and every RecordParallel call given a scope name
+		VEGpuProfiler& GetGpuProfiler() const { return *m_GpuProfiler; }
+
 		uint32_t GetFrameIndex() const
 		{
 			assert(m_IsFrameStarted && "Cannot get frame index when the frame is not in progress.");
 			return m_CurrentFrameIndex;
 		}
 
+		// Frames begun so far, counting the current one. Tells systems with their own per frame buffers when a
+		// new frame has started.
+		uint64_t GetFrameNumber() const
+		{
+			assert(m_IsFrameStarted && "Cannot get frame number when the frame is not in progress.");
+			return m_FrameNumber;
+		}
+
 		VkCommandBuffer BeginFrame();
 		void EndFrame();
-		void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer);
+		// Pass VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS to record the pass with RecordParallel
+		void BeginSwapChainRenderPass(VkCommandBuffer commandBuffer, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
 		void EndSwapChainRenderPass(VkCommandBuffer commandBuffer);
 
+		// Splits itemCount items into chunks, records each into a secondary command buffer on a worker
+		// thread and executes them from commandBuffer in order. With a gpuScope name the GPU time from the
+		// first chunk's start to the last chunk's end is profiled.
+		void RecordParallel(VkCommandBuffer commandBuffer,
+			uint32_t itemCount,
+			const RecordChunkFunction& recordChunk,
+			const char* gpuScope = nullptr);
+
 	private:
+		// A command pool only ever touched by one thread at a time, along with the secondaries it owns
+		struct RecordingSlot
+		{
+			VkCommandPool CommandPool					= VK_NULL_HANDLE;
+			std::vector<VkCommandBuffer> CommandBuffers;
+			uint32_t UsedCount							= 0;
+		};
+
 		void CreateCommandBuffers();
 		void FreeCommandBuffers();
+		void CreateRecordingSlots();
+		void DestroyRecordingSlots();
+		void ResetRecordingSlots();
+		VkCommandBuffer BeginSecondaryCommandBuffer(RecordingSlot& slot);
+		void SetViewportAndScissor(VkCommandBuffer commandBuffer);
 		void RecreateSwapChain();
+		void ResolveLatencySamples();
 
 	private:
-		VEWindow& m_Window;
+		struct PendingLatencySample
+		{
+			uint64_t SubmitValue;
+			std::chrono::steady_clock::time_point InputTime;
+		};
+
+		VEWindow* m_Window;
+		VkExtent2D m_HeadlessExtent;
 		VEDevice& m_Device;
+		VESwapChainConfig m_Config;
 		std::unique_ptr<VESwapChain> m_SwapChain;
 		std::vector<VkCommandBuffer> m_CommandBuffers;
+		std::unique_ptr<VEFrameRingBuffer> m_FrameRingBuffer;
+		std::unique_ptr<VEGpuProfiler> m_GpuProfiler;
+		uint32_t m_RenderPassScope = VEGpuProfiler::INVALID_SCOPE;
 		uint32_t m_CurrentImageIndex;
 		uint32_t m_CurrentFrameIndex = 0;
+		uint64_t m_FrameNumber = 0;
 		bool m_IsFrameStarted = false;
+		VkSubpassContents m_SubpassContents = VK_SUBPASS_CONTENTS_INLINE;
+
+		// Slot 0 is recorded on the calling thread, the rest on m_RecordingThreads
+		VEThreadPool m_RecordingThreads;
+		std::vector<std::vector<RecordingSlot>> m_RecordingSlots;	// [frame in flight][slot]
+
+		std::chrono::steady_clock::time_point m_InputTime;
+		bool m_HasInputTime = false;
+		std::deque<PendingLatencySample> m_PendingLatencySamples;		// Submitted, oldest first
+		std::deque<float> m_LatencyHistory;								// Milliseconds, oldest first
 	};
 }
\ No newline at end of file
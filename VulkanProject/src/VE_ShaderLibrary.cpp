@@ -0,0 +1,174 @@
+#include "VE_ShaderLibrary.h"
+
+#include <stdexcept>
+
+#ifdef VE_EMBED_SHADERS
+// Generated by the shader build step, glslangValidator --vn Code writes each one as "const uint32_t Code[]".
+// The arrays are constant initialized data in the executable, uint32_t aligned as pCode requires.
+namespace VulkanEngine {
+	namespace EmbeddedShaders {
+		namespace DrawListShaderFrag {
+#include "../Shaders/DrawList_Shader.frag.h"
+		}
+		namespace DrawListShaderVert {
+#include "../Shaders/DrawList_Shader.vert.h"
+		}
+		namespace ParticleShaderFrag {
+#include "../Shaders/Particle_Shader.frag.h"
+		}
+		namespace ParticleShaderVert {
+#include "../Shaders/Particle_Shader.vert.h"
+		}
+		namespace ParticleSimulateComp {
+#include "../Shaders/Particle_Simulate.comp.h"
+		}
+		namespace SdfShaderFrag {
+#include "../Shaders/Sdf_Shader.frag.h"
+		}
+		namespace SdfShaderVert {
+#include "../Shaders/Sdf_Shader.vert.h"
+		}
+		namespace SimpleBindlessShaderFrag {
+#include "../Shaders/Simple_Bindless_Shader.frag.h"
+		}
+		namespace SimpleShaderFrag {
+#include "../Shaders/Simple_Shader.frag.h"
+		}
+		namespace SimpleShaderVert {
+#include "../Shaders/Simple_Shader.vert.h"
+		}
+		namespace SpriteShaderFrag {
+#include "../Shaders/Sprite_Shader.frag.h"
+		}
+		namespace SpriteShaderVert {
+#include "../Shaders/Sprite_Shader.vert.h"
+		}
+		namespace VectorFieldShaderFrag {
+#include "../Shaders/VectorField_Shader.frag.h"
+		}
+		namespace VectorFieldShaderVert {
+#include "../Shaders/VectorField_Shader.vert.h"
+		}
+
+		struct EmbeddedShader
+		{
+			const char* Name;
+			const uint32_t* Code;
+			size_t Size;
+		};
+
+#define VE_EMBEDDED_SHADER(name, code) { name, code::Code, sizeof(code::Code) }
+
+		const EmbeddedShader SHADERS[] = {
+			VE_EMBEDDED_SHADER("DrawList_Shader.frag", DrawListShaderFrag),
+			VE_EMBEDDED_SHADER("DrawList_Shader.vert", DrawListShaderVert),
+			VE_EMBEDDED_SHADER("Particle_Shader.frag", ParticleShaderFrag),
+			VE_EMBEDDED_SHADER("Particle_Shader.vert", ParticleShaderVert),
+			VE_EMBEDDED_SHADER("Particle_Simulate.comp", ParticleSimulateComp),
+			VE_EMBEDDED_SHADER("Sdf_Shader.frag", SdfShaderFrag),
+			VE_EMBEDDED_SHADER("Sdf_Shader.vert", SdfShaderVert),
+			VE_EMBEDDED_SHADER("Simple_Bindless_Shader.frag", SimpleBindlessShaderFrag),
+			VE_EMBEDDED_SHADER("Simple_Shader.frag", SimpleShaderFrag),
+			VE_EMBEDDED_SHADER("Simple_Shader.vert", SimpleShaderVert),
+			VE_EMBEDDED_SHADER("Sprite_Shader.frag", SpriteShaderFrag),
+			VE_EMBEDDED_SHADER("Sprite_Shader.vert", SpriteShaderVert),
+			VE_EMBEDDED_SHADER("VectorField_Shader.frag", VectorFieldShaderFrag),
+			VE_EMBEDDED_SHADER("VectorField_Shader.vert", VectorFieldShaderVert),
+		};
+
+#undef VE_EMBEDDED_SHADER
+	}
+}
+#endif
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VEShaderLibrary::SPIRV_MAGIC;
+
+	VEShaderLibrary::VEShaderLibrary()
+	{
+		if (!HasEmbeddedShaders())
+		{
+			m_ShaderDirectory = "Shaders";
+		}
+	}
+
+	VEShaderLibrary::~VEShaderLibrary()
+	{
+
+	}
+
+	bool VEShaderLibrary::HasEmbeddedShaders()
+	{
+#ifdef VE_EMBED_SHADERS
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	void VEShaderLibrary::SetShaderDirectory(const std::string& directory)
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		if (directory.empty() && !HasEmbeddedShaders())
+		{
+			throw std::runtime_error("Shaders are not embedded in this build, a shader directory is required.");
+		}
+
+		m_ShaderDirectory = directory;
+	}
+
+	std::string VEShaderLibrary::GetShaderDirectory() const
+	{
+		std::lock_guard<std::mutex> lock{ m_Mutex };
+
+		return m_ShaderDirectory;
+	}
+
+	VEShaderCode VEShaderLibrary::Load(const std::string& name) const
+	{
+		std::string directory = GetShaderDirectory();
+
+		VEShaderCode shader = directory.empty() ? LoadEmbedded(name) : LoadFile(directory + "/" + name + ".spv");
+
+		if (shader.Size < sizeof(uint32_t) || shader.Size % sizeof(uint32_t) != 0 || shader.Code[0] != SPIRV_MAGIC)
+		{
+			throw std::runtime_error("Not a SPIR-V module: " + name);
+		}
+
+		return shader;
+	}
+
+	VEShaderCode VEShaderLibrary::LoadEmbedded(const std::string& name) const
+	{
+		VEShaderCode shader;
+
+#ifdef VE_EMBED_SHADERS
+		for (const auto& embedded : EmbeddedShaders::SHADERS)
+		{
+			if (name == embedded.Name)
+			{
+				shader.Code = embedded.Code;
+				shader.Size = embedded.Size;
+
+				return shader;
+			}
+		}
+#endif
+
+		throw std::runtime_error("No embedded shader named " + name);
+	}
+
+	VEShaderCode VEShaderLibrary::LoadFile(const std::string& path) const
+	{
+		VEShaderCode shader;
+
+		shader.File = std::make_shared<VEMappedFile>(path);
+		// Mappings start on a page boundary, so the words are aligned without a copy
+		shader.Code = reinterpret_cast<const uint32_t*>(shader.File->GetData());
+		shader.Size = shader.File->GetSize();
+
+		return shader;
+	}
+}
\ No newline at end of file
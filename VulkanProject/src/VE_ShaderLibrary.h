@@ -0,0 +1,54 @@
+#pragma once
+#include "VE_MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace VulkanEngine {
+
+	// SPIR-V words ready to hand to vkCreateShaderModule as pCode, valid while the VEShaderCode is alive
+	struct VEShaderCode
+	{
+		const uint32_t* Code		= nullptr;
+		size_t Size					= 0;	// In bytes, a multiple of 4
+		// Keeps mapped code alive, null for embedded shaders
+		std::shared_ptr<VEMappedFile> File;
+	};
+
+	// Finds shaders by their source file name, e.g. "Simple_Shader.vert". With VE_EMBED_SHADERS defined the
+	// build compiles every shader into the executable and they are served from there, startup touches no files.
+	// Setting a shader directory maps <directory>/<name>.spv instead, a new mapping on every load so edited
+	// shaders are picked up by the next pipeline created. Without embedded shaders the directory is "Shaders".
+	class VEShaderLibrary
+	{
+	public:
+		// SPIR-V starts with this word, in host byte order
+		static constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+
+		VEShaderLibrary();
+		~VEShaderLibrary();
+
+		// Delete the copy constructor and copy operator
+		VEShaderLibrary(const VEShaderLibrary&) = delete;
+		VEShaderLibrary& operator=(const VEShaderLibrary&) = delete;
+
+		VEShaderCode Load(const std::string& name) const;
+
+		// Empty goes back to the embedded shaders, when there are any
+		void SetShaderDirectory(const std::string& directory);
+		std::string GetShaderDirectory() const;
+
+		static bool HasEmbeddedShaders();
+
+	private:
+		VEShaderCode LoadEmbedded(const std::string& name) const;
+		VEShaderCode LoadFile(const std::string& path) const;
+
+	private:
+		std::string m_ShaderDirectory;
+		mutable std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,231 @@
+#include "VE_SpatialGrid.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VESpatialGrid::INVALID_ID;
+
+	VESpatialGrid::VESpatialGrid(float cellSize)
+		: m_CellSize{ cellSize }, m_InverseCellSize{ 1.0f / cellSize }
+	{
+		assert(cellSize > 0.0f && "Spatial grid cell size must be positive");
+	}
+
+	int32_t VESpatialGrid::CellCoordinate(float value) const
+	{
+		// Clamped so very large query rectangles can't overflow the cell coordinates
+		return static_cast<int32_t>(std::fmax(std::fmin(std::floor(value * m_InverseCellSize), 1.0e9f), -1.0e9f));
+	}
+
+	uint64_t VESpatialGrid::CellKey(int32_t x, int32_t y) const
+	{
+		return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+	}
+
+	uint64_t VESpatialGrid::CellKeyForPoint(glm::vec2 point) const
+	{
+		return CellKey(CellCoordinate(point.x), CellCoordinate(point.y));
+	}
+
+	void VESpatialGrid::AddToCell(uint32_t id, uint64_t key)
+	{
+		auto& cell = m_Cells[key];
+
+		m_Entries[id].CellKey		= key;
+		m_Entries[id].CellIndex		= static_cast<uint32_t>(cell.size());
+
+		cell.push_back(id);
+	}
+
+	void VESpatialGrid::RemoveFromCell(uint32_t id)
+	{
+		Entry& entry = m_Entries[id];
+
+		auto it = m_Cells.find(entry.CellKey);
+		assert(it != m_Cells.end() && "Spatial grid entry points at a missing cell");
+
+		// Swap with the last id so the removal is O(1)
+		auto& cell = it->second;
+		uint32_t movedId = cell.back();
+		cell[entry.CellIndex] = movedId;
+		m_Entries[movedId].CellIndex = entry.CellIndex;
+		cell.pop_back();
+
+		if (cell.empty())
+		{
+			m_Cells.erase(it);
+		}
+
+		entry.CellIndex = INVALID_ID;
+	}
+
+	void VESpatialGrid::Insert(uint32_t id, const VEBounds2D& bounds)
+	{
+		assert(id != INVALID_ID && "INVALID_ID can't be used as a spatial grid id");
+		assert(!Contains(id) && "Id is already in the spatial grid");
+
+		if (id >= m_Entries.size())
+		{
+			m_Entries.resize(id + 1);
+		}
+
+		m_Entries[id].Bounds = bounds;
+		m_LooseMargin = glm::max(m_LooseMargin, bounds.HalfExtent());
+
+		AddToCell(id, CellKeyForPoint(bounds.Center()));
+		m_Count++;
+	}
+
+	void VESpatialGrid::Update(uint32_t id, const VEBounds2D& bounds)
+	{
+		assert(Contains(id) && "Id is not in the spatial grid");
+
+		m_Entries[id].Bounds = bounds;
+		m_LooseMargin = glm::max(m_LooseMargin, bounds.HalfExtent());
+
+		uint64_t key = CellKeyForPoint(bounds.Center());
+
+		if (key != m_Entries[id].CellKey)
+		{
+			RemoveFromCell(id);
+			AddToCell(id, key);
+		}
+	}
+
+	void VESpatialGrid::Remove(uint32_t id)
+	{
+		assert(Contains(id) && "Id is not in the spatial grid");
+
+		RemoveFromCell(id);
+		m_Count--;
+	}
+
+	void VESpatialGrid::Clear()
+	{
+		m_Entries.clear();
+		m_Cells.clear();
+		m_LooseMargin = glm::vec2(0.0f);
+		m_Count = 0;
+	}
+
+	template<typename Visitor>
+	void VESpatialGrid::ForEachCandidate(const VEBounds2D& rect, Visitor visit) const
+	{
+		int32_t minX = CellCoordinate(rect.Min.x - m_LooseMargin.x);
+		int32_t minY = CellCoordinate(rect.Min.y - m_LooseMargin.y);
+		int32_t maxX = CellCoordinate(rect.Max.x + m_LooseMargin.x);
+		int32_t maxY = CellCoordinate(rect.Max.y + m_LooseMargin.y);
+
+		// A huge rectangle over a sparse grid is cheaper to answer by walking the occupied cells
+		uint64_t cellSpan = static_cast<uint64_t>(static_cast<int64_t>(maxX) - minX + 1) * static_cast<uint64_t>(static_cast<int64_t>(maxY) - minY + 1);
+
+		if (cellSpan > m_Cells.size())
+		{
+			for (const auto& cell : m_Cells)
+			{
+				int32_t x = static_cast<int32_t>(static_cast<uint32_t>(cell.first >> 32));
+				int32_t y = static_cast<int32_t>(static_cast<uint32_t>(cell.first));
+
+				if (x < minX || x > maxX || y < minY || y > maxY)
+				{
+					continue;
+				}
+
+				for (uint32_t id : cell.second)
+				{
+					visit(id);
+				}
+			}
+			return;
+		}
+
+		for (int32_t x = minX; x <= maxX; x++)
+		{
+			for (int32_t y = minY; y <= maxY; y++)
+			{
+				auto it = m_Cells.find(CellKey(x, y));
+
+				if (it == m_Cells.end())
+				{
+					continue;
+				}
+
+				for (uint32_t id : it->second)
+				{
+					visit(id);
+				}
+			}
+		}
+	}
+
+	void VESpatialGrid::QueryRect(const VEBounds2D& rect, std::vector<uint32_t>& results) const
+	{
+		ForEachCandidate(rect, [&](uint32_t id)
+		{
+			if (m_Entries[id].Bounds.Overlaps(rect))
+			{
+				results.push_back(id);
+			}
+		});
+	}
+
+	void VESpatialGrid::QueryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& results) const
+	{
+		VEBounds2D rect{ center - glm::vec2(radius), center + glm::vec2(radius) };
+		float radiusSquared = radius * radius;
+
+		ForEachCandidate(rect, [&](uint32_t id)
+		{
+			if (m_Entries[id].Bounds.DistanceSquared(center) <= radiusSquared)
+			{
+				results.push_back(id);
+			}
+		});
+	}
+
+	uint32_t VESpatialGrid::QueryNearest(glm::vec2 point, float maxDistance) const
+	{
+		if (m_Count == 0)
+		{
+			return INVALID_ID;
+		}
+
+		uint32_t nearestId = INVALID_ID;
+		float nearestDistanceSquared = maxDistance < std::numeric_limits<float>::max() ? maxDistance * maxDistance : std::numeric_limits<float>::max();
+
+		// Grow the search square ring by ring until it covers the best hit found so far
+		float searchRadius = m_CellSize;
+
+		while (true)
+		{
+			float clampedRadius = std::fmin(searchRadius, maxDistance);
+			VEBounds2D rect{ point - glm::vec2(clampedRadius), point + glm::vec2(clampedRadius) };
+
+			ForEachCandidate(rect, [&](uint32_t id)
+			{
+				float distanceSquared = m_Entries[id].Bounds.DistanceSquared(point);
+
+				if (distanceSquared <= nearestDistanceSquared)
+				{
+					nearestDistanceSquared = distanceSquared;
+					nearestId = id;
+				}
+			});
+
+			// Anything outside the searched square is at least clampedRadius away
+			if (nearestId != INVALID_ID && nearestDistanceSquared <= clampedRadius * clampedRadius)
+			{
+				return nearestId;
+			}
+
+			if (clampedRadius >= maxDistance)
+			{
+				return nearestId;
+			}
+
+			searchRadius *= 2.0f;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+#include "VE_Bounds2D.h"
+
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Loose uniform grid over 2D bounds. Every entry lives in the one cell that holds its center,
+	// and queries widen their search by the largest half extent inserted so far to catch overlaps.
+	// Cells are hashed, so the world does not need fixed limits.
+	//
+	// Entries are keyed by a caller chosen id, typically the object's index in its vector. Ids
+	// should be dense, they index straight into an array.
+	class VESpatialGrid
+	{
+	public:
+		static constexpr uint32_t INVALID_ID = std::numeric_limits<uint32_t>::max();
+
+		explicit VESpatialGrid(float cellSize);
+
+		// Delete the copy constructor and copy operator
+		VESpatialGrid(const VESpatialGrid&) = delete;
+		VESpatialGrid& operator=(const VESpatialGrid&) = delete;
+
+		void Insert(uint32_t id, const VEBounds2D& bounds);
+		// Cheap when the entry stays in the same cell, which is the common case for moving objects
+		void Update(uint32_t id, const VEBounds2D& bounds);
+		void Remove(uint32_t id);
+		void Clear();
+
+		bool Contains(uint32_t id) const { return id < m_Entries.size() && m_Entries[id].CellIndex != INVALID_ID; }
+		uint32_t GetCount() const { return m_Count; }
+
+		// Appends the ids of every entry whose bounds overlap the rectangle
+		void QueryRect(const VEBounds2D& rect, std::vector<uint32_t>& results) const;
+		// Appends the ids of every entry whose bounds come within radius of center
+		void QueryRadius(glm::vec2 center, float radius, std::vector<uint32_t>& results) const;
+		// Closest entry by distance to its bounds, INVALID_ID if none is within maxDistance
+		uint32_t QueryNearest(glm::vec2 point, float maxDistance = std::numeric_limits<float>::max()) const;
+
+	private:
+		struct Entry
+		{
+			VEBounds2D Bounds;
+			uint64_t CellKey				= 0;
+			uint32_t CellIndex				= INVALID_ID;	// Position inside the cell's id list
+		};
+
+		int32_t CellCoordinate(float value) const;
+		uint64_t CellKey(int32_t x, int32_t y) const;
+		uint64_t CellKeyForPoint(glm::vec2 point) const;
+
+		void AddToCell(uint32_t id, uint64_t key);
+		void RemoveFromCell(uint32_t id);
+
+		// Calls visit(id) for every entry in cells touched by the rectangle widened by the loose margin
+		template<typename Visitor>
+		void ForEachCandidate(const VEBounds2D& rect, Visitor visit) const;
+
+	private:
+		float m_CellSize;
+		float m_InverseCellSize;
+		// Largest half extent ever inserted, how far an entry can stick out of its cell
+		glm::vec2 m_LooseMargin{ 0.0f };
+		uint32_t m_Count = 0;
+
+		std::vector<Entry> m_Entries;
+		std::unordered_map<uint64_t, std::vector<uint32_t>> m_Cells;
+	};
+}
\ No newline at end of file
@@ -1,8 +1,10 @@
 #include "VE_SwapChain.h"
 
 #include <array>
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <limits>
 #include <set>
@@ -10,33 +12,56 @@
 
 namespace VulkanEngine {
 
-    VESwapChain::VESwapChain(VEDevice& deviceRef, VkExtent2D extent)
-        : m_Device{ deviceRef }, m_WindowExtent{ extent }
+    VESwapChain::VESwapChain(VEDevice& deviceRef, VkExtent2D extent, const VESwapChainConfig& config)
+        : m_Device{ deviceRef }, m_WindowExtent{ extent }, m_Config{ config }
     {
         Init();
     }
 
-    VESwapChain::VESwapChain(VEDevice& deviceRef, VkExtent2D extent, std::shared_ptr<VESwapChain> previous)
-        : m_Device{ deviceRef }, m_WindowExtent{ extent }, m_OldSwapChain{ previous }
+    VESwapChain::VESwapChain(VEDevice& deviceRef, VkExtent2D extent, const VESwapChainConfig& config, std::shared_ptr<VESwapChain> previous)
+        : m_Device{ deviceRef }, m_WindowExtent{ extent }, m_Config{ config }, m_OldSwapChain{ previous }
     {
         Init();
 
-        // Clean up old SwapChain since it's no longer needed
+        // Frames submitted through the old chain are still in flight, keep waiting on them per frame slot
+        // so the renderer's per frame resources are not reused early
+        m_FrameSubmitValues                             = m_OldSwapChain->m_FrameSubmitValues;
+        m_CurrentFrame                                  = m_OldSwapChain->m_CurrentFrame;
+
+        // The old chain is retired now, the caller keeps it alive until its frames have finished
         m_OldSwapChain = nullptr;
     }
 
     void VESwapChain::Init()
     {
+        assert(m_Config.FramesInFlight >= 1 && m_Config.FramesInFlight <= MAX_FRAMES_IN_FLIGHT && "Unsupported number of frames in flight.");
+
         CreateSwapChain();
         CreateImageViews();
-        CreateRenderPass();
         CreateDepthResources();
+        CreateRenderPass();
         CreateFramebuffers();
         CreateSyncObjects();
     }
 
     VESwapChain::~VESwapChain()
     {
+        if (IsHeadless())
+        {
+            // Nothing presents, so pending frames have to be waited out before their images and readbacks go away
+            m_Device.GetFrameTimeline().Wait(m_Device.GetFrameTimeline().GetSubmittedValue());
+
+            for (auto& readback : m_Readbacks)
+            {
+                FinishReadback(readback);
+
+                vkFreeCommandBuffers(m_Device.Device(), m_Device.GetCommandPool(), 1, &readback.CommandBuffer);
+                m_Device.DestroyBuffer(readback.Buffer, readback.Allocation);
+            }
+
+            m_Readbacks.clear();
+        }
+
         for (auto imageView : m_SwapChainImageViews)
         {
             vkDestroyImageView(m_Device.Device(), imageView, nullptr);
@@ -49,11 +74,15 @@ namespace VulkanEngine {
             m_SwapChain = nullptr;
         }
 
+        for (size_t i = 0; i < m_OffscreenImageAllocations.size(); i++)
+        {
+            m_Device.DestroyImage(m_SwapChainImages[i], m_OffscreenImageAllocations[i]);
+        }
+
         for (int i = 0; i < m_DepthImages.size(); i++)
         {
             vkDestroyImageView(m_Device.Device(), m_DepthImageViews[i], nullptr);
-            vkDestroyImage(m_Device.Device(), m_DepthImages[i], nullptr);
-            vkFreeMemory(m_Device.Device(), m_DepthImageMemorys[i], nullptr);
+            m_Device.DestroyImage(m_DepthImages[i], m_DepthImageAllocations[i]);
         }
 
         for (auto framebuffer : m_SwapChainFramebuffers)
@@ -64,21 +93,27 @@ namespace VulkanEngine {
         vkDestroyRenderPass(m_Device.Device(), m_RenderPass, nullptr);
 
         // cleanup synchronization objects
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        for (size_t i = 0; i < m_ImageAvailableSemaphores.size(); i++)
         {
             vkDestroySemaphore(m_Device.Device(), m_RenderFinishedSemaphores[i], nullptr);
             vkDestroySemaphore(m_Device.Device(), m_ImageAvailableSemaphores[i], nullptr);
-            vkDestroyFence(m_Device.Device(), m_InFlightFences[i], nullptr);
         }
     }
 
     VkResult VESwapChain::AcquireNextImage(uint32_t* imageIndex)
     {
-        vkWaitForFences(m_Device.Device(),
-            1,
-            &m_InFlightFences[m_CurrentFrame],
-            VK_TRUE,
-            std::numeric_limits<uint64_t>::max());
+        // The frame that last used this slot has to be done with its semaphores and command buffer
+        m_Device.GetFrameTimeline().Wait(m_FrameSubmitValues[m_CurrentFrame]);
+
+        if (IsHeadless())
+        {
+            FinishReadback(m_Readbacks[m_CurrentFrame]);
+
+            *imageIndex = m_NextOffscreenImage;
+            m_NextOffscreenImage = (m_NextOffscreenImage + 1) % ImageCount();
+
+            return VK_SUCCESS;
+        }
 
         VkResult result = vkAcquireNextImageKHR(m_Device.Device(),
             m_SwapChain,
@@ -92,12 +127,45 @@ namespace VulkanEngine {
 
     VkResult VESwapChain::SubmitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex)
     {
-        if (m_ImagesInFlight[*imageIndex] != VK_NULL_HANDLE)
+        // Only blocks when the image came back before the frame that last rendered to it finished,
+        // usually that frame is already known complete and this returns without calling the driver
+        m_Device.GetFrameTimeline().Wait(m_ImageSubmitValues[*imageIndex]);
+
+        if (IsHeadless())
         {
-            vkWaitForFences(m_Device.Device(), 1, &m_ImagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-        }
+            std::array<VkCommandBuffer, 2> commandBuffers   = { buffers[0], VK_NULL_HANDLE };
+            uint32_t commandBufferCount                     = 1;
 
-        m_ImagesInFlight[*imageIndex]                   = m_InFlightFences[m_CurrentFrame];
+            if (!m_RequestedReadbackPath.empty())
+            {
+                Readback& readback = m_Readbacks[m_CurrentFrame];
+
+                RecordReadback(readback, *imageIndex);
+                readback.Path = std::move(m_RequestedReadbackPath);
+                m_RequestedReadbackPath.clear();
+
+                commandBuffers[commandBufferCount++] = readback.CommandBuffer;
+            }
+
+            VkSubmitInfo submitInfo = {};
+
+            submitInfo.sType                            = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+            submitInfo.commandBufferCount               = commandBufferCount;
+            submitInfo.pCommandBuffers                  = commandBuffers.data();
+
+            uint64_t submitValue = 0;
+
+            if (m_Device.GetFrameTimeline().Submit(m_Device.GraphicsQueue(), submitInfo, &submitValue) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to submit draw command buffer!");
+            }
+
+            m_FrameSubmitValues[m_CurrentFrame]         = submitValue;
+            m_ImageSubmitValues[*imageIndex]            = submitValue;
+            m_CurrentFrame                              = (m_CurrentFrame + 1) % m_Config.FramesInFlight;
+
+            return VK_SUCCESS;
+        }
 
         VkSubmitInfo submitInfo = {};
 
@@ -116,13 +184,16 @@ namespace VulkanEngine {
         submitInfo.signalSemaphoreCount                 = 1;
         submitInfo.pSignalSemaphores                    = signalSemaphores;
 
-        vkResetFences(m_Device.Device(), 1, &m_InFlightFences[m_CurrentFrame]);
+        uint64_t submitValue = 0;
 
-        if (vkQueueSubmit(m_Device.GraphicsQueue(), 1, &submitInfo, m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS)
+        if (m_Device.GetFrameTimeline().Submit(m_Device.GraphicsQueue(), submitInfo, &submitValue) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to submit draw command buffer!");
         }
 
+        m_FrameSubmitValues[m_CurrentFrame]             = submitValue;
+        m_ImageSubmitValues[*imageIndex]                = submitValue;
+
         VkPresentInfoKHR presentInfo = {};
 
         presentInfo.sType                               = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -138,13 +209,19 @@ namespace VulkanEngine {
 
         auto result = vkQueuePresentKHR(m_Device.PresentQueue(), &presentInfo);
 
-        m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+        m_CurrentFrame = (m_CurrentFrame + 1) % m_Config.FramesInFlight;
 
         return result;
     }
 
     void VESwapChain::CreateSwapChain()
     {
+        if (IsHeadless())
+        {
+            CreateOffscreenImages();
+            return;
+        }
+
         SwapChainSupportDetails SwapChainSupport        = m_Device.GetSwapChainSupport();
 
         VkSurfaceFormatKHR surfaceFormat                = ChooseSwapSurfaceFormat(SwapChainSupport.Formats);
@@ -211,6 +288,180 @@ namespace VulkanEngine {
         m_SwapChainExtent                               = extent;
     }
 
+    void VESwapChain::CreateOffscreenImages()
+    {
+        // Same format a window surface usually ends up with, so pipelines are compatible in both modes
+        m_SwapChainImageFormat                          = VK_FORMAT_B8G8R8A8_UNORM;
+        m_SwapChainExtent                               = m_WindowExtent;
+
+        // Matches the usual minImageCount + 1 of a real swap chain
+        uint32_t imageCount                             = m_Config.FramesInFlight + 1;
+
+        m_SwapChainImages.resize(imageCount);
+        m_OffscreenImageAllocations.resize(imageCount);
+
+        for (uint32_t i = 0; i < imageCount; i++)
+        {
+            VkImageCreateInfo imageInfo = {};
+
+            imageInfo.sType                             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType                         = VK_IMAGE_TYPE_2D;
+            imageInfo.extent.width                      = m_SwapChainExtent.width;
+            imageInfo.extent.height                     = m_SwapChainExtent.height;
+            imageInfo.extent.depth                      = 1;
+            imageInfo.mipLevels                         = 1;
+            imageInfo.arrayLayers                       = 1;
+            imageInfo.format                            = m_SwapChainImageFormat;
+            imageInfo.tiling                            = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout                     = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage                             = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+            imageInfo.samples                           = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode                       = VK_SHARING_MODE_EXCLUSIVE;
+
+            m_Device.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_SwapChainImages[i], m_OffscreenImageAllocations[i]);
+        }
+
+        VkDeviceSize readbackSize                       = static_cast<VkDeviceSize>(m_SwapChainExtent.width) * m_SwapChainExtent.height * 4;
+
+        VkCommandBufferAllocateInfo allocInfo = {};
+
+        allocInfo.sType                                 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.level                                 = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandPool                           = m_Device.GetCommandPool();
+        allocInfo.commandBufferCount                    = 1;
+
+        m_Readbacks.resize(m_Config.FramesInFlight);
+
+        for (auto& readback : m_Readbacks)
+        {
+            m_Device.CreateBuffer(readbackSize,
+                VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                readback.Buffer,
+                readback.Allocation);
+
+            if (vkAllocateCommandBuffers(m_Device.Device(), &allocInfo, &readback.CommandBuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to allocate readback command buffer!");
+            }
+        }
+
+        std::cout << "Present mode: Headless (" << m_SwapChainExtent.width << "x" << m_SwapChainExtent.height << ")" << std::endl;
+    }
+
+    void VESwapChain::RequestReadback(const std::string& path)
+    {
+        assert(IsHeadless() && "Readback is only available on headless swap chains.");
+
+        m_RequestedReadbackPath = path;
+    }
+
+    void VESwapChain::RecordReadback(Readback& readback, uint32_t imageIndex)
+    {
+        VkCommandBufferBeginInfo beginInfo = {};
+
+        beginInfo.sType                                 = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags                                 = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        vkBeginCommandBuffer(readback.CommandBuffer, &beginInfo);
+
+        // The render pass already left the image in TRANSFER_SRC, only its writes still need to be waited for
+        VkImageMemoryBarrier imageBarrier = {};
+
+        imageBarrier.sType                              = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        imageBarrier.oldLayout                          = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageBarrier.newLayout                          = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        imageBarrier.srcAccessMask                      = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        imageBarrier.dstAccessMask                      = VK_ACCESS_TRANSFER_READ_BIT;
+        imageBarrier.srcQueueFamilyIndex                = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.dstQueueFamilyIndex                = VK_QUEUE_FAMILY_IGNORED;
+        imageBarrier.image                              = m_SwapChainImages[imageIndex];
+        imageBarrier.subresourceRange.aspectMask        = VK_IMAGE_ASPECT_COLOR_BIT;
+        imageBarrier.subresourceRange.baseMipLevel      = 0;
+        imageBarrier.subresourceRange.levelCount        = 1;
+        imageBarrier.subresourceRange.baseArrayLayer    = 0;
+        imageBarrier.subresourceRange.layerCount        = 1;
+
+        vkCmdPipelineBarrier(readback.CommandBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &imageBarrier);
+
+        VkBufferImageCopy region = {};
+
+        region.imageSubresource.aspectMask              = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount              = 1;
+        region.imageExtent                              = { m_SwapChainExtent.width, m_SwapChainExtent.height, 1 };
+
+        vkCmdCopyImageToBuffer(readback.CommandBuffer,
+            m_SwapChainImages[imageIndex],
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            readback.Buffer,
+            1,
+            &region);
+
+        VkBufferMemoryBarrier bufferBarrier = {};
+
+        bufferBarrier.sType                             = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        bufferBarrier.srcAccessMask                     = VK_ACCESS_TRANSFER_WRITE_BIT;
+        bufferBarrier.dstAccessMask                     = VK_ACCESS_HOST_READ_BIT;
+        bufferBarrier.srcQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.dstQueueFamilyIndex               = VK_QUEUE_FAMILY_IGNORED;
+        bufferBarrier.buffer                            = readback.Buffer;
+        bufferBarrier.offset                            = 0;
+        bufferBarrier.size                              = VK_WHOLE_SIZE;
+
+        vkCmdPipelineBarrier(readback.CommandBuffer,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            VK_PIPELINE_STAGE_HOST_BIT,
+            0, 0, nullptr, 1, &bufferBarrier, 0, nullptr);
+
+        vkEndCommandBuffer(readback.CommandBuffer);
+    }
+
+    void VESwapChain::FinishReadback(Readback& readback)
+    {
+        if (readback.Path.empty())
+        {
+            return;
+        }
+
+        std::ofstream file{ readback.Path, std::ios::binary };
+
+        if (!file.is_open())
+        {
+            std::cerr << "readback: failed to open " << readback.Path << std::endl;
+            readback.Path.clear();
+            return;
+        }
+
+        uint32_t width = m_SwapChainExtent.width;
+        uint32_t height = m_SwapChainExtent.height;
+
+        file << "P6\n" << width << " " << height << "\n255\n";
+
+        // BGRA texels to RGB, one row at a time
+        const uint8_t* pixels = static_cast<const uint8_t*>(readback.Allocation.MappedData);
+        std::vector<char> row(width * 3);
+
+        for (uint32_t y = 0; y < height; y++)
+        {
+            for (uint32_t x = 0; x < width; x++)
+            {
+                const uint8_t* texel = pixels + (static_cast<size_t>(y) * width + x) * 4;
+
+                row[x * 3 + 0] = static_cast<char>(texel[2]);
+                row[x * 3 + 1] = static_cast<char>(texel[1]);
+                row[x * 3 + 2] = static_cast<char>(texel[0]);
+            }
+
+            file.write(row.data(), row.size());
+        }
+
+        std::cout << "readback: wrote " << readback.Path << std::endl;
+        readback.Path.clear();
+    }
+
     void VESwapChain::CreateImageViews()
     {
         m_SwapChainImageViews.resize(m_SwapChainImages.size());
@@ -241,7 +492,7 @@ namespace VulkanEngine {
     {
         VkAttachmentDescription depthAttachment = {};
 
-        depthAttachment.format                          = FindDepthFormat();
+        depthAttachment.format                          = m_SwapChainDepthFormat;
         depthAttachment.samples                         = VK_SAMPLE_COUNT_1_BIT;
         depthAttachment.loadOp                          = VK_ATTACHMENT_LOAD_OP_CLEAR;
         depthAttachment.storeOp                         = VK_ATTACHMENT_STORE_OP_DONT_CARE;
@@ -264,7 +515,8 @@ namespace VulkanEngine {
         colorAttachment.stencilStoreOp                  = VK_ATTACHMENT_STORE_OP_DONT_CARE;
         colorAttachment.stencilLoadOp                   = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
         colorAttachment.initialLayout                   = VK_IMAGE_LAYOUT_UNDEFINED;
-        colorAttachment.finalLayout                     = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+        // Headless images are only ever read back, never presented
+        colorAttachment.finalLayout                     = IsHeadless() ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
         VkAttachmentReference colorAttachmentRef = {};
 
@@ -276,7 +528,7 @@ namespace VulkanEngine {
         subpass.pipelineBindPoint                       = VK_PIPELINE_BIND_POINT_GRAPHICS;
         subpass.colorAttachmentCount                    = 1;
         subpass.pColorAttachments                       = &colorAttachmentRef;
-        subpass.pDepthStencilAttachment                 = &depthAttachmentRef;
+        subpass.pDepthStencilAttachment                 = HasDepthBuffer() ? &depthAttachmentRef : nullptr;
 
         VkSubpassDependency dependency = {};
 
@@ -295,7 +547,7 @@ namespace VulkanEngine {
         VkRenderPassCreateInfo renderPassInfo = {};
 
         renderPassInfo.sType                            = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-        renderPassInfo.attachmentCount                  = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.attachmentCount                  = HasDepthBuffer() ? 2 : 1;
         renderPassInfo.pAttachments                     = attachments.data();
         renderPassInfo.subpassCount                     = 1;
         renderPassInfo.pSubpasses                       = &subpass;
@@ -310,43 +562,61 @@ namespace VulkanEngine {
 
     void VESwapChain::CreateFramebuffers()
     {
-        m_SwapChainFramebuffers.resize(ImageCount());
-
-        for (size_t i = 0; i < ImageCount(); i++)
-        {
-            std::array<VkImageView, 2> attachments      = { m_SwapChainImageViews[i], m_DepthImageViews[i] };
+        // Without depth the color image is the only attachment, so one framebuffer per image will do
+        size_t depthCount                               = std::max<size_t>(m_DepthImageViews.size(), 1);
 
-            VkExtent2D SwapChainExtent                  = GetSwapChainExtent();
-            VkFramebufferCreateInfo framebufferInfo = {};
+        m_SwapChainFramebuffers.resize(depthCount * ImageCount());
 
-            framebufferInfo.sType                       = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-            framebufferInfo.renderPass                  = m_RenderPass;
-            framebufferInfo.attachmentCount             = static_cast<uint32_t>(attachments.size());
-            framebufferInfo.pAttachments                = attachments.data();
-            framebufferInfo.width                       = SwapChainExtent.width;
-            framebufferInfo.height                      = SwapChainExtent.height;
-            framebufferInfo.layers                      = 1;
-
-            if (vkCreateFramebuffer(
-                m_Device.Device(),
-                &framebufferInfo,
-                nullptr,
-                &m_SwapChainFramebuffers[i]) != VK_SUCCESS)
+        for (size_t frame = 0; frame < depthCount; frame++)
+        {
+            for (size_t i = 0; i < ImageCount(); i++)
             {
-                throw std::runtime_error("failed to create framebuffer!");
+                std::array<VkImageView, 2> attachments  = { m_SwapChainImageViews[i], VK_NULL_HANDLE };
+                uint32_t attachmentCount                = 1;
+
+                if (HasDepthBuffer())
+                {
+                    attachments[attachmentCount++]      = m_DepthImageViews[frame];
+                }
+
+                VkExtent2D SwapChainExtent              = GetSwapChainExtent();
+                VkFramebufferCreateInfo framebufferInfo = {};
+
+                framebufferInfo.sType                   = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+                framebufferInfo.renderPass              = m_RenderPass;
+                framebufferInfo.attachmentCount         = attachmentCount;
+                framebufferInfo.pAttachments            = attachments.data();
+                framebufferInfo.width                   = SwapChainExtent.width;
+                framebufferInfo.height                  = SwapChainExtent.height;
+                framebufferInfo.layers                  = 1;
+
+                if (vkCreateFramebuffer(
+                    m_Device.Device(),
+                    &framebufferInfo,
+                    nullptr,
+                    &m_SwapChainFramebuffers[frame * ImageCount() + i]) != VK_SUCCESS)
+                {
+                    throw std::runtime_error("failed to create framebuffer!");
+                }
             }
         }
     }
 
     void VESwapChain::CreateDepthResources()
     {
+        if (!HasDepthBuffer())
+        {
+            m_SwapChainDepthFormat                      = VK_FORMAT_UNDEFINED;
+            return;
+        }
+
         VkFormat depthFormat                            = FindDepthFormat();
         m_SwapChainDepthFormat                          = depthFormat;
         VkExtent2D SwapChainExtent                      = GetSwapChainExtent();
 
-        m_DepthImages.resize(ImageCount());
-        m_DepthImageMemorys.resize(ImageCount());
-        m_DepthImageViews.resize(ImageCount());
+        m_DepthImages.resize(m_Config.FramesInFlight);
+        m_DepthImageAllocations.resize(m_Config.FramesInFlight);
+        m_DepthImageViews.resize(m_Config.FramesInFlight);
 
         for (int i = 0; i < m_DepthImages.size(); i++)
         {
@@ -362,7 +632,8 @@ namespace VulkanEngine {
             imageInfo.format                            = depthFormat;
             imageInfo.tiling                            = VK_IMAGE_TILING_OPTIMAL;
             imageInfo.initialLayout                     = VK_IMAGE_LAYOUT_UNDEFINED;
-            imageInfo.usage                             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+            // Cleared on load and never stored, so tile based GPUs can keep it in tile memory only
+            imageInfo.usage                             = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
             imageInfo.samples                           = VK_SAMPLE_COUNT_1_BIT;
             imageInfo.sharingMode                       = VK_SHARING_MODE_EXCLUSIVE;
             imageInfo.flags = 0;
@@ -371,7 +642,8 @@ namespace VulkanEngine {
                 imageInfo,
                 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
                 m_DepthImages[i],
-                m_DepthImageMemorys[i]);
+                m_DepthImageAllocations[i],
+                VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT);
 
             VkImageViewCreateInfo viewInfo{};
             viewInfo.sType                              = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -393,25 +665,19 @@ namespace VulkanEngine {
 
     void VESwapChain::CreateSyncObjects()
     {
-        m_ImageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_RenderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-        m_InFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-        m_ImagesInFlight.resize(ImageCount(), VK_NULL_HANDLE);
+        m_ImageAvailableSemaphores.resize(m_Config.FramesInFlight);
+        m_RenderFinishedSemaphores.resize(m_Config.FramesInFlight);
+        m_FrameSubmitValues.resize(m_Config.FramesInFlight, 0);
+        m_ImageSubmitValues.resize(ImageCount(), 0);
 
         VkSemaphoreCreateInfo semaphoreInfo = {};
 
         semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-        VkFenceCreateInfo fenceInfo = {};
-
-        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-        fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+        for (size_t i = 0; i < m_Config.FramesInFlight; i++)
         {
             if (vkCreateSemaphore(m_Device.Device(), &semaphoreInfo, nullptr, &m_ImageAvailableSemaphores[i]) != VK_SUCCESS ||
-                vkCreateSemaphore(m_Device.Device(), &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]) != VK_SUCCESS ||
-                vkCreateFence(m_Device.Device(), &fenceInfo, nullptr, &m_InFlightFences[i]) != VK_SUCCESS)
+                vkCreateSemaphore(m_Device.Device(), &semaphoreInfo, nullptr, &m_RenderFinishedSemaphores[i]) != VK_SUCCESS)
             {
                 throw std::runtime_error("failed to create synchronization objects for a frame!");
             }
@@ -434,24 +700,35 @@ namespace VulkanEngine {
 
     VkPresentModeKHR VESwapChain::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
     {
+        m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
+
         for (const auto& availablePresentMode : availablePresentModes)
         {
-            if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+            if (availablePresentMode == m_Config.PresentMode)
             {
-                std::cout << "Present mode: Mailbox" << std::endl;
-                return availablePresentMode;
+                m_PresentMode = availablePresentMode;
             }
         }
 
-        // for (const auto &availablePresentMode : availablePresentModes) {
-        //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-        //     std::cout << "Present mode: Immediate" << std::endl;
-        //     return availablePresentMode;
-        //   }
-        // }
+        if (m_PresentMode != m_Config.PresentMode)
+        {
+            std::cout << "Present mode " << PresentModeName(m_Config.PresentMode) << " is not supported by the surface" << std::endl;
+        }
+
+        std::cout << "Present mode: " << PresentModeName(m_PresentMode) << ", " << m_Config.FramesInFlight << " frame(s) in flight" << std::endl;
+        return m_PresentMode;
+    }
 
-        std::cout << "Present mode: V-Sync" << std::endl;
-        return VK_PRESENT_MODE_FIFO_KHR;
+    const char* VESwapChain::PresentModeName(VkPresentModeKHR presentMode)
+    {
+        switch (presentMode)
+        {
+        case VK_PRESENT_MODE_IMMEDIATE_KHR:     return "Immediate";
+        case VK_PRESENT_MODE_MAILBOX_KHR:       return "Mailbox";
+        case VK_PRESENT_MODE_FIFO_KHR:          return "V-Sync";
+        case VK_PRESENT_MODE_FIFO_RELAXED_KHR:  return "Relaxed V-Sync";
+        default:                                return "Unknown";
+        }
     }
 
     VkExtent2D VESwapChain::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
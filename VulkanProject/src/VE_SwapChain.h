@@ -1,5 +1,4 @@
 #pragma once
-#pragma once
 
 #include "VE_Device.h"
 
@@ -11,18 +10,34 @@
 
 namespace VulkanEngine {
 
+    struct VESwapChainConfig
+    {
+        // Falls back to FIFO, the only mode every driver has to support, when the surface lacks it
+        VkPresentModeKHR PresentMode                = VK_PRESENT_MODE_MAILBOX_KHR;
+        // 1 keeps the CPU and GPU in lock step for the lowest latency, 3 gives the most slack for throughput
+        uint32_t FramesInFlight                     = 2;
+        // 2D passes draw in submission order, a depth attachment is only needed by pipelines that depth test
+        bool DepthBuffer                            = false;
+    };
+
     class VESwapChain {
     public:
-        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 2;
+        // Upper bound of VESwapChainConfig::FramesInFlight, sizes the per frame arrays of the renderer
+        static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
 
-        VESwapChain(VEDevice& deviceRef, VkExtent2D windowExtent);
-        VESwapChain(VEDevice& deviceRef, VkExtent2D windowExtent, std::shared_ptr<VESwapChain> previous);
+        VESwapChain(VEDevice& deviceRef, VkExtent2D windowExtent, const VESwapChainConfig& config);
+        // Retires previous through oldSwapchain without waiting for it, previous must outlive its submitted frames
+        VESwapChain(VEDevice& deviceRef, VkExtent2D windowExtent, const VESwapChainConfig& config, std::shared_ptr<VESwapChain> previous);
         ~VESwapChain();
 
         VESwapChain(const VESwapChain&) = delete;
         VESwapChain& operator=(const VESwapChain&) = delete;
 
-        VkFramebuffer GetFrameBuffer(int index) { return m_SwapChainFramebuffers[index]; }
+        // Framebuffer of imageIndex paired with the depth image of the frame being recorded
+        VkFramebuffer GetFrameBuffer(uint32_t imageIndex)
+        {
+            return m_SwapChainFramebuffers[m_DepthImages.empty() ? imageIndex : m_CurrentFrame * ImageCount() + imageIndex];
+        }
         VkRenderPass GetRenderPass() { return m_RenderPass; }
         VkImageView GetImageView(int index) { return m_SwapChainImageViews[index]; }
         size_t ImageCount() { return m_SwapChainImages.size(); }
@@ -30,6 +45,9 @@ namespace VulkanEngine {
         VkExtent2D GetSwapChainExtent() { return m_SwapChainExtent; }
         uint32_t Width() { return m_SwapChainExtent.width; }
         uint32_t Height() { return m_SwapChainExtent.height; }
+        uint32_t GetFramesInFlight() const { return m_Config.FramesInFlight; }
+        bool HasDepthBuffer() const { return m_Config.DepthBuffer; }
+        VkPresentModeKHR GetPresentMode() const { return m_PresentMode; }
 
         float ExtentAspectRatio() {
             return static_cast<float>(m_SwapChainExtent.width) / static_cast<float>(m_SwapChainExtent.height);
@@ -39,6 +57,15 @@ namespace VulkanEngine {
         VkResult AcquireNextImage(uint32_t* imageIndex);
         VkResult SubmitCommandBuffers(const VkCommandBuffer* buffers, uint32_t* imageIndex);
 
+        // On a headless device the swap chain images are plain offscreen images and nothing is presented
+        bool IsHeadless() const { return m_Device.IsHeadless(); }
+
+        // Headless only: copies the next submitted frame back and writes it to path as a binary PPM
+        // once that frame has finished on the GPU
+        void RequestReadback(const std::string& path);
+
+        static const char* PresentModeName(VkPresentModeKHR presentMode);
+
         bool CompareSwapFormats(const VESwapChain& swapChain) const
         {
             return swapChain.m_SwapChainDepthFormat == m_SwapChainDepthFormat &&
@@ -46,8 +73,19 @@ namespace VulkanEngine {
         }
 
     private:
+        struct Readback
+        {
+            VkBuffer Buffer                     = VK_NULL_HANDLE;
+            VEAllocation Allocation;
+            VkCommandBuffer CommandBuffer       = VK_NULL_HANDLE;
+            std::string Path;                   // Empty unless a copy is in flight
+        };
+
         void Init();
         void CreateSwapChain();
+        void CreateOffscreenImages();
+        void RecordReadback(Readback& readback, uint32_t imageIndex);
+        void FinishReadback(Readback& readback);
         void CreateImageViews();
         void CreateDepthResources();
         void CreateRenderPass();
@@ -64,25 +102,35 @@ namespace VulkanEngine {
         VkFormat m_SwapChainDepthFormat;
         VkExtent2D m_SwapChainExtent;
 
-        std::vector<VkFramebuffer> m_SwapChainFramebuffers;
+        std::vector<VkFramebuffer> m_SwapChainFramebuffers;    // [frame in flight][image] with depth, [image] without
         VkRenderPass m_RenderPass;
 
+        // One per frame in flight, the frames recorded into a swap chain image never share a depth buffer
         std::vector<VkImage> m_DepthImages;
-        std::vector<VkDeviceMemory> m_DepthImageMemorys;
+        std::vector<VEAllocation> m_DepthImageAllocations;
         std::vector<VkImageView> m_DepthImageViews;
         std::vector<VkImage> m_SwapChainImages;
         std::vector<VkImageView> m_SwapChainImageViews;
 
         VEDevice& m_Device;
         VkExtent2D m_WindowExtent;
+        VESwapChainConfig m_Config;
+        VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_FIFO_KHR;
 
-        VkSwapchainKHR m_SwapChain;
+        VkSwapchainKHR m_SwapChain = VK_NULL_HANDLE;
         std::shared_ptr<VESwapChain> m_OldSwapChain;
 
+        // Headless stand ins for the swap chain images, handed out round robin
+        std::vector<VEAllocation> m_OffscreenImageAllocations;
+        uint32_t m_NextOffscreenImage = 0;
+        std::vector<Readback> m_Readbacks;      // One per frame in flight
+        std::string m_RequestedReadbackPath;
+
         std::vector<VkSemaphore> m_ImageAvailableSemaphores;
         std::vector<VkSemaphore> m_RenderFinishedSemaphores;
-        std::vector<VkFence> m_InFlightFences;
-        std::vector<VkFence> m_ImagesInFlight;
+        // Frame timeline values of the last submit per frame slot and per swap chain image, 0 when unused
+        std::vector<uint64_t> m_FrameSubmitValues;
+        std::vector<uint64_t> m_ImageSubmitValues;
         size_t m_CurrentFrame = 0;
     };
 
@@ -0,0 +1,121 @@
+#include "VE_Texture.h"
+
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	VETexture::VETexture(VEDevice& device,
+		uint32_t width,
+		uint32_t height,
+		uint32_t layerCount,
+		const void* pixels,
+		VkFilter filter)
+		: m_Device{ device }, m_Width{ width }, m_Height{ height }, m_LayerCount{ layerCount }
+	{
+		CreateImage(pixels);
+		CreateImageView();
+		CreateSampler(filter);
+	}
+
+	VETexture::~VETexture()
+	{
+		if (!IsReady())
+		{
+			m_Device.GetUploader().Cancel(m_UploadTicket);
+		}
+
+		vkDestroySampler(m_Device.Device(), m_Sampler, nullptr);
+		vkDestroyImageView(m_Device.Device(), m_ImageView, nullptr);
+		m_Device.DestroyImage(m_Image, m_ImageAllocation);
+	}
+
+	void VETexture::CreateImage(const void* pixels)
+	{
+		VkImageCreateInfo imageInfo = {};
+
+		imageInfo.sType							= VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType						= VK_IMAGE_TYPE_2D;
+		imageInfo.extent.width					= m_Width;
+		imageInfo.extent.height					= m_Height;
+		imageInfo.extent.depth					= 1;
+		imageInfo.mipLevels						= 1;
+		imageInfo.arrayLayers					= m_LayerCount;
+		imageInfo.format						= VK_FORMAT_R8G8B8A8_UNORM;
+		imageInfo.tiling						= VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout					= VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage							= VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		imageInfo.samples						= VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.sharingMode					= VK_SHARING_MODE_EXCLUSIVE;
+
+		m_Device.CreateImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_Image, m_ImageAllocation);
+
+		m_UploadTicket = m_Device.GetUploader().UploadImage(m_Image,
+			m_Width,
+			m_Height,
+			m_LayerCount,
+			4,
+			pixels,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+			VK_ACCESS_SHADER_READ_BIT);
+	}
+
+	bool VETexture::IsReady() const
+	{
+		// Once ready it stays ready, skip the uploader's lock from then on
+		if (!m_Ready.load(std::memory_order_relaxed) && m_Device.GetUploader().IsReady(m_UploadTicket))
+		{
+			m_Ready.store(true, std::memory_order_relaxed);
+		}
+
+		return m_Ready.load(std::memory_order_relaxed);
+	}
+
+	void VETexture::CreateImageView()
+	{
+		VkImageViewCreateInfo viewInfo = {};
+
+		viewInfo.sType							= VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image							= m_Image;
+		viewInfo.viewType						= VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+		viewInfo.format							= VK_FORMAT_R8G8B8A8_UNORM;
+		viewInfo.subresourceRange.aspectMask	= VK_IMAGE_ASPECT_COLOR_BIT;
+		viewInfo.subresourceRange.baseMipLevel	= 0;
+		viewInfo.subresourceRange.levelCount	= 1;
+		viewInfo.subresourceRange.baseArrayLayer = 0;
+		viewInfo.subresourceRange.layerCount	= m_LayerCount;
+
+		if (vkCreateImageView(m_Device.Device(), &viewInfo, nullptr, &m_ImageView) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create texture image view.");
+		}
+	}
+
+	void VETexture::CreateSampler(VkFilter filter)
+	{
+		VkSamplerCreateInfo samplerInfo = {};
+
+		samplerInfo.sType						= VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter					= filter;
+		samplerInfo.minFilter					= filter;
+		// Atlas regions sit next to each other, clamping keeps the edges of the page from wrapping around
+		samplerInfo.addressModeU				= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeV				= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.addressModeW				= VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+		samplerInfo.anisotropyEnable			= VK_FALSE;
+		samplerInfo.maxAnisotropy				= 1.0f;
+		samplerInfo.borderColor					= VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+		samplerInfo.unnormalizedCoordinates		= VK_FALSE;
+		samplerInfo.compareEnable				= VK_FALSE;
+		samplerInfo.compareOp					= VK_COMPARE_OP_ALWAYS;
+		samplerInfo.mipmapMode					= VK_SAMPLER_MIPMAP_MODE_NEAREST;
+		samplerInfo.mipLodBias					= 0.0f;
+		samplerInfo.minLod						= 0.0f;
+		samplerInfo.maxLod						= 0.0f;
+
+		if (vkCreateSampler(m_Device.Device(), &samplerInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create texture sampler.");
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+#include "VE_Device.h"
+#include "VE_Uploader.h"
+
+#include <atomic>
+
+namespace VulkanEngine {
+
+	// Sampled 2D array texture, uploaded once in the background through the transfer queue.
+	// A single layer is still an array view, shaders sample it as sampler2DArray.
+	class VETexture
+	{
+	public:
+		// pixels holds layerCount tightly packed layers of width * height RGBA8 texels
+		VETexture(VEDevice& device,
+			uint32_t width,
+			uint32_t height,
+			uint32_t layerCount,
+			const void* pixels,
+			VkFilter filter = VK_FILTER_LINEAR);
+		~VETexture();
+
+		// Delete the copy constructor and copy operator
+		VETexture(const VETexture&) = delete;
+		VETexture& operator=(const VETexture&) = delete;
+
+		VkDescriptorImageInfo GetDescriptorInfo() const { return { m_Sampler, m_ImageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL }; }
+
+		// False until the upload has reached the graphics queue, the texture must not be sampled before that
+		bool IsReady() const;
+
+		uint32_t GetWidth() const { return m_Width; }
+		uint32_t GetHeight() const { return m_Height; }
+		uint32_t GetLayerCount() const { return m_LayerCount; }
+
+	private:
+		void CreateImage(const void* pixels);
+		void CreateImageView();
+		void CreateSampler(VkFilter filter);
+
+	private:
+		VEDevice& m_Device;
+		VkImage m_Image;
+		VEAllocation m_ImageAllocation;
+		VkImageView m_ImageView;
+		VkSampler m_Sampler;
+		VEUploadTicket m_UploadTicket;
+		mutable std::atomic<bool> m_Ready{ false };
+
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint32_t m_LayerCount;
+	};
+}
\ No newline at end of file
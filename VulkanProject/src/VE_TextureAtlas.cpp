@@ -0,0 +1,253 @@
+#include "VE_TextureAtlas.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	// *************** Skyline Packer *********************
+
+	VESkylinePacker::VESkylinePacker(uint32_t width, uint32_t height)
+		: m_Width{ width }, m_Height{ height }
+	{
+		Reset();
+	}
+
+	void VESkylinePacker::Reset()
+	{
+		m_Skyline.clear();
+		m_Skyline.push_back({ 0, 0, m_Width });
+		m_UsedArea = 0;
+	}
+
+	bool VESkylinePacker::Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const
+	{
+		uint32_t x = m_Skyline[index].X;
+
+		if (x + width > m_Width)
+		{
+			return false;
+		}
+
+		// The rectangle rests on the highest segment it spans
+		uint32_t widthLeft = width;
+		y = 0;
+
+		while (widthLeft > 0)
+		{
+			y = std::max(y, m_Skyline[index].Y);
+
+			if (y + height > m_Height)
+			{
+				return false;
+			}
+
+			widthLeft -= std::min(widthLeft, m_Skyline[index].Width);
+			index++;
+		}
+
+		return true;
+	}
+
+	bool VESkylinePacker::Pack(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y)
+	{
+		uint32_t bestY = std::numeric_limits<uint32_t>::max();
+		uint32_t bestWidth = std::numeric_limits<uint32_t>::max();
+		size_t bestIndex = m_Skyline.size();
+
+		for (size_t i = 0; i < m_Skyline.size(); i++)
+		{
+			uint32_t fitY;
+
+			if (!Fit(i, width, height, fitY))
+			{
+				continue;
+			}
+
+			// Lowest top edge first, then the narrowest segment to keep wide gaps for wide rectangles
+			if (fitY + height < bestY || (fitY + height == bestY && m_Skyline[i].Width < bestWidth))
+			{
+				bestY = fitY + height;
+				bestWidth = m_Skyline[i].Width;
+				bestIndex = i;
+				y = fitY;
+			}
+		}
+
+		if (bestIndex == m_Skyline.size())
+		{
+			return false;
+		}
+
+		x = m_Skyline[bestIndex].X;
+		AddSegment(bestIndex, x, y, width, height);
+		m_UsedArea += static_cast<uint64_t>(width) * height;
+
+		return true;
+	}
+
+	void VESkylinePacker::AddSegment(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+	{
+		m_Skyline.insert(m_Skyline.begin() + index, { x, y + height, width });
+
+		// Trim or remove the segments now hidden under the new one
+		for (size_t i = index + 1; i < m_Skyline.size(); i++)
+		{
+			Segment& previous = m_Skyline[i - 1];
+			Segment& current = m_Skyline[i];
+
+			if (current.X >= previous.X + previous.Width)
+			{
+				break;
+			}
+
+			uint32_t shrink = previous.X + previous.Width - current.X;
+
+			if (current.Width > shrink)
+			{
+				current.X += shrink;
+				current.Width -= shrink;
+				break;
+			}
+
+			m_Skyline.erase(m_Skyline.begin() + i);
+			i--;
+		}
+
+		// Merge neighbours at the same height
+		for (size_t i = 0; i + 1 < m_Skyline.size(); i++)
+		{
+			if (m_Skyline[i].Y == m_Skyline[i + 1].Y)
+			{
+				m_Skyline[i].Width += m_Skyline[i + 1].Width;
+				m_Skyline.erase(m_Skyline.begin() + i + 1);
+				i--;
+			}
+		}
+	}
+
+	// *************** Texture Atlas *********************
+
+	VETextureAtlas::VETextureAtlas(uint32_t pageSize, uint32_t padding)
+		: m_PageSize{ pageSize }, m_Padding{ padding }
+	{
+	}
+
+	uint32_t VETextureAtlas::AddImage(uint32_t width, uint32_t height, const void* pixels)
+	{
+		assert(m_Texture == nullptr && "Cannot add images to an atlas that has already been built");
+
+		if (width + 2 * m_Padding > m_PageSize || height + 2 * m_Padding > m_PageSize)
+		{
+			throw std::runtime_error("Image is too large for the texture atlas page size.");
+		}
+
+		Image image;
+
+		image.Width		= width;
+		image.Height	= height;
+		image.Pixels.resize(static_cast<size_t>(width) * height);
+
+		memcpy(image.Pixels.data(), pixels, image.Pixels.size() * sizeof(uint32_t));
+
+		m_Images.push_back(std::move(image));
+		m_Regions.emplace_back();
+		return static_cast<uint32_t>(m_Images.size() - 1);
+	}
+
+	void VETextureAtlas::Build(VEDevice& device)
+	{
+		assert(m_Texture == nullptr && "Texture atlas has already been built");
+
+		// Tallest first packs noticeably tighter with a skyline
+		std::vector<uint32_t> order(m_Images.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b)
+		{
+			return m_Images[a].Height > m_Images[b].Height;
+		});
+
+		std::vector<std::vector<uint32_t>> pages;
+		std::vector<VESkylinePacker> packers;
+
+		for (uint32_t imageId : order)
+		{
+			const Image& image = m_Images[imageId];
+			uint32_t paddedWidth = image.Width + 2 * m_Padding;
+			uint32_t paddedHeight = image.Height + 2 * m_Padding;
+
+			uint32_t x = 0;
+			uint32_t y = 0;
+			uint32_t layer = 0;
+
+			// First page with room, otherwise start a new one
+			while (layer < packers.size() && !packers[layer].Pack(paddedWidth, paddedHeight, x, y))
+			{
+				layer++;
+			}
+
+			if (layer == packers.size())
+			{
+				packers.emplace_back(m_PageSize, m_PageSize);
+				pages.emplace_back(static_cast<size_t>(m_PageSize) * m_PageSize, 0u);
+				packers.back().Pack(paddedWidth, paddedHeight, x, y);
+			}
+
+			BlitImage(image, pages[layer], x, y);
+
+			VEAtlasRegion& region = m_Regions[imageId];
+
+			region.Layer	= layer;
+			region.UvMin	= glm::vec2(x + m_Padding, y + m_Padding) / static_cast<float>(m_PageSize);
+			region.UvMax	= glm::vec2(x + m_Padding + image.Width, y + m_Padding + image.Height) / static_cast<float>(m_PageSize);
+		}
+
+		// An atlas with no images still gets a page, so there is always something to bind
+		if (pages.empty())
+		{
+			pages.emplace_back(static_cast<size_t>(m_PageSize) * m_PageSize, 0u);
+			packers.emplace_back(m_PageSize, m_PageSize);
+		}
+
+		m_PageCount = static_cast<uint32_t>(pages.size());
+
+		std::vector<uint32_t> pixels;
+		pixels.reserve(static_cast<size_t>(m_PageSize) * m_PageSize * m_PageCount);
+
+		for (uint32_t i = 0; i < m_PageCount; i++)
+		{
+			pixels.insert(pixels.end(), pages[i].begin(), pages[i].end());
+			std::cout << "texture atlas: page " << i << " is " << packers[i].GetOccupancy() * 100.0f << "% full" << std::endl;
+		}
+
+		m_Texture = std::make_unique<VETexture>(device, m_PageSize, m_PageSize, m_PageCount, pixels.data());
+
+		// The pages live on the GPU now
+		m_Images.clear();
+		m_Images.shrink_to_fit();
+	}
+
+	void VETextureAtlas::BlitImage(const Image& image, std::vector<uint32_t>& page, uint32_t x, uint32_t y) const
+	{
+		uint32_t paddedWidth = image.Width + 2 * m_Padding;
+		uint32_t paddedHeight = image.Height + 2 * m_Padding;
+
+		for (uint32_t row = 0; row < paddedHeight; row++)
+		{
+			// Clamp into the source image so the padding repeats the edge texels
+			uint32_t sourceRow = std::min(std::max(row, m_Padding) - m_Padding, image.Height - 1);
+
+			for (uint32_t column = 0; column < paddedWidth; column++)
+			{
+				uint32_t sourceColumn = std::min(std::max(column, m_Padding) - m_Padding, image.Width - 1);
+
+				page[static_cast<size_t>(y + row) * m_PageSize + x + column] = image.Pixels[static_cast<size_t>(sourceRow) * image.Width + sourceColumn];
+			}
+		}
+	}
+}
\ No newline at end of file
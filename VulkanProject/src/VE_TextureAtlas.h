@@ -0,0 +1,97 @@
+#pragma once
+#include "VE_Device.h"
+#include "VE_Texture.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Where an image ended up inside the atlas
+	struct VEAtlasRegion
+	{
+		uint32_t Layer			= 0;
+		glm::vec2 UvMin{ 0.0f };
+		glm::vec2 UvMax{ 0.0f };
+	};
+
+	// Skyline bottom-left rectangle packer. Tracks the top edge of everything placed so far as a list of
+	// horizontal segments and drops each new rectangle as low as it fits.
+	class VESkylinePacker
+	{
+	public:
+		VESkylinePacker(uint32_t width, uint32_t height);
+
+		bool Pack(uint32_t width, uint32_t height, uint32_t& x, uint32_t& y);
+		void Reset();
+
+		// Fraction of the page covered by packed rectangles
+		float GetOccupancy() const { return static_cast<float>(m_UsedArea) / (static_cast<float>(m_Width) * m_Height); }
+
+	private:
+		struct Segment
+		{
+			uint32_t X;
+			uint32_t Y;
+			uint32_t Width;
+		};
+
+		// Height the rectangle would rest at when its left edge starts at segment index, false if it doesn't fit
+		bool Fit(size_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+		void AddSegment(size_t index, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+	private:
+		uint32_t m_Width;
+		uint32_t m_Height;
+		uint64_t m_UsedArea = 0;
+		std::vector<Segment> m_Skyline;
+	};
+
+	// Collects many small RGBA8 images and packs them into the layers of one array texture, so sprites
+	// using any of them can be drawn without rebinding textures.
+	class VETextureAtlas
+	{
+	public:
+		VETextureAtlas(uint32_t pageSize = 1024, uint32_t padding = 1);
+
+		// Delete the copy constructor and copy operator
+		VETextureAtlas(const VETextureAtlas&) = delete;
+		VETextureAtlas& operator=(const VETextureAtlas&) = delete;
+
+		// Copies the pixels, returns the id to look the region up with after Build
+		uint32_t AddImage(uint32_t width, uint32_t height, const void* pixels);
+
+		// Packs every added image and uploads the pages
+		void Build(VEDevice& device);
+
+		const VEAtlasRegion& GetRegion(uint32_t imageId) const { return m_Regions[imageId]; }
+		uint32_t GetImageCount() const { return static_cast<uint32_t>(m_Regions.size()); }
+		uint32_t GetPageCount() const { return m_PageCount; }
+		const VETexture& GetTexture() const { return *m_Texture; }
+
+	private:
+		struct Image
+		{
+			uint32_t Width;
+			uint32_t Height;
+			std::vector<uint32_t> Pixels;
+		};
+
+		// Copies the image into the page, repeating its edge texels into the padding so filtering never
+		// picks up a neighbour
+		void BlitImage(const Image& image, std::vector<uint32_t>& page, uint32_t x, uint32_t y) const;
+
+	private:
+		uint32_t m_PageSize;
+		uint32_t m_Padding;
+		uint32_t m_PageCount = 0;
+
+		std::vector<Image> m_Images;
+		std::vector<VEAtlasRegion> m_Regions;
+		std::unique_ptr<VETexture> m_Texture;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "VE_ThreadPool.h"
+#include "VE_Profiler.h"
+
+namespace VulkanEngine {
+
+	VEThreadPool::VEThreadPool(uint32_t threadCount)
+	{
+		if (threadCount == 0)
+		{
+			uint32_t hardwareThreads = std::thread::hardware_concurrency();
+			threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+		}
+
+		m_Workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+		{
+			m_Workers.emplace_back(&VEThreadPool::WorkerLoop, this);
+		}
+	}
+
+	VEThreadPool::~VEThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stopping = true;
+		}
+
+		m_Condition.notify_all();
+
+		// Workers drain whatever is still queued before they exit
+		for (auto& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	void VEThreadPool::WorkerLoop()
+	{
+		VE_PROFILE_THREAD("Worker");
+
+		while (true)
+		{
+			std::function<void()> job;
+
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_Condition.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+				if (m_Jobs.empty())
+				{
+					return;
+				}
+
+				job = std::move(m_Jobs.front());
+				m_Jobs.pop();
+			}
+
+			job();
+		}
+	}
+}
\ No newline at end of file
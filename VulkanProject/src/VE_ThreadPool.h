@@ -0,0 +1,58 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Fixed set of worker threads pulling jobs off a shared FIFO queue
+	class VEThreadPool
+	{
+	public:
+		// 0 picks one thread less than the hardware has, leaving a core for the main loop
+		explicit VEThreadPool(uint32_t threadCount = 0);
+		~VEThreadPool();
+
+		// Delete the copy constructor and copy operator
+		VEThreadPool(const VEThreadPool&) = delete;
+		VEThreadPool& operator=(const VEThreadPool&) = delete;
+
+		// Queues a job, the returned future holds its result or the exception it threw
+		template<typename Function>
+		auto Submit(Function&& function) -> std::future<typename std::result_of<Function()>::type>
+		{
+			using ResultType = typename std::result_of<Function()>::type;
+
+			// std::function needs a copyable target, so the task lives behind a shared_ptr
+			auto task = std::make_shared<std::packaged_task<ResultType()>>(std::forward<Function>(function));
+			std::future<ResultType> result = task->get_future();
+
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Jobs.push([task]() { (*task)(); });
+			}
+
+			m_Condition.notify_one();
+			return result;
+		}
+
+		uint32_t GetThreadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+	private:
+		void WorkerLoop();
+
+	private:
+		std::vector<std::thread> m_Workers;
+		std::queue<std::function<void()>> m_Jobs;
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+		bool m_Stopping = false;
+	};
+}
\ No newline at end of file
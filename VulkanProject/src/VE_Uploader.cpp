@@ -0,0 +1,378 @@
+#include "VE_Uploader.h"
+#include "VE_Profiler.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	VEUploader::VEUploader(VEDevice& device)
+		: m_Device{ device }
+	{
+		QueueFamilyIndices indices = m_Device.FindPhysicalQueueFamilies();
+
+		m_GraphicsFamily	= indices.GraphicsFamily;
+		m_TransferFamily	= indices.TransferFamily;
+		m_SubmitImmediately	= m_Device.TransferQueue() != m_Device.GraphicsQueue() && m_Device.TransferQueue() != m_Device.PresentQueue();
+
+		VkCommandPoolCreateInfo poolInfo = {};
+
+		poolInfo.sType				= VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex	= m_TransferFamily;
+		poolInfo.flags				= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+
+		if (vkCreateCommandPool(m_Device.Device(), &poolInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create transfer command pool.");
+		}
+	}
+
+	VEUploader::~VEUploader()
+	{
+		WaitIdle();
+
+		for (auto& upload : m_Uploads)
+		{
+			Release(upload);
+		}
+
+		vkDestroyCommandPool(m_Device.Device(), m_CommandPool, nullptr);
+	}
+
+	VEUploader::Upload VEUploader::BeginUpload(const void* data, VkDeviceSize size)
+	{
+		Upload upload;
+
+		m_Device.CreateBuffer(size,
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			upload.StagingBuffer,
+			upload.StagingAllocation);
+
+		memcpy(upload.StagingAllocation.MappedData, data, static_cast<size_t>(size));
+
+		VkFenceCreateInfo fenceInfo = {};
+
+		fenceInfo.sType				= VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+		if (vkCreateFence(m_Device.Device(), &fenceInfo, nullptr, &upload.Fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create upload fence.");
+		}
+
+		// Command pools are not thread safe, the caller holds m_Mutex from here until EndUpload
+		VkCommandBufferAllocateInfo allocInfo = {};
+
+		allocInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.level					= VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandPool			= m_CommandPool;
+		allocInfo.commandBufferCount	= 1;
+
+		if (vkAllocateCommandBuffers(m_Device.Device(), &allocInfo, &upload.CommandBuffer) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to allocate upload command buffer.");
+		}
+
+		VkCommandBufferBeginInfo beginInfo = {};
+
+		beginInfo.sType					= VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags					= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(upload.CommandBuffer, &beginInfo);
+		return upload;
+	}
+
+	VEUploadTicket VEUploader::EndUpload(Upload& upload)
+	{
+		vkEndCommandBuffer(upload.CommandBuffer);
+
+		upload.Ticket = m_NextTicket++;
+
+		if (m_SubmitImmediately)
+		{
+			Submit(upload);
+		}
+
+		m_PendingTickets.insert(upload.Ticket);
+		m_Uploads.push_back(upload);
+
+		return upload.Ticket;
+	}
+
+	void VEUploader::Submit(Upload& upload)
+	{
+		VkSubmitInfo submitInfo = {};
+
+		submitInfo.sType				= VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount	= 1;
+		submitInfo.pCommandBuffers		= &upload.CommandBuffer;
+
+		if (vkQueueSubmit(m_Device.TransferQueue(), 1, &submitInfo, upload.Fence) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to submit upload.");
+		}
+
+		upload.Submitted = true;
+	}
+
+	VEUploadTicket VEUploader::UploadBuffer(VkBuffer buffer,
+		VkDeviceSize offset,
+		const void* data,
+		VkDeviceSize size,
+		VkPipelineStageFlags dstStage,
+		VkAccessFlags dstAccess)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		Upload upload = BeginUpload(data, size);
+
+		upload.Buffer		= buffer;
+		upload.Offset		= offset;
+		upload.Size			= size;
+		upload.DstStage		= dstStage;
+		upload.DstAccess	= dstAccess;
+
+		VkBufferCopy copyRegion = {};
+
+		copyRegion.srcOffset	= 0;
+		copyRegion.dstOffset	= offset;
+		copyRegion.size			= size;
+
+		vkCmdCopyBuffer(upload.CommandBuffer, upload.StagingBuffer, buffer, 1, &copyRegion);
+
+		if (HasDedicatedTransferQueue())
+		{
+			// Release half of the ownership transfer, the graphics queue acquires it later
+			VkBufferMemoryBarrier release = {};
+
+			release.sType					= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			release.srcAccessMask			= VK_ACCESS_TRANSFER_WRITE_BIT;
+			release.dstAccessMask			= 0;
+			release.srcQueueFamilyIndex		= m_TransferFamily;
+			release.dstQueueFamilyIndex		= m_GraphicsFamily;
+			release.buffer					= buffer;
+			release.offset					= offset;
+			release.size					= size;
+
+			vkCmdPipelineBarrier(upload.CommandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0, 0, nullptr, 1, &release, 0, nullptr);
+		}
+
+		return EndUpload(upload);
+	}
+
+	VEUploadTicket VEUploader::UploadImage(VkImage image,
+		uint32_t width,
+		uint32_t height,
+		uint32_t layerCount,
+		uint32_t bytesPerPixel,
+		const void* pixels,
+		VkImageLayout finalLayout,
+		VkPipelineStageFlags dstStage,
+		VkAccessFlags dstAccess)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		VkDeviceSize size = static_cast<VkDeviceSize>(width) * height * layerCount * bytesPerPixel;
+		Upload upload = BeginUpload(pixels, size);
+
+		upload.Image		= image;
+		upload.LayerCount	= layerCount;
+		upload.FinalLayout	= finalLayout;
+		upload.DstStage		= dstStage;
+		upload.DstAccess	= dstAccess;
+
+		VkImageMemoryBarrier toTransfer = {};
+
+		toTransfer.sType							= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		toTransfer.oldLayout						= VK_IMAGE_LAYOUT_UNDEFINED;
+		toTransfer.newLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		toTransfer.srcAccessMask					= 0;
+		toTransfer.dstAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+		toTransfer.srcQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.dstQueueFamilyIndex				= VK_QUEUE_FAMILY_IGNORED;
+		toTransfer.image							= image;
+		toTransfer.subresourceRange.aspectMask		= VK_IMAGE_ASPECT_COLOR_BIT;
+		toTransfer.subresourceRange.baseMipLevel	= 0;
+		toTransfer.subresourceRange.levelCount		= 1;
+		toTransfer.subresourceRange.baseArrayLayer	= 0;
+		toTransfer.subresourceRange.layerCount		= layerCount;
+
+		vkCmdPipelineBarrier(upload.CommandBuffer,
+			VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+		VkBufferImageCopy region = {};
+
+		region.bufferOffset							= 0;
+		region.bufferRowLength						= 0;
+		region.bufferImageHeight					= 0;
+		region.imageSubresource.aspectMask			= VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel			= 0;
+		region.imageSubresource.baseArrayLayer		= 0;
+		region.imageSubresource.layerCount			= layerCount;
+		region.imageOffset							= { 0, 0, 0 };
+		region.imageExtent							= { width, height, 1 };
+
+		vkCmdCopyBufferToImage(upload.CommandBuffer, upload.StagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+		if (HasDedicatedTransferQueue())
+		{
+			// The layout transition has to be identical in the release and the acquire
+			VkImageMemoryBarrier release = toTransfer;
+
+			release.oldLayout						= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			release.newLayout						= finalLayout;
+			release.srcAccessMask					= VK_ACCESS_TRANSFER_WRITE_BIT;
+			release.dstAccessMask					= 0;
+			release.srcQueueFamilyIndex				= m_TransferFamily;
+			release.dstQueueFamilyIndex				= m_GraphicsFamily;
+
+			vkCmdPipelineBarrier(upload.CommandBuffer,
+				VK_PIPELINE_STAGE_TRANSFER_BIT,
+				VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+				0, 0, nullptr, 0, nullptr, 1, &release);
+		}
+
+		return EndUpload(upload);
+	}
+
+	void VEUploader::RecordAcquire(VkCommandBuffer commandBuffer, const Upload& upload)
+	{
+		bool transferOwnership = HasDedicatedTransferQueue();
+
+		// With an ownership transfer the release already made the writes available, the acquire only has
+		// to make them visible. On a shared queue this is an ordinary transfer -> read barrier.
+		VkPipelineStageFlags srcStage	= transferOwnership ? VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+		VkAccessFlags srcAccess			= transferOwnership ? 0 : VK_ACCESS_TRANSFER_WRITE_BIT;
+		uint32_t srcFamily				= transferOwnership ? m_TransferFamily : VK_QUEUE_FAMILY_IGNORED;
+		uint32_t dstFamily				= transferOwnership ? m_GraphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+
+		if (upload.Image != VK_NULL_HANDLE)
+		{
+			VkImageMemoryBarrier acquire = {};
+
+			acquire.sType								= VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			acquire.oldLayout							= VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			acquire.newLayout							= upload.FinalLayout;
+			acquire.srcAccessMask						= srcAccess;
+			acquire.dstAccessMask						= upload.DstAccess;
+			acquire.srcQueueFamilyIndex					= srcFamily;
+			acquire.dstQueueFamilyIndex					= dstFamily;
+			acquire.image								= upload.Image;
+			acquire.subresourceRange.aspectMask			= VK_IMAGE_ASPECT_COLOR_BIT;
+			acquire.subresourceRange.baseMipLevel		= 0;
+			acquire.subresourceRange.levelCount			= 1;
+			acquire.subresourceRange.baseArrayLayer		= 0;
+			acquire.subresourceRange.layerCount			= upload.LayerCount;
+
+			vkCmdPipelineBarrier(commandBuffer, srcStage, upload.DstStage, 0, 0, nullptr, 0, nullptr, 1, &acquire);
+		}
+		else
+		{
+			VkBufferMemoryBarrier acquire = {};
+
+			acquire.sType								= VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			acquire.srcAccessMask						= srcAccess;
+			acquire.dstAccessMask						= upload.DstAccess;
+			acquire.srcQueueFamilyIndex					= srcFamily;
+			acquire.dstQueueFamilyIndex					= dstFamily;
+			acquire.buffer								= upload.Buffer;
+			acquire.offset								= upload.Offset;
+			acquire.size								= upload.Size;
+
+			vkCmdPipelineBarrier(commandBuffer, srcStage, upload.DstStage, 0, 0, nullptr, 1, &acquire, 0, nullptr);
+		}
+	}
+
+	void VEUploader::RecordAcquireBarriers(VkCommandBuffer graphicsCommandBuffer)
+	{
+		VE_PROFILE_FUNCTION();
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto it = m_Uploads.begin(); it != m_Uploads.end();)
+		{
+			Upload& upload = *it;
+
+			if (!upload.Submitted)
+			{
+				// Shared queue: submitted here, on the thread that owns the queue, ahead of this frame
+				Submit(upload);
+			}
+
+			bool finished = vkGetFenceStatus(m_Device.Device(), upload.Fence) == VK_SUCCESS;
+
+			if (!upload.Acquired && (finished || !HasDedicatedTransferQueue()))
+			{
+				// On a shared queue submission order alone orders the copy before this barrier
+				RecordAcquire(graphicsCommandBuffer, upload);
+
+				upload.Acquired = true;
+				m_PendingTickets.erase(upload.Ticket);
+			}
+
+			if (upload.Acquired && finished)
+			{
+				Release(upload);
+				it = m_Uploads.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+	}
+
+	void VEUploader::Release(Upload& upload)
+	{
+		vkDestroyFence(m_Device.Device(), upload.Fence, nullptr);
+		vkFreeCommandBuffers(m_Device.Device(), m_CommandPool, 1, &upload.CommandBuffer);
+		m_Device.DestroyBuffer(upload.StagingBuffer, upload.StagingAllocation);
+	}
+
+	bool VEUploader::IsReady(VEUploadTicket ticket) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return ticket != 0 && ticket < m_NextTicket && m_PendingTickets.count(ticket) == 0;
+	}
+
+	void VEUploader::Cancel(VEUploadTicket ticket)
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto it = m_Uploads.begin(); it != m_Uploads.end(); ++it)
+		{
+			if (it->Ticket != ticket)
+			{
+				continue;
+			}
+
+			if (it->Submitted)
+			{
+				vkWaitForFences(m_Device.Device(), 1, &it->Fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			}
+
+			Release(*it);
+			m_Uploads.erase(it);
+			m_PendingTickets.erase(ticket);
+			return;
+		}
+	}
+
+	void VEUploader::WaitIdle()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		for (auto& upload : m_Uploads)
+		{
+			if (upload.Submitted)
+			{
+				vkWaitForFences(m_Device.Device(), 1, &upload.Fence, VK_TRUE, std::numeric_limits<uint64_t>::max());
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+#include "VE_Device.h"
+
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Identifies one upload, 0 is never handed out
+	using VEUploadTicket = uint64_t;
+
+	// Streams buffer and image data to device local memory through the transfer queue without blocking.
+	//
+	// When the device has a separate transfer family the copy runs there and ownership is released to the
+	// graphics family; the matching acquire barrier is recorded into the next frame once the transfer's fence
+	// has signaled. Without one the copies are submitted to the graphics queue ahead of the frame and only a
+	// plain barrier is needed. Either way a ticket becomes ready in the frame that can first use the data.
+	//
+	// Uploads may be started from any thread. The destination must stay alive until its ticket is ready or cancelled.
+	class VEUploader
+	{
+	public:
+		VEUploader(VEDevice& device);
+		~VEUploader();
+
+		// Delete the copy constructor and copy operator
+		VEUploader(const VEUploader&) = delete;
+		VEUploader& operator=(const VEUploader&) = delete;
+
+		// dstStage and dstAccess describe how the graphics queue will use the data
+		VEUploadTicket UploadBuffer(VkBuffer buffer,
+			VkDeviceSize offset,
+			const void* data,
+			VkDeviceSize size,
+			VkPipelineStageFlags dstStage,
+			VkAccessFlags dstAccess);
+
+		// pixels holds layerCount tightly packed layers, the image ends up in finalLayout
+		VEUploadTicket UploadImage(VkImage image,
+			uint32_t width,
+			uint32_t height,
+			uint32_t layerCount,
+			uint32_t bytesPerPixel,
+			const void* pixels,
+			VkImageLayout finalLayout,
+			VkPipelineStageFlags dstStage,
+			VkAccessFlags dstAccess);
+
+		// True once the data can be used by commands recorded after the current frame's acquire barriers
+		bool IsReady(VEUploadTicket ticket) const;
+
+		// Called by the renderer at the start of every frame, before anything that may read uploaded data
+		void RecordAcquireBarriers(VkCommandBuffer graphicsCommandBuffer);
+
+		// Drops an upload whose destination is destroyed before it became ready, waiting for its copy if needed
+		void Cancel(VEUploadTicket ticket);
+
+		// Blocks until every submitted transfer has finished on the GPU
+		void WaitIdle();
+
+		bool HasDedicatedTransferQueue() const { return m_TransferFamily != m_GraphicsFamily; }
+
+	private:
+		struct Upload
+		{
+			VEUploadTicket Ticket				= 0;
+			VkCommandBuffer CommandBuffer		= VK_NULL_HANDLE;
+			VkFence Fence						= VK_NULL_HANDLE;
+			VkBuffer StagingBuffer				= VK_NULL_HANDLE;
+			VEAllocation StagingAllocation;
+			bool Submitted						= false;
+			bool Acquired						= false;
+
+			// Destination, needed again for the acquire barrier
+			VkBuffer Buffer						= VK_NULL_HANDLE;
+			VkDeviceSize Offset					= 0;
+			VkDeviceSize Size					= 0;
+			VkImage Image						= VK_NULL_HANDLE;
+			uint32_t LayerCount					= 0;
+			VkImageLayout FinalLayout			= VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags DstStage		= 0;
+			VkAccessFlags DstAccess				= 0;
+		};
+
+		Upload BeginUpload(const void* data, VkDeviceSize size);
+		VEUploadTicket EndUpload(Upload& upload);
+		void Submit(Upload& upload);
+		void RecordAcquire(VkCommandBuffer commandBuffer, const Upload& upload);
+		void Release(Upload& upload);
+
+	private:
+		VEDevice& m_Device;
+		VkCommandPool m_CommandPool;
+		uint32_t m_GraphicsFamily;
+		uint32_t m_TransferFamily;
+		// Only when the transfer queue is not also used by the main thread can uploads be submitted right away
+		bool m_SubmitImmediately;
+
+		std::vector<Upload> m_Uploads;
+		std::unordered_set<VEUploadTicket> m_PendingTickets;
+		VEUploadTicket m_NextTicket = 1;
+		mutable std::mutex m_Mutex;
+	};
+}
\ No newline at end of file
@@ -19,6 +19,7 @@ namespace VulkanEngine {
 		VkExtent2D GetExtent() { return { m_Width, m_Height }; }
 		bool WasWindowResized() { return m_FramebufferResized; }
 		void ResetWindowResizeFlag() { m_FramebufferResized = false; }
+		bool IsKeyPressed(int key) { return glfwGetKey(m_Window, key) == GLFW_PRESS; }
 
 		void CreateWindowSurface(VkInstance instance, VkSurfaceKHR* surface);
 
@@ -0,0 +1,191 @@
+#include "VectorFieldRenderSystem.h"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace VulkanEngine {
+
+	constexpr uint32_t VectorFieldRenderSystem::MAX_BODIES;
+
+	struct VectorFieldPushConstantData
+	{
+		glm::vec2 Min;
+		glm::vec2 CellSize;
+		uint32_t Columns;
+		uint32_t BodyCount;
+		float Strength;
+		float Thickness;
+		alignas(16) glm::vec3 Color;
+	};
+
+	VectorFieldRenderSystem::VectorFieldRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+		: m_Device{ device }
+	{
+		CreateDescriptorSetLayout();
+		CreatePipelineLayout();
+		CreatePipeline(pipelineCompiler, renderPass);
+	}
+
+	VectorFieldRenderSystem::~VectorFieldRenderSystem()
+	{
+		// The worker may still be compiling against the layout
+		if (m_Pipeline.IsValid())
+		{
+			m_Pipeline.Wait();
+		}
+
+		vkDestroyPipelineLayout(m_Device.Device(), m_PipelineLayout, nullptr);
+	}
+
+	void VectorFieldRenderSystem::CreateDescriptorSetLayout()
+	{
+		m_DescriptorPool = VEDescriptorPool::Builder(m_Device)
+			.SetMaxSets(1)
+			.AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1)
+			.Build();
+
+		// Dynamic, so every frame's slice of the ring buffer is reached through the same set
+		m_DescriptorSetLayout = VEDescriptorSetLayout::Builder(m_Device)
+			.AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, VK_SHADER_STAGE_VERTEX_BIT)
+			.Build();
+	}
+
+	void VectorFieldRenderSystem::CreateDescriptorSet(VkBuffer bodyBuffer)
+	{
+		VkDescriptorBufferInfo bufferInfo = { bodyBuffer, 0, MAX_BODIES * sizeof(GpuBody) };
+
+		if (!VEDescriptorWriter(*m_DescriptorSetLayout, *m_DescriptorPool)
+			.WriteBuffer(0, &bufferInfo)
+			.Build(m_DescriptorSet))
+		{
+			throw std::runtime_error("Failed to allocate the vector field descriptor set.");
+		}
+	}
+
+	void VectorFieldRenderSystem::CreatePipelineLayout()
+	{
+		VkDescriptorSetLayout setLayouts[] = { m_DescriptorSetLayout->GetDescriptorSetLayout() };
+
+		VkPushConstantRange pushConstantRange = {};
+
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(VectorFieldPushConstantData);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+
+		pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutInfo.setLayoutCount = 1;
+		pipelineLayoutInfo.pSetLayouts = setLayouts;
+		pipelineLayoutInfo.pushConstantRangeCount = 1;
+		pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+		if (vkCreatePipelineLayout(m_Device.Device(), &pipelineLayoutInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		{
+			throw std::runtime_error("Failed to create pipeline layout.");
+		}
+	}
+
+	void VectorFieldRenderSystem::CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass)
+	{
+		assert(m_PipelineLayout != nullptr && "Cannot create pipeline before pipeline layout");
+
+		PipelineConfigInfo pipelineConfig = {};
+
+		VEPipeline::DefaultPipelineConfigInfo(pipelineConfig);
+
+		pipelineConfig.RenderPass = renderPass;
+		pipelineConfig.PipelineLayout = m_PipelineLayout;
+
+		// Arrows are drawn in submission order like the rest of the 2D scene
+		pipelineConfig.DepthStencilInfo.depthTestEnable = VK_FALSE;
+		pipelineConfig.DepthStencilInfo.depthWriteEnable = VK_FALSE;
+
+		// The grid point comes from gl_InstanceIndex and the arrow corners from gl_VertexIndex
+		pipelineConfig.BindingDescriptions.clear();
+		pipelineConfig.AttributeDescriptions.clear();
+
+		m_Pipeline = pipelineCompiler.Compile(
+			"VectorField_Shader.vert",
+			"VectorField_Shader.frag",
+			pipelineConfig);
+	}
+
+	void VectorFieldRenderSystem::RenderField(VERenderer& renderer,
+		VkCommandBuffer commandBuffer,
+		const GravityPhysicsSystem& physicsSystem,
+		const std::vector<VEGameObject>& bodies,
+		uint32_t resolution,
+		const char* gpuScope)
+	{
+		VEPipeline* pipeline = m_Pipeline.Get();
+
+		if (pipeline == nullptr || resolution == 0)
+		{
+			return;
+		}
+
+		VEFrameRingBuffer& ringBuffer = renderer.GetFrameRingBuffer();
+
+		if (m_DescriptorSet == VK_NULL_HANDLE)
+		{
+			CreateDescriptorSet(ringBuffer.GetBuffer());
+		}
+
+		// Always the full range, the descriptor was written with it
+		VEBufferSlice slice = ringBuffer.Allocate(MAX_BODIES * sizeof(GpuBody));
+		GpuBody* gpuBodies = static_cast<GpuBody*>(slice.MappedData);
+
+		uint32_t bodyCount = std::min(static_cast<uint32_t>(bodies.size()), MAX_BODIES);
+
+		for (uint32_t i = 0; i < bodyCount; i++)
+		{
+			gpuBodies[i].Position	= bodies[i].m_Transform2D.Translation;
+			gpuBodies[i].Mass		= bodies[i].m_RigidBody2D.Mass;
+		}
+
+		VectorFieldPushConstantData push = {};
+
+		push.Min		= { -1.0f, -1.0f };
+		push.CellSize	= glm::vec2(2.0f / resolution);
+		push.Columns	= resolution;
+		push.BodyCount	= bodyCount;
+		// The field is sampled with a probe of default mass, same as the old per arrow game objects
+		push.Strength	= physicsSystem.m_StrengthGravity * RigidBody2DComponent{}.Mass;
+		push.Thickness	= 0.005f;
+		push.Color		= glm::vec3(1.0f);
+
+		uint32_t dynamicOffset = slice.DynamicOffset();
+
+		// A single chunk, the draw is one instanced call however dense the grid is
+		renderer.RecordParallel(commandBuffer, 1,
+			[&](VkCommandBuffer secondary, uint32_t, uint32_t)
+			{
+				pipeline->Bind(secondary);
+
+				vkCmdBindDescriptorSets(secondary,
+					VK_PIPELINE_BIND_POINT_GRAPHICS,
+					m_PipelineLayout,
+					0,
+					1,
+					&m_DescriptorSet,
+					1,
+					&dynamicOffset);
+
+				vkCmdPushConstants(secondary,
+					m_PipelineLayout,
+					VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+					0,
+					sizeof(VectorFieldPushConstantData),
+					&push);
+
+				vkCmdDraw(secondary, 6, resolution * resolution, 0, 0);
+			},
+			gpuScope);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+#include "GravitySystem.h"
+#include "VE_Descriptors.h"
+#include "VE_Device.h"
+#include "VE_GameObject.h"
+#include "VE_PipelineCompiler.h"
+#include "VE_Renderer.h"
+
+#include <memory>
+#include <vector>
+
+namespace VulkanEngine {
+
+	// Draws the gravity field of a set of bodies as a grid of arrows. The bodies are streamed to a storage
+	// buffer and the vertex shader evaluates the field at each grid point, so the CPU cost does not depend
+	// on the grid resolution and the whole field is one instanced draw.
+	class VectorFieldRenderSystem
+	{
+	public:
+		// Bodies past this many are left out of the field
+		static constexpr uint32_t MAX_BODIES = 1024;
+
+		VectorFieldRenderSystem(VEDevice& device, VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		~VectorFieldRenderSystem();
+
+		// Delete the copy constructor and copy operator
+		VectorFieldRenderSystem(const VectorFieldRenderSystem&) = delete;
+		VectorFieldRenderSystem& operator=(const VectorFieldRenderSystem&) = delete;
+
+		// Draws resolution x resolution arrows covering the viewport, with the same length and direction
+		// mapping as Vec2FieldSystem::Update. The render pass has to be begun with
+		// VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+		void RenderField(VERenderer& renderer,
+			VkCommandBuffer commandBuffer,
+			const GravityPhysicsSystem& physicsSystem,
+			const std::vector<VEGameObject>& bodies,
+			uint32_t resolution,
+			const char* gpuScope = "VectorFieldRenderSystem");
+
+		bool IsReady() const { return m_Pipeline.IsReady(); }
+
+	private:
+		// Matches Body in VectorField_Shader.vert
+		struct GpuBody
+		{
+			glm::vec2 Position;
+			float Mass;
+			float Padding;
+		};
+
+		void CreateDescriptorSetLayout();
+		void CreatePipelineLayout();
+		void CreatePipeline(VEPipelineCompiler& pipelineCompiler, VkRenderPass renderPass);
+		void CreateDescriptorSet(VkBuffer bodyBuffer);
+
+	private:
+		VEDevice& m_Device;
+
+		std::unique_ptr<VEDescriptorPool> m_DescriptorPool;
+		std::unique_ptr<VEDescriptorSetLayout> m_DescriptorSetLayout;
+		// Points at the frame ring buffer, written on the first draw
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+
+		VEPipelineHandle m_Pipeline;
+		VkPipelineLayout m_PipelineLayout;
+	};
+}
\ No newline at end of file
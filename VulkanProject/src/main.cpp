@@ -1,15 +1,130 @@
 #include "Application.h"
+#include "VE_MeshCooker.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
-int main()
+static VkPresentModeKHR ParsePresentMode(const std::string& name)
 {
-	VulkanEngine::Application App;
+	if (name == "fifo")			return VK_PRESENT_MODE_FIFO_KHR;
+	if (name == "fifo-relaxed")	return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+	if (name == "mailbox")		return VK_PRESENT_MODE_MAILBOX_KHR;
+	if (name == "immediate")	return VK_PRESENT_MODE_IMMEDIATE_KHR;
 
+	throw std::invalid_argument("Unknown present mode: " + name);
+}
+
+struct CommandLine
+{
+	VulkanEngine::ApplicationOptions Options;
+	// Cooks the meshes to this path and exits instead of running the application
+	std::string CookPath;
+	std::vector<std::string> CookInputs;
+};
+
+// --headless [--frames N] [--screenshot out.ppm]
+// --present-mode fifo|fifo-relaxed|mailbox|immediate [--frames-in-flight 1-3] [--low-latency] [--depth]
+// --field-resolution N [--debug-overlay] [--particles N] [--sdf-bodies] [--meshes meshes.vemesh] [--shader-dir Shaders]
+// --cook out.vemesh [--cook-input mesh.obj]...
+static CommandLine ParseCommandLine(int argc, char** argv)
+{
+	CommandLine commandLine;
+	VulkanEngine::ApplicationOptions& options = commandLine.Options;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--headless") == 0)
+		{
+			options.Headless = true;
+		}
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+		{
+			options.FrameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc)
+		{
+			options.ScreenshotPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--present-mode") == 0 && i + 1 < argc)
+		{
+			options.SwapChain.PresentMode = ParsePresentMode(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+		{
+			options.SwapChain.FramesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+
+			if (options.SwapChain.FramesInFlight < 1 || options.SwapChain.FramesInFlight > VulkanEngine::VESwapChain::MAX_FRAMES_IN_FLIGHT)
+			{
+				throw std::invalid_argument("--frames-in-flight must be between 1 and 3");
+			}
+		}
+		else if (strcmp(argv[i], "--low-latency") == 0)
+		{
+			options.LowLatency = true;
+		}
+		else if (strcmp(argv[i], "--depth") == 0)
+		{
+			options.SwapChain.DepthBuffer = true;
+		}
+		else if (strcmp(argv[i], "--field-resolution") == 0 && i + 1 < argc)
+		{
+			options.VectorFieldResolution = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--debug-overlay") == 0)
+		{
+			options.DebugOverlay = true;
+		}
+		else if (strcmp(argv[i], "--particles") == 0 && i + 1 < argc)
+		{
+			options.ParticleCapacity = static_cast<uint32_t>(std::stoul(argv[++i]));
+		}
+		else if (strcmp(argv[i], "--sdf-bodies") == 0)
+		{
+			options.SdfBodies = true;
+		}
+		else if (strcmp(argv[i], "--meshes") == 0 && i + 1 < argc)
+		{
+			options.MeshPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--shader-dir") == 0 && i + 1 < argc)
+		{
+			options.ShaderDirectory = argv[++i];
+		}
+		else if (strcmp(argv[i], "--cook") == 0 && i + 1 < argc)
+		{
+			commandLine.CookPath = argv[++i];
+		}
+		else if (strcmp(argv[i], "--cook-input") == 0 && i + 1 < argc)
+		{
+			commandLine.CookInputs.push_back(argv[++i]);
+		}
+		else
+		{
+			throw std::invalid_argument(std::string("Unknown argument: ") + argv[i]);
+		}
+	}
+
+	return commandLine;
+}
+
+int main(int argc, char** argv)
+{
 	try
 	{
+		CommandLine commandLine = ParseCommandLine(argc, argv);
+
+		if (!commandLine.CookPath.empty())
+		{
+			VulkanEngine::VEMeshCooker::Cook(commandLine.CookPath, commandLine.CookInputs);
+			return EXIT_SUCCESS;
+		}
+
+		VulkanEngine::Application App{ commandLine.Options };
+
 		App.Run();
 	}
 	catch (const std::exception &e)